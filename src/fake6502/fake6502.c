@@ -95,6 +95,16 @@
  *     that function once after each emulated        *
  *     instruction.                                  *
  *                                                   *
+ * Only when built with -DFAKE6502_PROFILE:          *
+ *                                                   *
+ * void profile6502_reset()                          *
+ *   - Clear the per opcode / addressing mode /      *
+ *     PC page / hot PC counters.                    *
+ *                                                   *
+ * int profile6502_dump_csv(FILE *fp)                *
+ *   - Write the counters as CSV. Returns 0 on a     *
+ *     write error.                                  *
+ *                                                   *
  *****************************************************
  * Useful variables in this emulator:                *
  *                                                   *
@@ -110,6 +120,9 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#ifdef FAKE6502_PROFILE
+#include <string.h>
+#endif
 
 //6502 defines
 #define UNDOCUMENTED //when this is defined, undocumented opcodes are handled.
@@ -907,6 +920,155 @@ static const uint32_t ticktable[256] = {
 /* F */      2,    5,    2,    8,    4,    4,    6,    6,    2,    4,    2,    7,    4,    4,    7,    7   /* F */
 };
 
+#ifdef FAKE6502_PROFILE
+//optional profiling build (-DFAKE6502_PROFILE). counts executions and cycles
+//per opcode, per PC page and per PC. addressing mode totals are derived from
+//the opcode counters when dumping, so the hot loop only touches these arrays.
+//the normal build compiles none of this.
+
+#define PROFILE_HOT_PCS 32 //number of entries in the hot PC section of the dump
+
+static uint32_t prof_op_count[256];
+static uint64_t prof_op_cycles[256];
+static uint32_t prof_page_count[256];
+static uint64_t prof_page_cycles[256];
+static uint32_t prof_pc_count[65536];
+static uint8_t prof_pc_opcode[65536]; //last opcode executed at each PC
+static uint64_t prof_instructions;
+static uint64_t prof_cycles;
+
+static void profile_instruction(uint16_t address, uint8_t op, uint32_t cycles) {
+    prof_op_count[op]++;
+    prof_op_cycles[op] += cycles;
+    prof_page_count[address >> 8]++;
+    prof_page_cycles[address >> 8] += cycles;
+    prof_pc_count[address]++;
+    prof_pc_opcode[address] = op;
+    prof_instructions++;
+    prof_cycles += cycles;
+}
+
+static const struct {
+    void (*handler)();
+    const char *name;
+} prof_op_names[] = {
+    { nop, "NOP" }, //first, so opcodes aliased to nop are reported as NOP
+    { adc, "ADC" }, { and, "AND" }, { asl, "ASL" }, { bcc, "BCC" }, { bcs, "BCS" },
+    { beq, "BEQ" }, { bit, "BIT" }, { bmi, "BMI" }, { bne, "BNE" }, { bpl, "BPL" },
+    { brk, "BRK" }, { bvc, "BVC" }, { bvs, "BVS" }, { clc, "CLC" }, { cld, "CLD" },
+    { cli, "CLI" }, { clv, "CLV" }, { cmp, "CMP" }, { cpx, "CPX" }, { cpy, "CPY" },
+    { dec, "DEC" }, { dex, "DEX" }, { dey, "DEY" }, { eor, "EOR" }, { inc, "INC" },
+    { inx, "INX" }, { iny, "INY" }, { jmp, "JMP" }, { jsr, "JSR" }, { lda, "LDA" },
+    { ldx, "LDX" }, { ldy, "LDY" }, { lsr, "LSR" }, { ora, "ORA" }, { pha, "PHA" },
+    { php, "PHP" }, { pla, "PLA" }, { plp, "PLP" }, { rol, "ROL" }, { ror, "ROR" },
+    { rti, "RTI" }, { rts, "RTS" }, { sbc, "SBC" }, { sec, "SEC" }, { sed, "SED" },
+    { sei, "SEI" }, { sta, "STA" }, { stx, "STX" }, { sty, "STY" }, { tax, "TAX" },
+    { tay, "TAY" }, { tsx, "TSX" }, { txa, "TXA" }, { txs, "TXS" }, { tya, "TYA" },
+    { lax, "LAX" }, { sax, "SAX" }, { dcp, "DCP" }, { isb, "ISB" }, { slo, "SLO" },
+    { rla, "RLA" }, { sre, "SRE" }, { rra, "RRA" }
+};
+
+static const struct {
+    void (*handler)();
+    const char *name;
+} prof_mode_names[] = {
+    { imp, "imp" }, { acc, "acc" }, { imm, "imm" }, { zp, "zp" }, { zpx, "zpx" },
+    { zpy, "zpy" }, { rel, "rel" }, { abso, "abs" }, { absx, "absx" }, { absy, "absy" },
+    { ind, "ind" }, { indx, "indx" }, { indy, "indy" }
+};
+
+#define PROF_OP_NAMES (sizeof(prof_op_names) / sizeof(prof_op_names[0]))
+#define PROF_MODE_NAMES (sizeof(prof_mode_names) / sizeof(prof_mode_names[0]))
+
+static const char *profile_op_name(uint8_t op) {
+    uint32_t i;
+    for (i = 0; i < PROF_OP_NAMES; i++) {
+        if (prof_op_names[i].handler == optable[op]) return prof_op_names[i].name;
+    }
+    return "???";
+}
+
+static uint32_t profile_mode_index(uint8_t op) {
+    uint32_t i;
+    for (i = 0; i < PROF_MODE_NAMES; i++) {
+        if (prof_mode_names[i].handler == addrtable[op]) break;
+    }
+    return i;
+}
+
+void profile6502_reset() {
+    memset(prof_op_count, 0, sizeof(prof_op_count));
+    memset(prof_op_cycles, 0, sizeof(prof_op_cycles));
+    memset(prof_page_count, 0, sizeof(prof_page_count));
+    memset(prof_page_cycles, 0, sizeof(prof_page_cycles));
+    memset(prof_pc_count, 0, sizeof(prof_pc_count));
+    memset(prof_pc_opcode, 0, sizeof(prof_pc_opcode));
+    prof_instructions = 0;
+    prof_cycles = 0;
+}
+
+//writes the counters as CSV. each section starts with its own header line
+//and sections are separated by an empty line. entries never executed are
+//omitted. pass stdout to print them from a host runner.
+int profile6502_dump_csv(FILE *fp) {
+    uint32_t mode_count[PROF_MODE_NAMES + 1] = { 0 };
+    uint64_t mode_cycles[PROF_MODE_NAMES + 1] = { 0 };
+    uint32_t hot[PROFILE_HOT_PCS];
+    uint32_t hotcount = 0;
+    uint32_t i, j;
+
+    fprintf(fp, "total,instructions,cycles\n");
+    fprintf(fp, "total,%llu,%llu\n\n", (unsigned long long)prof_instructions, (unsigned long long)prof_cycles);
+
+    fprintf(fp, "opcode,mnemonic,mode,count,cycles\n");
+    for (i = 0; i < 256; i++) {
+        uint32_t mode = profile_mode_index((uint8_t)i);
+        mode_count[mode] += prof_op_count[i];
+        mode_cycles[mode] += prof_op_cycles[i];
+        if (!prof_op_count[i]) continue;
+        fprintf(fp, "%02X,%s,%s,%lu,%llu\n", i, profile_op_name((uint8_t)i),
+                mode < PROF_MODE_NAMES ? prof_mode_names[mode].name : "???",
+                (unsigned long)prof_op_count[i], (unsigned long long)prof_op_cycles[i]);
+    }
+
+    fprintf(fp, "\nmode,count,cycles\n");
+    for (i = 0; i < PROF_MODE_NAMES; i++) {
+        if (!mode_count[i]) continue;
+        fprintf(fp, "%s,%lu,%llu\n", prof_mode_names[i].name,
+                (unsigned long)mode_count[i], (unsigned long long)mode_cycles[i]);
+    }
+
+    fprintf(fp, "\npage,count,cycles\n");
+    for (i = 0; i < 256; i++) {
+        if (!prof_page_count[i]) continue;
+        fprintf(fp, "%02X00,%lu,%llu\n", i,
+                (unsigned long)prof_page_count[i], (unsigned long long)prof_page_cycles[i]);
+    }
+
+    //keep the PROFILE_HOT_PCS most executed addresses, sorted by insertion
+    for (i = 0; i < 65536; i++) {
+        uint32_t count = prof_pc_count[i];
+        if (!count) continue;
+        if (hotcount == PROFILE_HOT_PCS && count <= prof_pc_count[hot[hotcount - 1]]) continue;
+        j = hotcount < PROFILE_HOT_PCS ? hotcount++ : hotcount - 1;
+        while (j > 0 && prof_pc_count[hot[j - 1]] < count) {
+            hot[j] = hot[j - 1];
+            j--;
+        }
+        hot[j] = i;
+    }
+
+    fprintf(fp, "\npc,opcode,mnemonic,count\n");
+    for (i = 0; i < hotcount; i++) {
+        uint8_t op = prof_pc_opcode[hot[i]];
+        fprintf(fp, "%04X,%02X,%s,%lu\n", (unsigned)hot[i], op, profile_op_name(op),
+                (unsigned long)prof_pc_count[hot[i]]);
+    }
+
+    return ferror(fp) == 0;
+}
+#endif
+
 
 void nmi6502() {
     push16(pc);
@@ -929,6 +1091,10 @@ void exec6502(uint32_t tickcount) {
     clockgoal6502 += tickcount;
    
     while (clockticks6502 < clockgoal6502) {
+#ifdef FAKE6502_PROFILE
+        uint16_t profpc = pc;
+        uint32_t profticks = clockticks6502;
+#endif
         opcode = read6502(pc++);
         status |= FLAG_CONSTANT;
 
@@ -941,6 +1107,9 @@ void exec6502(uint32_t tickcount) {
         if (penaltyop && penaltyaddr) clockticks6502++;
 
         instructions++;
+#ifdef FAKE6502_PROFILE
+        profile_instruction(profpc, opcode, clockticks6502 - profticks);
+#endif
 
         if (callexternal) (*loopexternal)();
     }
@@ -949,6 +1118,10 @@ void exec6502(uint32_t tickcount) {
 
 void step6502(int printRegs) 
 {
+#ifdef FAKE6502_PROFILE
+    uint16_t profpc = pc;
+    uint32_t profticks = clockticks6502;
+#endif
     opcode = read6502(pc++);
     status |= FLAG_CONSTANT;
 
@@ -962,6 +1135,9 @@ void step6502(int printRegs)
     clockgoal6502 = clockticks6502;
 
     instructions++;
+#ifdef FAKE6502_PROFILE
+    profile_instruction(profpc, opcode, clockticks6502 - profticks);
+#endif
 
     if (printRegs)
     {
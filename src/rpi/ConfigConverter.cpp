@@ -18,91 +18,48 @@ ConfigConverter::ConfigConverter(CONFIG_RPI configRPI, CONFIG_NATIVE configNativ
     m_config_native = configNative;
 }
 
-void ConfigConverter::ConvertToNative()
+// 設定テーブルのCONFIG_FLAG_NATIVEの項目を1つずつコピーする
+// toNativeがtrueならRaspberry Pi側 → ネイティブ側、falseなら逆方向
+void ConfigConverter::Convert(bool toNative)
 {
-    m_config_native->sound_frequency = m_config_RPI->sound_frequency;
-    m_config_native->sound_latency = m_config_RPI->sound_latency;
-
-    for(int drv = 0; drv < USE_FLOPPY_DISK; drv++) {
-        strncpy(m_config_native->current_floppy_disk_path[drv], m_config_RPI->current_floppy_disk_path[drv], _MAX_PATH - 1);
-        m_config_native->current_floppy_disk_path[drv][_MAX_PATH - 1] = '\0'; // NULL終端を保証
-    }
-    
-    for(int drv = 0; drv < USE_TAPE; drv++) {
-        strncpy(m_config_native->current_tape_path[drv], m_config_RPI->current_tape_path[drv], _MAX_PATH - 1);
-        m_config_native->current_tape_path[drv][_MAX_PATH - 1] = '\0'; // NULL終端を保証
-    }
-
-#if defined(USE_MONITOR_TYPE)
-    m_config_native->monitor_type = m_config_RPI->monitor_type;
-#endif
-
-#if defined(USE_KEYBOARD_TYPE)
-    m_config_native->keyboard_type = m_config_RPI->keyboard_type;
-#endif
-
-    m_config_native->fullscreen_stretch_type = m_config_RPI->fullscreen_stretch_type;
-
-    m_config_native->sound_noise_fdd = m_config_RPI->sound_noise_fdd;
-    m_config_native->sound_noise_cmt = m_config_RPI->sound_noise_cmt;
-    m_config_native->sound_tape_signal = m_config_RPI->sound_tape_signal;
-    m_config_native->sound_tape_voice = m_config_RPI->sound_tape_voice;
-
-    for(int drv = 0; drv < USE_FLOPPY_DISK; drv++) {
-        m_config_native->correct_disk_timing[drv] = m_config_RPI->correct_disk_timing[drv];
-        m_config_native->ignore_disk_crc[drv] = m_config_RPI->ignore_disk_crc[drv];
+    int count;
+    const ConfigEntry* table = PlatformConfig::get_config_table(&count);
+
+    for (int i = 0; i < count; i++) {
+        const ConfigEntry* entry = &table[i];
+        if (!(entry->flags & CONFIG_FLAG_NATIVE) || (entry->flags & CONFIG_FLAG_ALIAS)) {
+            continue;
+        }
+
+        int elements = entry->count > 0 ? entry->count : 1;
+        for (int index = 0; index < elements; index++) {
+            u8* rpi = (u8*)m_config_RPI + entry->offset + entry->stride * index;
+            u8* native = (u8*)m_config_native + entry->native_offset + entry->native_stride * index;
+            u8* src = toNative ? rpi : native;
+            u8* dst = toNative ? native : rpi;
+
+            switch (entry->type) {
+                case CONFIG_TYPE_BOOL:
+                    *(bool*)dst = *(bool*)src;
+                    break;
+                case CONFIG_TYPE_INT:
+                    *(int*)dst = *(int*)src;
+                    break;
+                case CONFIG_TYPE_STRING:
+                    strncpy((char*)dst, (const char*)src, _MAX_PATH - 1);
+                    ((char*)dst)[_MAX_PATH - 1] = '\0'; // NULL終端を保証
+                    break;
+            }
+        }
     }
+}
 
-    for(int drv = 0; drv < USE_TAPE; drv++) {   
-        m_config_native->wave_shaper[drv] = m_config_RPI->wave_shaper[drv];
-        m_config_native->baud_high[drv] = m_config_RPI->baud_high[drv];
-    }
+void ConfigConverter::ConvertToNative()
+{
+    Convert(true);
 }
 
 void ConfigConverter::ConvertFromNative()
 {
-    m_config_RPI->sound_frequency = m_config_native->sound_frequency;
-    m_config_RPI->sound_latency = m_config_native->sound_latency;
-
-    for(int drv = 0; drv < USE_FLOPPY_DISK; drv++) {
-        strncpy(m_config_RPI->current_floppy_disk_path[drv], m_config_native->current_floppy_disk_path[drv], _MAX_PATH - 1);
-        m_config_RPI->current_floppy_disk_path[drv][_MAX_PATH - 1] = '\0'; // NULL終端を保証
-    }
-    
-#if defined(USE_TAPE)
-    for(int drv = 0; drv < USE_TAPE; drv++) {
-        strncpy(m_config_RPI->current_tape_path[drv], m_config_native->current_tape_path[drv], _MAX_PATH - 1);
-        m_config_RPI->current_tape_path[drv][_MAX_PATH - 1] = '\0'; // NULL終端を保証
-    }
-#endif
-
-#if defined(USE_MONITOR_TYPE)
-    m_config_RPI->monitor_type = m_config_native->monitor_type;
-#endif
-
-#if defined(USE_KEYBOARD_TYPE)
-    m_config_RPI->keyboard_type = m_config_native->keyboard_type;
-#endif
-
-    m_config_RPI->fullscreen_stretch_type = m_config_native->fullscreen_stretch_type;
-
-#if defined(USE_FLOPPY_DISK)
-    m_config_RPI->sound_noise_fdd = m_config_native->sound_noise_fdd;
-#endif
-
-#if defined(USE_TAPE)
-    m_config_RPI->sound_noise_cmt = m_config_native->sound_noise_cmt;
-    m_config_RPI->sound_tape_signal = m_config_native->sound_tape_signal;
-    m_config_RPI->sound_tape_voice = m_config_native->sound_tape_voice;
-#endif
-
-    for(int drv = 0; drv < USE_FLOPPY_DISK; drv++) {
-        m_config_RPI->correct_disk_timing[drv] = m_config_native->correct_disk_timing[drv];
-        m_config_RPI->ignore_disk_crc[drv] = m_config_native->ignore_disk_crc[drv];
-    }
-
-    for(int drv = 0; drv < USE_TAPE; drv++) {
-        m_config_RPI->wave_shaper[drv] = m_config_native->wave_shaper[drv];
-        m_config_RPI->baud_high[drv] = m_config_native->baud_high[drv];
-    }
+    Convert(false);
 }
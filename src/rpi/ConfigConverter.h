@@ -21,6 +21,8 @@ class ConfigConverter
     private:
         CONFIG_RPI m_config_RPI;
         CONFIG_NATIVE m_config_native;
+
+        void Convert(bool toNative);
     public:
         ConfigConverter(CONFIG_RPI configRPI, CONFIG_NATIVE configNative);
         ~ConfigConverter(){}
@@ -17,9 +17,23 @@
 #include "PlatformSound.h"
 #include "PlatformMenu.h"
 #include "PlatformInput.h"
+#include "PlatformInputRecorder.h"
+#include "PlatformSPSCQueue.h"
+#include "PlatformLatency.h"
+#include "PlatformAutoKey.h"
+#include "PlatformProfiler.h"
+#include "PlatformTrace.h"
+#include "PlatformDeferredLog.h"
+#include "PlatformSpeed.h"
+#include "PlatformBenchmark.h"
+#include "PlatformFrameSkip.h"
+#include "PlatformThermal.h"
+#include "PlatformIdle.h"
 #include "PlatformLog.h"
 #include "ConfigConverter.h"
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 
@@ -27,6 +41,57 @@
 #define VK_F12 0x7B
 #endif
 
+#ifndef VK_F11
+#define VK_F11 0x7A
+#endif
+
+#ifndef VK_F10
+#define VK_F10 0x79
+#endif
+
+#ifndef VK_F9
+#define VK_F9 0x78
+#endif
+
+#ifndef VK_F8
+#define VK_F8 0x77
+#endif
+
+// オーバーレイ(計測結果表示)の切り替えキー
+#define OVERLAY_TOGGLE_KEY VK_F11
+// オーバーレイに処理ごとの時間を表示する切り替えキー
+#define PROFILE_TOGGLE_KEY VK_F10
+// トレースをSDに書き出すキー
+#define TRACE_DUMP_KEY VK_F9
+// 早送りの倍率を切り替えるキー(等速 → 2x → 4x → 8x → 最高速 → 等速)
+#define FAST_FORWARD_KEY VK_F8
+
+// エミュレーターに渡さずにkey_downで処理するキー(遅延計測の対象からも外す)
+static bool is_host_hotkey(int code)
+{
+    switch (code) {
+        case VK_F12:
+        case OVERLAY_TOGGLE_KEY:
+        case FAST_FORWARD_KEY:
+#ifdef USE_PROFILER
+        case PROFILE_TOGGLE_KEY:
+        case TRACE_DUMP_KEY:
+#endif
+            return true;
+        default:
+            return false;
+    }
+}
+
+// オーバーレイの行の割り当て(速度と遅延はF11、処理ごとの時間はF10で表示)
+#define OVERLAY_LINE_SPEED 0
+#define OVERLAY_LINE_THERMAL 1
+#define OVERLAY_LINE_LATENCY 2      // 2行
+#define OVERLAY_LINE_PROFILE 4      // 2行
+
+// スロットリング中(ARMクロックが下がっている間)の表示の間引きの下限
+#define THERMAL_MIN_FRAME_SKIP_RATIO 2
+
 // グローバルに参照するための変数(あまり良くないが……)
 PlatformScreen* g_platform_screen = nullptr;
 PlatformSound* g_platform_sound = nullptr;
@@ -34,24 +99,67 @@ PlatformMenu* g_platform_menu = nullptr;
 PlatformConfig* g_platform_config = nullptr;
 
 extern const char* create_emu_path(const char *format, ...);
+extern uint32_t rpi_gamepad_status[MAX_GAMEPADS];
+extern volatile uint32_t rpi_gamepad_live[MAX_GAMEPADS];
+extern volatile u64 rpi_gamepad_timestamp[MAX_GAMEPADS];
+
+// USBデバイスの抜き差しを確認する間隔(マイクロ秒)
+#define INPUT_POLL_INTERVAL_US 500000
 
-// キーイベントバッファ
-#define KEY_BUFFER_SIZE 32
-static PlatformKeyEvent keyEvents[KEY_BUFFER_SIZE];
-static int keyEventHead = 0;
-static int keyEventTail = 0;
-static CSpinLock keyBufferLock;  // スレッドセーフのためのロック
+// スリープ中にログを出力する場合に、1行の出力が終わるのを待つための余裕(マイクロ秒)
+#define LOG_FLUSH_MARGIN_US 1000
+
+// 早送りの倍率(0は最高速)。表示もこのフレーム数に1回にする
+static const int s_fast_forward_multipliers[] = { 1, 2, 4, 8, 0 };
+#define FAST_FORWARD_COUNT ((int)(sizeof(s_fast_forward_multipliers) / sizeof(s_fast_forward_multipliers[0])))
+// 最高速での早送り中に画面を表示する間隔(マイクロ秒)
+#define FAST_FORWARD_MAX_PRESENT_US 50000
+
+// キーイベントバッファ(USBのコールバックから積み、メインループで取り出すSPSCキュー)
+#define KEY_BUFFER_SIZE 256
+static PlatformSPSCQueue<PlatformKeyEvent, KEY_BUFFER_SIZE> keyEventQueue;
 
 EmuController::EmuController()
 :
         m_resetgpio_pressed(false),
-        m_resetgpio(nullptr)
+        m_resetgpio(nullptr),
+        m_input_recorder(nullptr),
+        m_input_frame(0),
+        m_key_overflow_reported(0),
+        m_latency(nullptr),
+        m_next_overlay_update_us(0),
+        m_first_frame_presented(false),
+        m_show_latency(false),
+        m_show_profile(false),
+        m_speed_meter(nullptr),
+        m_frame_skip(nullptr),
+        m_thermal(nullptr),
+        m_idle(nullptr),
+        m_benchmark_request(0),
+        m_fast_forward(0),
+        m_fast_forward_frames(0),
+        m_fast_forward_present_us(0),
+        m_input_poll_handler(nullptr),
+        m_input_poll_param(nullptr),
+        m_next_input_poll_us(0),
+        m_auto_key(nullptr)
 {
     g_platform_screen = m_platform_screen = new PlatformScreen();
     g_platform_sound = m_platform_sound = new PlatformSound();
     g_platform_menu = m_platform_menu = new PlatformMenu(this);
     g_platform_config = m_platform_config = new PlatformConfig(create_emu_path("%s.ini", CONFIG_NAME));
     m_config = m_platform_config->get_config();
+    m_input_recorder = new PlatformInputRecorder();
+    m_latency = new PlatformLatency();
+    m_auto_key = new PlatformAutoKey();
+    m_speed_meter = new PlatformSpeedMeter();
+    m_frame_skip = new PlatformFrameSkip();
+    m_thermal = new PlatformThermal(new PlatformMailboxThermalSource());
+    m_idle = new PlatformIdle();
+#ifdef CPU_CLOCKS
+    m_speed_meter->set_cpu_clock(CPU_CLOCKS);
+#endif
+    memset(m_gamepad_seen, 0, sizeof(m_gamepad_seen));
 
     m_emu = nullptr;
 }
@@ -74,16 +182,45 @@ EmuController::~EmuController()
         delete m_resetgpio;
         m_resetgpio = nullptr;
     }
+    if (m_input_recorder) {
+        delete m_input_recorder;
+        m_input_recorder = nullptr;
+    }
+    if (m_latency) {
+        delete m_latency;
+        m_latency = nullptr;
+    }
+    if (m_auto_key) {
+        delete m_auto_key;
+        m_auto_key = nullptr;
+    }
+    if (m_speed_meter) {
+        delete m_speed_meter;
+        m_speed_meter = nullptr;
+    }
+    if (m_frame_skip) {
+        delete m_frame_skip;
+        m_frame_skip = nullptr;
+    }
+    if (m_thermal) {
+        delete m_thermal;
+        m_thermal = nullptr;
+    }
+    if (m_idle) {
+        delete m_idle;
+        m_idle = nullptr;
+    }
     m_emu = nullptr;
 }
 
-void EmuController::initialize(int host_width, int host_height, int emu_width, int emu_height, int aspect_width, int aspect_height, ViceSound* sound_device, CScheduler* scheduler)
+void EmuController::initialize(int host_width, int host_height, int emu_width, int emu_height, int aspect_width, int aspect_height, ViceSound* sound_device, CScheduler* scheduler, CInterruptSystem* interrupt)
 {
     m_platform_screen->initialize(this, host_width, host_height, emu_width, emu_height, aspect_width, aspect_height, m_platform_menu);
     m_platform_sound->setup(this, sound_device, scheduler);
     m_platform_menu->initialize(this, m_platform_screen);
 
     m_scheduler = scheduler;
+    m_idle->initialize(interrupt, scheduler);
 
     // 特殊リセット用のGPIOの初期化 (入力モード)
     m_resetgpio = new CGPIOPin(RESET_GPIO_PIN, GPIOModeInput);
@@ -139,6 +276,11 @@ int EmuController::emulator_main()
         }
     }
 
+    // 設定されていれば、最初にベンチマークを実行する
+    if (m_config->benchmark_seconds > 0) {
+        request_benchmark(m_config->benchmark_seconds);
+    }
+
     bool running = true;
     int total_frames = 0, draw_frames = 0, skip_frames = 0;
     u64 next_time_us = 0; // マイクロ秒単位で保持
@@ -147,9 +289,19 @@ int EmuController::emulator_main()
     while (running) {
         // メインループ
         if (m_emu && running) {
+            TRACE_SCOPE("loop");
             // timing controls
             int sleep_period_ms = 0;
 
+            // ベンチマークを要求されていれば実行し、終わったら通常の実行に戻る
+            if (m_benchmark_request > 0) {
+                int seconds = m_benchmark_request;
+                m_benchmark_request = 0;
+                run_benchmark(seconds);
+                next_time_us = 0;
+                m_speed_meter->restart();
+            }
+
             // GPIOの状態をチェック (内部プルダウンなのでHIGHで検出)
             bool current_state = m_resetgpio->Read() == HIGH;
             
@@ -187,9 +339,23 @@ int EmuController::emulator_main()
                 }
             }
 
+            // USBデバイスの抜き差しを確認
+            poll_input_devices();
+
+            // キーイベントバッファが溢れていたら報告する
+            u32 key_overflow = get_key_overflow_count();
+            if (key_overflow != m_key_overflow_reported) {
+                get_logger()->Write("EmuController", LogWarning, "Key event queue overflow: %u events dropped", key_overflow);
+                m_key_overflow_reported = key_overflow;
+            }
+
             // キーイベントバッファからイベントを取り出して処理
             PlatformKeyEvent keyEvent;
             while (pop_key_event(&keyEvent)) {
+                // VMに渡る入力であれば遅延計測の対象にする
+                if (!m_platform_menu->is_visible() && !is_host_hotkey(keyEvent.code)) {
+                    m_latency->input_dispatched(keyEvent.timestamp);
+                }
                 if (keyEvent.type == KEY_EVENT_DOWN) {
                     key_down(keyEvent.code, keyEvent.extended, keyEvent.repeat);
                 } else {
@@ -206,10 +372,28 @@ int EmuController::emulator_main()
                 if (!menu_enabled) {
                     // drive machine
                     int run_frames = 0;
-                    run_frames = m_emu->run();
+                    snapshot_gamepads();
+                    update_input_movie_before_run();
+                    update_auto_key();
+                    track_gamepad_latency();
+                    u64 run_start_us = get_time_us();
+                    {
+                        PROFILE_SCOPE(PROFILE_VM_RUN);
+                        run_frames = m_emu->run();
+                    }
+                    m_latency->frame_run(m_input_frame, run_start_us);
+                    u32 run_us = (u32)(get_time_us() - run_start_us);
+                    u32 frame_us = get_frame_interval() * 1000 >> 10;
+                    m_speed_meter->add_run(run_frames, frame_us, run_us);
+                    m_frame_skip->set_frame_time(frame_us);
+                    m_frame_skip->add_run_cost(run_us);
+                    update_input_movie_after_run();
                     total_frames += run_frames;
 
-                    bool now_skip = (m_config->full_speed || is_frame_skippable()) && !is_video_recording() && !is_sound_recording();
+                    // 自動キー入力中はターボ設定に従って高速実行する
+                    bool auto_key_turbo = m_config->auto_key_turbo && m_auto_key->is_running();
+                    int fast_forward = get_fast_forward_multiplier();
+                    bool now_skip = (m_config->full_speed || auto_key_turbo || fast_forward == 0 || is_frame_skippable()) && !is_video_recording() && !is_sound_recording();
 
                     if ((prev_skip && !now_skip) || next_time_us == 0) {
                         next_time_us = get_time_us();
@@ -217,7 +401,8 @@ int EmuController::emulator_main()
 
                     if (!now_skip) {
                         static int32_t accum = 0;
-                        accum += get_frame_interval();
+                        // 早送り中は1フレームの時間を倍率で割る(最高速で録画中などは等速)
+                        accum += get_frame_interval() / (fast_forward ? fast_forward : 1);
                         int32_t interval = accum >> 10;     // 1024で割る
                         accum -= interval << 10;           // 1024倍する
 
@@ -225,19 +410,56 @@ int EmuController::emulator_main()
                     }
                     prev_skip = now_skip;
                 } else {
-                    // メニュー表示中は画面更新だけ行う
+                    // メニュー表示中は画面更新だけ行う(速度の集計からも外す)
+                    m_speed_meter->restart();
+                    m_frame_skip->restart();
                     draw_screen();
-                    // メニュー表示中は一定時間のスリープを入れる
-                    CTimer::SimpleMsDelay(32); // 約30Hz相当
+                    // メニュー表示中は一定時間のスリープを入れる(その間に溜まったログを出力する)
+                    u64 menu_sleep_until_us = get_time_us() + 32000; // 約30Hz相当
+                    get_deferred_log()->flush(menu_sleep_until_us);
+                    sleep_until(menu_sleep_until_us);
                 }
 
                 // 現在時刻をマイクロ秒単位で取得
                 u64 current_time_us = get_time_us();
                 
-                if (next_time_us > current_time_us) {
+                if (m_fast_forward && !menu_enabled) {
+                    // 早送り中は倍率ぶんのフレームに1回だけ表示する(表示しないフレームはVMの描画も行わない)
+                    if (fast_forward_present(current_time_us)) {
+                        draw_frames += present_screen();
+                    }
+                    skip_frames = 0;
+
+                    if (next_time_us > current_time_us) {
+                        int32_t wait_ms = (int32_t)((next_time_us - current_time_us) / 1000);
+                        if (wait_ms >= 10) {
+                            sleep_period_ms = wait_ms;
+                        }
+                    } else {
+                        // 倍率に追いつけない場合は遅れを溜めずに最高速で実行する
+                        next_time_us = current_time_us;
+                    }
+                } else if (!menu_enabled && !prev_skip) {
+                    // 等速での実行中は、処理時間の平均から決めた割合で等間隔に表示する
+                    if (m_frame_skip->should_present()) {
+                        draw_frames += present_screen();
+                    }
+                    skip_frames = 0;
+
+                    current_time_us = get_time_us();
+                    if (next_time_us > current_time_us) {
+                        int32_t wait_ms = (int32_t)((next_time_us - current_time_us) / 1000);
+                        if (wait_ms >= 10) {
+                            sleep_period_ms = wait_ms;
+                        }
+                    } else if (current_time_us - next_time_us > FRAME_SKIP_MAX_LAG_US) {
+                        // 大きく遅れた場合(SDへの書き込みなど)はまとめて追いつこうとせずに時刻を合わせる
+                        next_time_us = current_time_us;
+                    }
+                } else if (next_time_us > current_time_us) {
                     // メニュー表示中でなければemuのdraw_screenを呼び出す
                     if (!menu_enabled) {
-                        draw_frames += draw_screen();
+                        draw_frames += present_screen();
                     }
                     skip_frames = 0;
 
@@ -254,7 +476,7 @@ int EmuController::emulator_main()
                     // update window at least once per 1 sec in virtual machine time
                     // メニュー表示中でなければemuのdraw_screenを呼び出す
                     if (!menu_enabled) {
-                        draw_frames += draw_screen();
+                        draw_frames += present_screen();
                     }
                     skip_frames = 0;
 
@@ -265,14 +487,31 @@ int EmuController::emulator_main()
 
                 if (sleep_period_ms > 0) {
                     // スリープ時間を計測
-                    CTimer::SimpleMsDelay(sleep_period_ms);
+                    PROFILE_SCOPE(PROFILE_SLEEP);
+                    // 待つ時間を使って溜まったログを出力する
+                    u64 sleep_until_us = get_time_us() + sleep_period_ms * 1000;
+                    get_deferred_log()->flush(sleep_until_us - LOG_FLUSH_MARGIN_US);
+                    sleep_until(sleep_until_us);
                 }
             } else {
                 // リセトGPIOが押されている間は画面を更新するだけ
+                m_speed_meter->restart();
                 draw_frames += draw_screen();
-                CTimer::SimpleMsDelay(32); // 少し待機してCPU負荷を下げる
+                sleep_until(get_time_us() + 32000); // 少し待機してCPU負荷を下げる
             }
             
+            // 待ち時間が無い場合でもログが溜まりすぎないようにする
+            get_deferred_log()->flush_if_crowded();
+
+            // 速度の集計と、遅延計測の結果を出力
+            m_speed_meter->update(get_time_us());
+            update_thermal();
+            update_latency_report();
+            PROFILE_UPDATE(get_time_us(), total_frames, draw_frames);
+
+            // 保存待ちの設定があれば書き込む
+            m_platform_config->update(get_time_us());
+
             m_scheduler->Yield();
         }
     }
@@ -364,41 +603,62 @@ void EmuController::open_floppy_disk(int drv, const char* file_path, int bank)
 }
 void EmuController::push_key_event(KeyEventType type, uint8_t code, bool extended, bool repeat)
 {
-    keyBufferLock.Acquire();
-    
-    // 次の書き込み位置を計算
-    int nextTail = (keyEventTail + 1) % KEY_BUFFER_SIZE;
-    
-    // バッファがオーバーフローしないか確認
-    if (nextTail != keyEventHead) {
-        // イベントをバッファに追加
-        keyEvents[keyEventTail].type = type;
-        keyEvents[keyEventTail].code = code;
-        keyEvents[keyEventTail].extended = extended;
-        keyEvents[keyEventTail].repeat = repeat;
-        keyEventTail = nextTail;
+    PlatformKeyEvent event;
+    event.type = type;
+    event.code = code;
+    event.extended = extended;
+    event.repeat = repeat;
+    event.timestamp = CTimer::GetClockTicks64();
+
+    // 満杯の場合は捨てられるが、オーバーフロー数として数えておく
+    keyEventQueue.push(event);
+}
+
+void EmuController::set_input_poll_handler(TInputPollHandler* handler, void* param)
+{
+    m_input_poll_handler = handler;
+    m_input_poll_param = param;
+}
+
+// 一定間隔でUSBデバイスの抜き差しを確認する
+void EmuController::poll_input_devices()
+{
+    if (!m_input_poll_handler) {
+        return;
+    }
+
+    u64 now = get_time_us();
+    if (now < m_next_input_poll_us) {
+        return;
+    }
+    m_next_input_poll_us = now + INPUT_POLL_INTERVAL_US;
+
+    m_input_poll_handler(m_input_poll_param);
+}
+
+// USBハンドラが書き込む最新状態を、VMが参照する状態にフレーム単位で写す
+// (フレームの途中で状態が変わらないようにするため)
+void EmuController::snapshot_gamepads()
+{
+    // 入力再生中は記録された状態を使う
+    if (m_input_recorder->is_playing()) {
+        return;
+    }
+
+    for (int i = 0; i < MAX_GAMEPADS; i++) {
+        rpi_gamepad_status[i] = rpi_gamepad_live[i];
     }
-    
-    keyBufferLock.Release();
 }
 
 // キーイベントをバッファから取得する関数
 bool EmuController::pop_key_event(PlatformKeyEvent* pEvent)
 {
-    bool result = false;
-    
-    keyBufferLock.Acquire();
-    
-    // バッファが空でないか確認
-    if (keyEventHead != keyEventTail) {
-        // イベントを取得
-        *pEvent = keyEvents[keyEventHead];
-        keyEventHead = (keyEventHead + 1) % KEY_BUFFER_SIZE;
-        result = true;
-    }
-    
-    keyBufferLock.Release();
-    return result;
+    return keyEventQueue.pop(pEvent);
+}
+
+u32 EmuController::get_key_overflow_count()
+{
+    return keyEventQueue.get_overflow_count();
 }
 
 void EmuController::key_down(int code, bool extended, bool repeat)
@@ -409,15 +669,60 @@ void EmuController::key_down(int code, bool extended, bool repeat)
         return;
     }
 
+    // メニューや計測用のキーはここで処理し、エミュレーターには渡さない
+    if (is_host_hotkey(code)) {
+        handle_host_hotkey(code, repeat);
+        return;
+    }
+
+    // 入力再生中は実キーボードの入力を無視する
+    if (m_input_recorder->is_playing()) {
+        return;
+    }
+
+    if (m_input_recorder->is_recording()) {
+        PlatformKeyEvent event = { KEY_EVENT_DOWN, (u8)code, extended, repeat, 0 };
+        m_input_recorder->record_key(m_input_frame, event);
+    }
+
+    if (m_emu) {
+        m_emu->key_down(code, extended, repeat);
+    }
+}
+
+// is_host_hotkeyがtrueを返すキーの処理
+void EmuController::handle_host_hotkey(int code, bool repeat)
+{
     // F12が押されたらメニュー出しますよ
     if(code == VK_F12) {
         m_platform_menu->toggle_menu();
         return;
     }
 
-    if (m_emu) {
-        m_emu->key_down(code, extended, repeat);
+    // 早送りの倍率の切り替え(押しっぱなしのリピートでは切り替えない)
+    if(code == FAST_FORWARD_KEY) {
+        if (!repeat) {
+            cycle_fast_forward();
+        }
+        return;
+    }
+    // オーバーレイの表示切り替え
+    if(code == OVERLAY_TOGGLE_KEY) {
+        m_show_latency = !m_show_latency;
+        update_overlay_visible();
+        return;
+    }
+#ifdef USE_PROFILER
+    if(code == PROFILE_TOGGLE_KEY) {
+        m_show_profile = !m_show_profile;
+        update_overlay_visible();
+        return;
+    }
+    if(code == TRACE_DUMP_KEY) {
+        get_trace()->dump(create_emu_path("%s_trace.json", CONFIG_NAME));
+        return;
     }
+#endif
 }
 
 void EmuController::key_up(int code, bool extended)
@@ -428,6 +733,16 @@ void EmuController::key_up(int code, bool extended)
         return;
     }
 
+    // 入力再生中は実キーボードの入力を無視する
+    if (m_input_recorder->is_playing()) {
+        return;
+    }
+
+    if (m_input_recorder->is_recording()) {
+        PlatformKeyEvent event = { KEY_EVENT_UP, (u8)code, extended, false, 0 };
+        m_input_recorder->record_key(m_input_frame, event);
+    }
+
     if (m_emu) {
         m_emu->key_up(code, extended);
     }
@@ -464,13 +779,116 @@ int EmuController::get_frame_interval()
     }
 }
 
+// 指定時刻までWFIで待つ(既に過ぎていれば何もしない)
+void EmuController::sleep_until(u64 until_us)
+{
+    m_speed_meter->add_idle(m_idle->wait_until(until_us));
+}
+
 int EmuController::draw_screen()
 {
     return m_platform_screen->draw_screen();
 }
 
+// エミュレーター画面を表示し、表示時刻を遅延計測に伝える
+int EmuController::present_screen()
+{
+    u64 start = get_time_us();
+    int result = m_platform_screen->draw_screen();
+    u64 now = get_time_us();
+    m_speed_meter->add_busy((u32)(now - start));
+    m_frame_skip->add_present_cost((u32)(now - start));
+    if (result) {
+        m_latency->frame_presented(now);
+
+        // 起動から最初のフレームを表示するまでの時間(起動時間の計測用)
+        if (!m_first_frame_presented) {
+            m_first_frame_presented = true;
+            get_logger()->Write("EmuController", LogNotice, "Time to first frame: %u ms", (unsigned)(now / 1000));
+        }
+    }
+    return result;
+}
+
+// ゲームパッドの状態が変化していれば、その受信時刻を遅延計測の対象にする
+void EmuController::track_gamepad_latency()
+{
+    for (int i = 0; i < MAX_GAMEPADS; i++) {
+        if (rpi_gamepad_status[i] != m_gamepad_seen[i]) {
+            m_gamepad_seen[i] = rpi_gamepad_status[i];
+            m_latency->input_dispatched(rpi_gamepad_timestamp[i]);
+        }
+    }
+}
+
+// 速度と遅延、処理時間のどちらかを表示していればオーバーレイを出す
+void EmuController::update_overlay_visible()
+{
+    if (!m_show_latency) {
+        m_platform_screen->set_overlay_text(OVERLAY_LINE_SPEED, nullptr);
+        m_platform_screen->set_overlay_text(OVERLAY_LINE_THERMAL, nullptr);
+        m_platform_screen->set_overlay_text(OVERLAY_LINE_LATENCY, nullptr);
+        m_platform_screen->set_overlay_text(OVERLAY_LINE_LATENCY + 1, nullptr);
+    }
+    if (!m_show_profile) {
+        m_platform_screen->set_overlay_text(OVERLAY_LINE_PROFILE, nullptr);
+        m_platform_screen->set_overlay_text(OVERLAY_LINE_PROFILE + 1, nullptr);
+    }
+    m_platform_screen->set_overlay_visible(m_show_latency || m_show_profile);
+    m_next_overlay_update_us = 0;
+}
+
+// 温度とクロックの変化を表示の間引きに伝える(音が途切れる前に描画を減らす)
+void EmuController::update_thermal()
+{
+    if (!m_thermal->update(get_time_us())) {
+        return;
+    }
+    m_frame_skip->set_clock(m_thermal->get_clock());
+    m_frame_skip->set_min_ratio(m_thermal->get_level() >= THERMAL_LEVEL_THROTTLED ? THERMAL_MIN_FRAME_SKIP_RATIO : 1);
+}
+
+void EmuController::update_latency_report()
+{
+    u64 now = get_time_us();
+    m_latency->update(now);
+
+    // オーバーレイ表示中は0.5秒ごとに文字列を更新する
+    if (m_platform_screen->is_overlay_visible() && now >= m_next_overlay_update_us) {
+        char line[OVERLAY_MAX_CHARS];
+        if (m_show_latency) {
+            char skip[OVERLAY_MAX_CHARS];
+            m_speed_meter->format(line, sizeof(line));
+            m_frame_skip->format(skip, sizeof(skip));
+            int length = strlen(line);
+            snprintf(line + length, sizeof(line) - length, ", %s", skip);
+            m_platform_screen->set_overlay_text(OVERLAY_LINE_SPEED, line);
+            m_thermal->format(line, sizeof(line));
+            m_platform_screen->set_overlay_text(OVERLAY_LINE_THERMAL, line);
+            m_latency->format_consume(line, sizeof(line));
+            m_platform_screen->set_overlay_text(OVERLAY_LINE_LATENCY, line);
+            m_latency->format_present(line, sizeof(line));
+            m_platform_screen->set_overlay_text(OVERLAY_LINE_LATENCY + 1, line);
+        }
+#ifdef USE_PROFILER
+        if (m_show_profile) {
+            char frames[OVERLAY_MAX_CHARS];
+            get_profiler()->format_stages(line, sizeof(line), PROFILE_VM_RUN, PROFILE_STRETCH_BLIT);
+            m_platform_screen->set_overlay_text(OVERLAY_LINE_PROFILE, line);
+            get_profiler()->format_stages(line, sizeof(line), PROFILE_FRAME_BUFFER, PROFILE_SLEEP);
+            get_profiler()->format_frames(frames, sizeof(frames), now);
+            int length = strlen(line);
+            snprintf(line + length, sizeof(line) - length, " %s", frames);
+            m_platform_screen->set_overlay_text(OVERLAY_LINE_PROFILE + 1, line);
+        }
+#endif
+        m_next_overlay_update_us = now + 500000;
+    }
+}
+
 void EmuController::draw_screen_emu()
 {
+    PROFILE_SCOPE(PROFILE_VM_DRAW);
     m_emu->get_vm()->draw_screen();
 
 }
@@ -482,7 +900,8 @@ void EmuController::load_config()
 
 void EmuController::save_config()
 {
-    m_platform_config->save_config();
+    // メニューを閉じるたびに呼ばれるので、SDへの書き込みはまとめて遅らせる
+    m_platform_config->request_save(get_time_us());
 }
 
 u64 EmuController::get_time_us()
@@ -490,6 +909,95 @@ u64 EmuController::get_time_us()
     return CTimer::GetClockTicks64();
 }
 
+// 表示と音声の出力を止め、リセットからseconds秒ぶんのエミュレーションを最高速で実行する
+void EmuController::run_benchmark(int seconds)
+{
+    get_logger()->Write("Benchmark", LogNotice, "Running %d emulated seconds without display and sound output", seconds);
+
+    // 毎回同じ状態から始める(入力の記録や自動入力はリセットで意味が無くなるので止める)
+    if (is_input_recording() || is_input_playing()) {
+        stop_input_movie();
+    }
+    stop_auto_key();
+    m_emu->reset();
+    m_platform_sound->set_output_enabled(false);
+
+    PlatformBenchmark benchmark(seconds);
+#ifdef CPU_CLOCKS
+    benchmark.set_cpu_clock(CPU_CLOCKS);
+#endif
+    benchmark.start(get_time_us());
+    while (!benchmark.is_finished(get_time_us())) {
+        u64 start = get_time_us();
+        int run_frames = m_emu->run();
+        u64 run_end = get_time_us();
+        draw_screen_emu();
+        u64 draw_end = get_time_us();
+
+        benchmark.add(BENCHMARK_STAGE_RUN, (u32)(run_end - start));
+        benchmark.add(BENCHMARK_STAGE_DRAW, (u32)(draw_end - run_end));
+        benchmark.add_frames(run_frames, get_frame_interval() * 1000 >> 10);
+
+        // USBの処理などは止めない
+        m_scheduler->Yield();
+    }
+    benchmark.finish(get_time_us());
+
+    m_platform_sound->set_output_enabled(m_fast_forward == 0);
+    benchmark.report(create_emu_path("%s_bench.txt", CONFIG_NAME));
+
+    // 実行中に押されたキーは捨てる
+    PlatformKeyEvent event;
+    while (pop_key_event(&event)) {
+    }
+}
+
+// 早送りの倍率を順に切り替える(早送り中は音声を出力しない)
+void EmuController::cycle_fast_forward()
+{
+    m_fast_forward = (m_fast_forward + 1) % FAST_FORWARD_COUNT;
+    m_fast_forward_frames = 0;
+    m_fast_forward_present_us = 0;
+    m_frame_skip->restart();
+    m_platform_sound->set_output_enabled(m_fast_forward == 0);
+
+    int multiplier = get_fast_forward_multiplier();
+    if (multiplier == 0) {
+        get_logger()->Write("EmuController", LogNotice, "Fast forward: max");
+    } else {
+        get_logger()->Write("EmuController", LogNotice, "Fast forward: %dx", multiplier);
+    }
+}
+
+int EmuController::get_fast_forward_multiplier()
+{
+    return s_fast_forward_multipliers[m_fast_forward];
+}
+
+// 早送り中にこのフレームを表示するか
+// 倍率が決まっている場合はそのフレーム数に1回、最高速の場合は一定時間ごとに表示する
+bool EmuController::fast_forward_present(u64 now)
+{
+    int multiplier = get_fast_forward_multiplier();
+    if (multiplier == 0) {
+        if (now - m_fast_forward_present_us < FAST_FORWARD_MAX_PRESENT_US) {
+            return false;
+        }
+        m_fast_forward_present_us = now;
+        return true;
+    }
+    if (++m_fast_forward_frames < multiplier) {
+        return false;
+    }
+    m_fast_forward_frames = 0;
+    return true;
+}
+
+const PlatformSpeedStats* EmuController::get_speed_stats()
+{
+    return m_speed_meter->get_stats();
+}
+
 int EmuController::get_frame_rate()
 {
     if (m_emu) {
@@ -604,3 +1112,193 @@ void EmuController::set_host_window_size(int width, int height, bool mode)
 {
     m_platform_screen->set_host_window_size(width, height, mode);
 }
+
+bool EmuController::start_input_recording()
+{
+    if (!m_emu || m_input_recorder->get_mode() != PlatformInputRecorder::MODE_IDLE) {
+        return false;
+    }
+
+    // リセット直後の状態から記録する
+    m_emu->reset();
+    m_input_frame = 0;
+    return m_input_recorder->start_recording(create_emu_path("%s.inp", CONFIG_NAME));
+}
+
+bool EmuController::start_input_playback()
+{
+    if (!m_emu || m_input_recorder->get_mode() != PlatformInputRecorder::MODE_IDLE) {
+        return false;
+    }
+
+    if (!m_input_recorder->start_playback(create_emu_path("%s.inp", CONFIG_NAME))) {
+        return false;
+    }
+
+    // 記録時と同じくリセット直後の状態から再生する
+    m_emu->reset();
+    m_input_frame = 0;
+    memset(rpi_gamepad_status, 0, sizeof(rpi_gamepad_status));
+    return true;
+}
+
+void EmuController::stop_input_movie()
+{
+    m_input_recorder->stop(m_input_frame);
+}
+
+bool EmuController::is_input_recording()
+{
+    return m_input_recorder && m_input_recorder->is_recording();
+}
+
+bool EmuController::is_input_playing()
+{
+    return m_input_recorder && m_input_recorder->is_playing();
+}
+
+u32 EmuController::get_ram_hash()
+{
+#ifndef USE_EXTERNAL_EMU
+    if (m_emu) {
+        return m_emu->get_ram_hash();
+    }
+#endif
+    return 0;
+}
+
+// VMを1フレーム進める前の入力記録・再生処理
+void EmuController::update_input_movie_before_run()
+{
+    if (m_input_recorder->is_recording()) {
+        m_input_recorder->record_gamepad(m_input_frame, rpi_gamepad_status);
+    } else if (m_input_recorder->is_playing()) {
+        // 記録されたフレームちょうどにイベントを流し込む
+        m_input_recorder->apply_gamepad(m_input_frame, rpi_gamepad_status);
+
+        PlatformKeyEvent event;
+        while (m_input_recorder->pop_key(m_input_frame, &event)) {
+            if (event.type == KEY_EVENT_DOWN) {
+                m_emu->key_down(event.code, event.extended, event.repeat);
+            } else {
+                m_emu->key_up(event.code, event.extended);
+            }
+        }
+    }
+}
+
+// VMを1フレーム進めた後の入力記録・再生処理
+void EmuController::update_input_movie_after_run()
+{
+    if (m_input_recorder->is_recording()) {
+        m_input_recorder->record_ram_hash(m_input_frame, get_ram_hash());
+    } else if (m_input_recorder->is_playing()) {
+        m_input_recorder->verify_ram_hash(m_input_frame, get_ram_hash());
+    }
+    m_input_frame++;
+
+    if (m_input_recorder->is_finished(m_input_frame)) {
+        m_input_recorder->stop(m_input_frame);
+    }
+}
+
+void EmuController::key_char(char code)
+{
+    // 1文字だけ自動キー入力で打つ(シフトの要否もエンジン側で判断する)
+    if (!m_auto_key->is_running()) {
+        m_auto_key->set_text(&code, 1);
+        start_auto_key();
+    }
+}
+
+void EmuController::set_auto_key_code(int code)
+{
+    m_auto_key->set_code(code);
+}
+
+void EmuController::set_auto_key_list(char *buf, int size)
+{
+    m_auto_key->set_text(buf, size);
+}
+
+bool EmuController::is_auto_key_running()
+{
+    return m_auto_key && m_auto_key->is_running();
+}
+
+void EmuController::start_auto_key()
+{
+    m_auto_key->set_speed(m_config->auto_key_speed);
+    m_auto_key->start();
+}
+
+void EmuController::stop_auto_key()
+{
+    m_auto_key->stop();
+}
+
+// テキストファイルを読み込んで自動キー入力を開始する
+bool EmuController::start_auto_key_file(const char* file_path)
+{
+    if (m_auto_key->is_running()) {
+        get_logger()->Write("AutoKey", LogWarning, "Auto key is already running");
+        return false;
+    }
+
+    FILE* fp = fopen(file_path, "rb");
+    if (!fp) {
+        get_logger()->Write("AutoKey", LogError, "Failed to open %s", file_path);
+        return false;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (size <= 0 || size > AUTO_KEY_MAX_FILE_SIZE) {
+        get_logger()->Write("AutoKey", LogError, "Invalid file size: %s (%ld bytes)", file_path, size);
+        fclose(fp);
+        return false;
+    }
+
+    char* buf = (char*)malloc(size);
+    if (!buf) {
+        get_logger()->Write("AutoKey", LogError, "Failed to allocate %ld bytes", size);
+        fclose(fp);
+        return false;
+    }
+    int read_size = (int)fread(buf, 1, size, fp);
+    fclose(fp);
+
+    set_auto_key_list(buf, read_size);
+    free(buf);
+
+    start_auto_key();
+    get_logger()->Write("AutoKey", LogNotice, "Auto key started: %s (%d bytes)", file_path, read_size);
+    return is_auto_key_running();
+}
+
+// VMを1フレーム進める前に自動キー入力のイベントを流し込む
+void EmuController::update_auto_key()
+{
+    // 入力再生中は記録されたキー入力を優先する
+    if (!m_auto_key->is_running() || m_input_recorder->is_playing()) {
+        return;
+    }
+
+    PlatformKeyEvent events[AUTO_KEY_MAX_EVENTS];
+    int count = m_auto_key->step(events, AUTO_KEY_MAX_EVENTS);
+    for (int i = 0; i < count; i++) {
+        if (m_input_recorder->is_recording()) {
+            m_input_recorder->record_key(m_input_frame, events[i]);
+        }
+        if (events[i].type == KEY_EVENT_DOWN) {
+            m_emu->key_down(events[i].code, false, false);
+        } else {
+            m_emu->key_up(events[i].code, false);
+        }
+    }
+
+    if (!m_auto_key->is_running()) {
+        get_logger()->Write("AutoKey", LogNotice, "Auto key finished");
+    }
+}
@@ -15,6 +15,18 @@ class PlatformMenu;
 class PlatformConfig;
 class ViceSound;
 class CGPIOPin;
+class PlatformInputRecorder;
+class PlatformLatency;
+class PlatformAutoKey;
+class PlatformSpeedMeter;
+class PlatformFrameSkip;
+class PlatformIdle;
+class PlatformThermal;
+class CInterruptSystem;
+struct PlatformSpeedStats;
+
+// USBデバイスの抜き差しを確認するためのコールバック
+typedef void TInputPollHandler(void* param);
 
 /// @brief エミュレーターのコントローラー(Facade)
 class EmuController: public IPlatformEmulator {
@@ -34,19 +46,84 @@ class EmuController: public IPlatformEmulator {
 
         CScheduler* m_scheduler;
 
+        // 入力の記録・再生
+        PlatformInputRecorder* m_input_recorder;
+        // エミュレーターを進めたフレーム数(入力記録のタイムスタンプ)
+        u32 m_input_frame;
+
+        // キーイベントキューのオーバーフロー数(報告済みのもの)
+        u32 m_key_overflow_reported;
+
+        // 入力遅延の計測
+        PlatformLatency* m_latency;
+        u32 m_gamepad_seen[MAX_GAMEPADS];
+        u64 m_next_overlay_update_us;
+        bool m_first_frame_presented;
+
+        // オーバーレイに表示する内容(速度と遅延、処理ごとの時間)
+        bool m_show_latency;
+        bool m_show_profile;
+
+        // エミュレーションの速度と負荷
+        PlatformSpeedMeter* m_speed_meter;
+        // 等速で実行中の表示の間引き
+        PlatformFrameSkip* m_frame_skip;
+        // SoCの温度とARMクロック(スロットリング)の監視
+        PlatformThermal* m_thermal;
+        // 待ち時間にコアを止める(WFI)
+        PlatformIdle* m_idle;
+
+        // 実行を要求されたベンチマークの秒数(0なら無し)
+        int m_benchmark_request;
+        void run_benchmark(int seconds);
+
+        // 早送り(倍率の番号、0なら等速)
+        int m_fast_forward;
+        int m_fast_forward_frames;
+        u64 m_fast_forward_present_us;
+
+        void cycle_fast_forward();
+        void handle_host_hotkey(int code, bool repeat);
+        int get_fast_forward_multiplier();
+        bool fast_forward_present(u64 now);
+
+        int present_screen();
+        void track_gamepad_latency();
+        void update_thermal();
+        void update_latency_report();
+        void update_overlay_visible();
+        void sleep_until(u64 until_us);
+
+        // 入力デバイスの定期確認
+        TInputPollHandler* m_input_poll_handler;
+        void* m_input_poll_param;
+        u64 m_next_input_poll_us;
+
+        void poll_input_devices();
+        void snapshot_gamepads();
+
+        void update_input_movie_before_run();
+        void update_input_movie_after_run();
+
+        // 自動キー入力
+        PlatformAutoKey* m_auto_key;
+        void update_auto_key();
+
         const char* get_config_path();
         platform_config_t* get_config() { return m_config; }
     public:
         EmuController();
         ~EmuController();
 
-        void initialize(int host_width, int host_height, int emu_width, int emu_height, int aspect_width, int aspect_height, ViceSound* sound_device, CScheduler* scheduler);
+        void initialize(int host_width, int host_height, int emu_width, int emu_height, int aspect_width, int aspect_height, ViceSound* sound_device, CScheduler* scheduler, CInterruptSystem* interrupt);
         int emulator_main();
 
         void set_host_window_size(int width, int height, bool mode);
 
         void push_key_event(KeyEventType type, uint8_t code, bool extended, bool repeat);
         bool pop_key_event(PlatformKeyEvent* pEvent);
+        u32 get_key_overflow_count();
+        void set_input_poll_handler(TInputPollHandler* handler, void* param);
     
         void key_down(int code, bool extended, bool repeat);
         void key_up(int code, bool extended);
@@ -58,6 +135,14 @@ class EmuController: public IPlatformEmulator {
         bool is_auto_key_running();
         void start_auto_key();
         void stop_auto_key();
+        bool start_auto_key_file(const char* file_path);
+
+        bool start_input_recording();
+        bool start_input_playback();
+        void stop_input_movie();
+        bool is_input_recording();
+        bool is_input_playing();
+        u32 get_ram_hash();
 
         void eject_floppy_disk(int drv);
         void insert_floppy_disk(int drv, const char* file_path, int bank = 0);
@@ -97,5 +182,17 @@ class EmuController: public IPlatformEmulator {
 
         u64 get_time_us();
 
+        // 直近1秒間の速度と負荷(まだ集計できていなければnullptr)
+        const PlatformSpeedStats* get_speed_stats();
+
+        // 表示の間引きの状態(割合と、その元になった処理時間の平均)
+        PlatformFrameSkip* get_frame_skip() { return m_frame_skip; }
+
+        // 最後に読み取った温度とクロック、スロットリングの状態
+        PlatformThermal* get_thermal() { return m_thermal; }
+
+        // 次のループでベンチマークを実行する(表示と音声を止めてseconds秒ぶん最高速で実行)
+        void request_benchmark(int seconds) { m_benchmark_request = seconds; }
+
         PlatformConfig* get_platform_config() { return m_platform_config; }
 };
\ No newline at end of file
@@ -1,16 +1,44 @@
 #include "FBConsole.hpp"
 #include <string.h>
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+// 文字色と背景色の組み合わせごとに、フォントの1行(8ビット)の全パターンを展開したもの
+struct FBConsoleSpanCache {
+    FBConsoleColor color;
+    FBConsoleColor bgColor;
+    bool valid;
+    uint32_t lastUsed;
+    FBConsoleColor spans8[256][8];
+    FBConsoleColor spans16[256][16];
+};
+
+static FBConsoleSpanCache spanCache[FB_CONSOLE_SPAN_CACHE_SLOTS];
+static uint32_t spanCacheTick = 0;
+
+// 8ピクセル(16バイト)をまとめて書く
+static inline void storeSpan8(FBConsoleColor* dst, const FBConsoleColor* src) {
+#ifdef __ARM_NEON
+    vst1q_u16(dst, vld1q_u16(src));
+#else
+    memcpy(dst, src, 8 * sizeof(FBConsoleColor));
+#endif
+}
 
 FBConsole::FBConsole(uint16_t width, uint16_t height)
-    : width(width), height(height), buffer(nullptr), buffer_owned(false), pitch(width) {}
+    : width(width), height(height), buffer(nullptr), buffer_owned(false), pitch(width),
+      dirty_rows(nullptr), dirty_min(1), dirty_max(0) {}
 
 FBConsole::FBConsole(uint16_t width, uint16_t height, FBConsoleColor* frame_buffer, size_t pitch)
-    : width(width), height(height), buffer(frame_buffer), buffer_owned(false), pitch(pitch) {}
+    : width(width), height(height), buffer(frame_buffer), buffer_owned(false), pitch(pitch),
+      dirty_rows(nullptr), dirty_min(1), dirty_max(0) {}
 
 FBConsole::~FBConsole() {
     if (buffer_owned && buffer != nullptr) {
         free(buffer);
     }
+    free(dirty_rows);
 }
 
 bool FBConsole::init(uint16_t* external_buffer, size_t pitch) {
@@ -27,20 +55,127 @@ bool FBConsole::init(uint16_t* external_buffer, size_t pitch) {
 
     this->pitch = pitch;
 
+    // 1行1ビット
+    free(dirty_rows);
+    dirty_rows = (uint32_t*)calloc((height + 31) / 32, sizeof(uint32_t));
+    if (dirty_rows == nullptr) {
+        return false;
+    }
+
     clear(0); // 黒で初期化
     return true;
 }
 
 void FBConsole::clear(FBConsoleColor color) {
-    for (uint32_t i = 0; i < width * height; i++) {
-        buffer[i] = color;
+    if (pitch == width) {
+        fillSpan(buffer, (uint32_t)width * height, color);
+    } else {
+        for (uint16_t y = 0; y < height; y++) {
+            fillSpan(buffer + y * pitch, width, color);
+        }
     }
+    markDirty(0, height - 1);
+}
+
+// count個のピクセルをcolorで埋める(まとめて書ける所は16バイト単位)
+void FBConsole::fillSpan(FBConsoleColor* dst, uint32_t count, FBConsoleColor color) {
+    uint32_t i = 0;
+#ifdef __ARM_NEON
+    uint16x8_t value = vdupq_n_u16(color);
+    for (; i + 8 <= count; i += 8) {
+        vst1q_u16(dst + i, value);
+    }
+#else
+    uint64_t value = color * 0x0001000100010001ULL;
+    for (; i + 4 <= count; i += 4) {
+        memcpy(dst + i, &value, sizeof(value));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = color;
+    }
+}
+
+const FBConsoleColor* FBConsole::getSpans(FBConsoleColor color, FBConsoleColor bgColor, bool wide) {
+    FBConsoleSpanCache* slot = nullptr;
+
+    spanCacheTick++;
+    for (int i = 0; i < FB_CONSOLE_SPAN_CACHE_SLOTS; i++) {
+        FBConsoleSpanCache* cache = &spanCache[i];
+        if (cache->valid && cache->color == color && cache->bgColor == bgColor) {
+            slot = cache;
+            break;
+        }
+        // 無ければ一番長く使っていないものを作り直す
+        if (!slot || (slot->valid && (!cache->valid || cache->lastUsed < slot->lastUsed))) {
+            slot = cache;
+        }
+    }
+
+    if (!slot->valid || slot->color != color || slot->bgColor != bgColor) {
+        for (int bits = 0; bits < 256; bits++) {
+            for (int col = 0; col < 8; col++) {
+                FBConsoleColor pixel = (bits & (1 << col)) ? color : bgColor;
+                slot->spans8[bits][col] = pixel;
+                slot->spans16[bits][col * 2] = pixel;
+                slot->spans16[bits][col * 2 + 1] = pixel;
+            }
+        }
+        slot->color = color;
+        slot->bgColor = bgColor;
+        slot->valid = true;
+    }
+    slot->lastUsed = spanCacheTick;
+
+    return wide ? &slot->spans16[0][0] : &slot->spans8[0][0];
 }
 
 void FBConsole::setPixel(uint16_t x, uint16_t y, FBConsoleColor color) {
     if (x < width && y < height) {
         buffer[y * pitch + x] = color;
+        markDirty(y, y);
+    }
+}
+
+// 行の記録をしない版(呼び出し側でまとめて記録する)
+void FBConsole::writePixel(uint16_t x, uint16_t y, FBConsoleColor color) {
+    if (x < width && y < height) {
+        buffer[y * pitch + x] = color;
+    }
+}
+
+void FBConsole::markDirty(uint16_t y1, uint16_t y2) {
+    if (dirty_rows == nullptr || y1 >= height) {
+        return;
+    }
+    if (y2 >= height) {
+        y2 = height - 1;
+    }
+    for (uint16_t y = y1; y <= y2; y++) {
+        dirty_rows[y >> 5] |= 1u << (y & 31);
+    }
+    if (!isDirty()) {
+        dirty_min = y1;
+        dirty_max = y2;
+    } else {
+        if (y1 < dirty_min) dirty_min = y1;
+        if (y2 > dirty_max) dirty_max = y2;
+    }
+}
+
+bool FBConsole::isRowDirty(uint16_t y) const {
+    if (dirty_rows == nullptr || y >= height) {
+        return false;
     }
+    return (dirty_rows[y >> 5] >> (y & 31)) & 1;
+}
+
+void FBConsole::clearDirty() {
+    if (dirty_rows != nullptr) {
+        memset(dirty_rows, 0, ((height + 31) / 32) * sizeof(uint32_t));
+    }
+    dirty_min = 1;
+    dirty_max = 0;
 }
 
 void FBConsole::drawChar(char c, uint16_t x, uint16_t y, FBConsoleColor color, FBConsoleColor bgColor, bool transparent) {
@@ -48,16 +183,18 @@ void FBConsole::drawChar(char c, uint16_t x, uint16_t y, FBConsoleColor color, F
 
     const unsigned char* fontData = font8x8_basic[(unsigned char)c];
 
-    for (uint8_t row = 0; row < 8; row++) {
-        char rowData = fontData[row];
-        for (uint8_t col = 0; col < 8; col++) {
-            if (rowData & (1 << col)) {
-                setPixel(x + col, y + row, color);
-            } else if (!transparent) {
-                setPixel(x + col, y + row, bgColor);
-            }
+    // 画面内に収まる不透明な文字は展開済みの行を8ピクセルずつ書く
+    if (!transparent && x + 8 <= width && y + 8 <= height) {
+        const FBConsoleColor* spans = getSpans(color, bgColor, false);
+        FBConsoleColor* dst = buffer + y * pitch + x;
+        for (uint8_t row = 0; row < 8; row++) {
+            storeSpan8(dst, spans + fontData[row] * 8);
+            dst += pitch;
         }
+    } else {
+        drawCharClipped(fontData, x, y, 1, color, bgColor, transparent);
     }
+    markDirty(y, y + 7);
 }
 
 void FBConsole::drawChar16(char c, uint16_t x, uint16_t y, FBConsoleColor color, FBConsoleColor bgColor, bool transparent) {
@@ -65,27 +202,63 @@ void FBConsole::drawChar16(char c, uint16_t x, uint16_t y, FBConsoleColor color,
 
     const unsigned char* fontData = font8x8_basic[(unsigned char)c];
 
+    // 各ピクセルを2x2の大きさで描画(展開済みの2倍幅の行を2回書く)
+    if (!transparent && x + 16 <= width && y + 16 <= height) {
+        const FBConsoleColor* spans = getSpans(color, bgColor, true);
+        FBConsoleColor* dst = buffer + y * pitch + x;
+        for (uint8_t row = 0; row < 8; row++) {
+            const FBConsoleColor* span = spans + fontData[row] * 16;
+            storeSpan8(dst, span);
+            storeSpan8(dst + 8, span + 8);
+            storeSpan8(dst + pitch, span);
+            storeSpan8(dst + pitch + 8, span + 8);
+            dst += pitch * 2;
+        }
+    } else {
+        drawCharClipped(fontData, x, y, 2, color, bgColor, transparent);
+    }
+    markDirty(y, y + 15);
+}
+
+// 画面端にかかる文字や透過の文字は1ピクセルずつ範囲を確認して描く
+void FBConsole::drawCharClipped(const unsigned char* fontData, uint16_t x, uint16_t y, int scale, FBConsoleColor color, FBConsoleColor bgColor, bool transparent) {
     for (uint8_t row = 0; row < 8; row++) {
         char rowData = fontData[row];
         for (uint8_t col = 0; col < 8; col++) {
-            if (rowData & (1 << col)) {
-                // 各ピクセルを2x2の大きさで描画
-                setPixel(x + col*2, y + row*2, color);
-                setPixel(x + col*2 + 1, y + row*2, color);
-                setPixel(x + col*2, y + row*2 + 1, color);
-                setPixel(x + col*2 + 1, y + row*2 + 1, color);
-            } else if (!transparent) {
-                // 背景ピクセルも2x2の大きさで描画
-                setPixel(x + col*2, y + row*2, bgColor);
-                setPixel(x + col*2 + 1, y + row*2, bgColor);
-                setPixel(x + col*2, y + row*2 + 1, bgColor);
-                setPixel(x + col*2 + 1, y + row*2 + 1, bgColor);
+            bool set = rowData & (1 << col);
+            if (!set && transparent) {
+                continue;
+            }
+            for (int dy = 0; dy < scale; dy++) {
+                for (int dx = 0; dx < scale; dx++) {
+                    writePixel(x + col * scale + dx, y + row * scale + dy, set ? color : bgColor);
+                }
             }
         }
     }
 }
 
 void FBConsole::drawString(const char* str, uint16_t x, uint16_t y, FBConsoleColor color, FBConsoleColor bgColor, bool transparent) {
+    size_t length = strlen(str);
+
+    // 1行に収まる不透明な文字列は範囲の確認を最初に1回だけ行う
+    if (!transparent && y + 8 <= height && x + length * 8 <= width) {
+        const FBConsoleColor* spans = getSpans(color, bgColor, false);
+        FBConsoleColor* dst = buffer + y * pitch + x;
+        for (; *str; str++, dst += 8) {
+            unsigned char c = (unsigned char)*str;
+            if (c > 127) continue;
+            const unsigned char* fontData = font8x8_basic[c];
+            FBConsoleColor* line = dst;
+            for (uint8_t row = 0; row < 8; row++) {
+                storeSpan8(line, spans + fontData[row] * 8);
+                line += pitch;
+            }
+        }
+        markDirty(y, y + 7);
+        return;
+    }
+
     uint16_t currentX = x;
 
     while (*str) {
@@ -129,6 +302,8 @@ void FBConsole::scrollUp(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uin
         return;
     }
 
+    markDirty(y1, y2);
+
     // スクロールする行数が矩形の高さ以上の場合は、単に塗りつぶす
     if (lines >= (y2 - y1 + 1)) {
         for (uint16_t y = y1; y <= y2; y++) {
@@ -160,6 +335,8 @@ void FBConsole::scrollDown(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, u
         return;
     }
 
+    markDirty(y1, y2);
+
     // スクロールする行数が矩形の高さ以上の場合は、単に塗りつぶす
     if (lines >= (y2 - y1 + 1)) {
         for (uint16_t y = y1; y <= y2; y++) {
@@ -208,6 +385,7 @@ FBConsoleColor FBConsole::Color_fromRGB8(uint8_t r, uint8_t g, uint8_t b) {
 void FBConsole::putPixel(uint16_t x, uint16_t y, FBConsoleColor color) {
     if (x < width && y < height) {
         buffer[y * pitch + x] = color;
+        markDirty(y, y);
     }
 }
 
@@ -218,4 +396,5 @@ void FBConsole::drawHLine(uint16_t x1, uint16_t x2, uint16_t y, FBConsoleColor c
     for (uint16_t x = x1; x <= x2; x++) {
         buffer[y * pitch + x] = color;
     }
+    markDirty(y, y);
 }
\ No newline at end of file
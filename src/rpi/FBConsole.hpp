@@ -8,6 +8,9 @@
 
 typedef uint16_t FBConsoleColor;
 
+// 文字色と背景色の組み合わせごとに展開したフォントの行を保持する数
+#define FB_CONSOLE_SPAN_CACHE_SLOTS 4
+
 class FBConsole {
 public:
     FBConsole(uint16_t width, uint16_t height);
@@ -29,6 +32,14 @@ public:
     uint16_t getWidth() const;
     uint16_t getHeight() const;
 
+    // 描画した行を記録し、変更のあった行だけを転送できるようにする
+    void markDirty(uint16_t y1, uint16_t y2);
+    bool isDirty() const { return dirty_min <= dirty_max; }
+    bool isRowDirty(uint16_t y) const;
+    uint16_t getDirtyMin() const { return dirty_min; }
+    uint16_t getDirtyMax() const { return dirty_max; }
+    void clearDirty();
+
     static FBConsoleColor Color_fromRGB(uint8_t r, uint8_t g, uint8_t b);
     static FBConsoleColor Color_fromRGB8(uint8_t r, uint8_t g, uint8_t b);
 
@@ -38,6 +49,18 @@ private:
     FBConsoleColor* buffer;
     bool buffer_owned;
     size_t pitch;
+
+    // 変更のあった行のビットと、その範囲
+    uint32_t* dirty_rows;
+    uint16_t dirty_min;
+    uint16_t dirty_max;
+
+    void writePixel(uint16_t x, uint16_t y, FBConsoleColor color);
+    void drawCharClipped(const unsigned char* fontData, uint16_t x, uint16_t y, int scale, FBConsoleColor color, FBConsoleColor bgColor, bool transparent);
+    void fillSpan(FBConsoleColor* dst, uint32_t count, FBConsoleColor color);
+
+    // フォントの1行(8ビット)を展開したピクセル列を返す(wideなら2倍幅)
+    static const FBConsoleColor* getSpans(FBConsoleColor color, FBConsoleColor bgColor, bool wide);
 };
 
 #endif // FB_CONSOLE_HPP 
\ No newline at end of file
@@ -0,0 +1,211 @@
+#include "PlatformAutoKey.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// シフトキー(KeyStatusHandlerRawと同じく左シフト)
+#define AUTO_KEY_VK_SHIFT 0xA0
+// 0x100が立っているものはシフトを押しながら入力する
+#define AUTO_KEY_SHIFT 0x100
+
+// ASCII → 仮想キーコード変換テーブル(日本語キーボード配列)
+// 英字は大文字/小文字ともシフト無しで入力する(当時の機種は基本的に英大文字入力のため)
+static const u16 ascii_to_vk[128] = {
+    // 0x00-0x0f (TAB, LF/CRはリターン)
+    0, 0, 0, 0, 0, 0, 0, 0, 0x08, 0x09, 0x0D, 0, 0, 0x0D, 0, 0,
+    // 0x10-0x1f (ESC)
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x1B, 0, 0, 0, 0,
+    // 0x20-0x2f  ! " # $ % & ' ( ) * + , - . /
+    0x20, 0x131, 0x132, 0x133, 0x134, 0x135, 0x136, 0x137,
+    0x138, 0x139, 0x1BA, 0x1BB, 0xBC, 0xBD, 0xBE, 0xBF,
+    // 0x30-0x3f 0-9 : ; < = > ?
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+    0x38, 0x39, 0xBA, 0xBB, 0x1BC, 0x1BD, 0x1BE, 0x1BF,
+    // 0x40-0x5f @ A-Z [ \ ] ^ _
+    0xC0, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+    0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,
+    0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57,
+    0x58, 0x59, 0x5A, 0xDB, 0xDC, 0xDD, 0xDE, 0x1E2,
+    // 0x60-0x7f ` a-z { | } ~
+    0x1C0, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+    0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,
+    0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57,
+    0x58, 0x59, 0x5A, 0x1DB, 0x1DC, 0x1DD, 0x1DE, 0
+};
+
+// 速度設定ごとの押下/解放フレーム数
+static const int auto_key_speed_table[][2] = {
+    {3, 3},     // AUTO_KEY_SPEED_NORMAL
+    {2, 1},     // AUTO_KEY_SPEED_FAST
+    {1, 1},     // AUTO_KEY_SPEED_FASTEST
+};
+
+PlatformAutoKey::PlatformAutoKey()
+:
+    m_state(STATE_IDLE),
+    m_text(nullptr),
+    m_size(0),
+    m_pos(0),
+    m_single_code(-1),
+    m_current_vk(0),
+    m_current_shift(false),
+    m_wait(0),
+    m_hold_frames(3),
+    m_gap_frames(3),
+    m_stop_requested(false)
+{
+}
+
+PlatformAutoKey::~PlatformAutoKey()
+{
+    if (m_text) {
+        free(m_text);
+        m_text = nullptr;
+    }
+}
+
+bool PlatformAutoKey::char_to_vk(char c, u8* vk, bool* shift)
+{
+    unsigned char code = (unsigned char)c;
+    if (code >= 128 || ascii_to_vk[code] == 0) {
+        return false;
+    }
+    *vk = (u8)(ascii_to_vk[code] & 0xFF);
+    *shift = (ascii_to_vk[code] & AUTO_KEY_SHIFT) != 0;
+    return true;
+}
+
+bool PlatformAutoKey::set_text(const char* buf, int size)
+{
+    if (m_state != STATE_IDLE || !buf || size <= 0) {
+        return false;
+    }
+
+    char* text = (char*)realloc(m_text, size);
+    if (!text) {
+        return false;
+    }
+    memcpy(text, buf, size);
+    m_text = text;
+    m_size = size;
+    m_pos = 0;
+    m_single_code = -1;
+    return true;
+}
+
+void PlatformAutoKey::set_code(int code)
+{
+    if (m_state != STATE_IDLE) {
+        return;
+    }
+    m_single_code = code & 0xFF;
+    m_size = 0;
+    m_pos = 0;
+}
+
+void PlatformAutoKey::set_speed(int speed)
+{
+    if (speed < AUTO_KEY_SPEED_NORMAL || speed > AUTO_KEY_SPEED_FASTEST) {
+        speed = AUTO_KEY_SPEED_NORMAL;
+    }
+    m_hold_frames = auto_key_speed_table[speed][0];
+    m_gap_frames = auto_key_speed_table[speed][1];
+}
+
+void PlatformAutoKey::start()
+{
+    if (m_state != STATE_IDLE) {
+        return;
+    }
+    if (m_single_code < 0 && m_pos >= m_size) {
+        return;
+    }
+    m_stop_requested = false;
+    m_wait = 0;
+    m_state = STATE_PRESS;
+}
+
+void PlatformAutoKey::stop()
+{
+    // 押しているキーがあれば次のstepで離してから止まる
+    m_stop_requested = true;
+}
+
+// 次に入力するキーを取り出す(変換できない文字は読み飛ばす)
+bool PlatformAutoKey::next_key(u8* vk, bool* shift)
+{
+    if (m_single_code >= 0) {
+        *vk = (u8)m_single_code;
+        *shift = false;
+        m_single_code = -1;
+        return true;
+    }
+
+    while (m_pos < m_size) {
+        char c = m_text[m_pos++];
+        // CR+LFは1回のリターンにする
+        if (c == '\r' && m_pos < m_size && m_text[m_pos] == '\n') {
+            continue;
+        }
+        if (char_to_vk(c, vk, shift)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int PlatformAutoKey::step(PlatformKeyEvent* events, int max_events)
+{
+    int count = 0;
+
+    if (m_state == STATE_IDLE || max_events < 2) {
+        return 0;
+    }
+
+    // 停止要求があれば押しているキーを離して止める
+    if (m_stop_requested) {
+        if (m_state == STATE_RELEASE) {
+            events[count++] = { KEY_EVENT_UP, m_current_vk, false, false, 0 };
+            if (m_current_shift) {
+                events[count++] = { KEY_EVENT_UP, AUTO_KEY_VK_SHIFT, false, false, 0 };
+            }
+        }
+        m_state = STATE_IDLE;
+        m_stop_requested = false;
+        return count;
+    }
+
+    if (m_wait > 0) {
+        m_wait--;
+        return 0;
+    }
+
+    if (m_state == STATE_PRESS) {
+        if (!next_key(&m_current_vk, &m_current_shift)) {
+            // 全て入力し終わった
+            m_state = STATE_IDLE;
+            return 0;
+        }
+        if (m_current_shift) {
+            events[count++] = { KEY_EVENT_DOWN, AUTO_KEY_VK_SHIFT, false, false, 0 };
+        }
+        events[count++] = { KEY_EVENT_DOWN, m_current_vk, false, false, 0 };
+        m_wait = m_hold_frames - 1;
+        m_state = STATE_RELEASE;
+    } else {
+        events[count++] = { KEY_EVENT_UP, m_current_vk, false, false, 0 };
+        if (m_current_shift) {
+            events[count++] = { KEY_EVENT_UP, AUTO_KEY_VK_SHIFT, false, false, 0 };
+        }
+        m_wait = (m_current_vk == 0x0D) ? AUTO_KEY_NEWLINE_WAIT_FRAMES : m_gap_frames - 1;
+
+        // 最後のキーを離したら終了
+        if (m_single_code < 0 && m_pos >= m_size) {
+            m_state = STATE_IDLE;
+        } else {
+            m_state = STATE_PRESS;
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,76 @@
+#ifndef _PLATFORM_AUTO_KEY_H_
+#define _PLATFORM_AUTO_KEY_H_
+
+#include <circle/types.h>
+#include "PlatformInput.h"
+
+// 1フレームで発生し得るキーイベントの最大数(シフト+キー)
+#define AUTO_KEY_MAX_EVENTS 4
+
+// 速度設定(auto_key_speed)ごとのキーを押している/離しているフレーム数
+#define AUTO_KEY_SPEED_NORMAL  0
+#define AUTO_KEY_SPEED_FAST    1
+#define AUTO_KEY_SPEED_FASTEST 2
+
+// 読み込むテキストファイルの最大サイズ
+#define AUTO_KEY_MAX_FILE_SIZE (256 * 1024)
+
+// 改行(リターンキー)の後は行の処理を待つため長めに待つ
+#define AUTO_KEY_NEWLINE_WAIT_FRAMES 8
+
+/// @brief テキストを仮想キーコードの押下/解放に変換してフレーム単位で送り出す自動入力エンジン
+/// Circleの機能には依存していないので、ホスト側でも単体で動作確認できる
+class PlatformAutoKey {
+    private:
+        enum State {
+            STATE_IDLE,
+            STATE_PRESS,
+            STATE_RELEASE
+        };
+
+        State m_state;
+
+        // 入力するテキスト(コピーして保持)
+        char* m_text;
+        int m_size;
+        int m_pos;
+
+        // set_codeで指定された単発のキー(-1で無し)
+        int m_single_code;
+
+        // 押しているキー
+        u8 m_current_vk;
+        bool m_current_shift;
+
+        // 待ちフレーム数
+        int m_wait;
+        int m_hold_frames;
+        int m_gap_frames;
+
+        bool m_stop_requested;
+
+        bool next_key(u8* vk, bool* shift);
+
+    public:
+        PlatformAutoKey();
+        ~PlatformAutoKey();
+
+        // 入力するテキストを設定(改行はリターンキーになる)
+        bool set_text(const char* buf, int size);
+        // 単発のキーを設定
+        void set_code(int code);
+        // 速度を設定(AUTO_KEY_SPEED_*)
+        void set_speed(int speed);
+
+        void start();
+        void stop();
+        bool is_running() { return m_state != STATE_IDLE; }
+
+        // 1フレーム進め、発生したキーイベントをeventsに格納してその数を返す
+        int step(PlatformKeyEvent* events, int max_events);
+
+        // 文字を仮想キーコードに変換(日本語キーボード配列前提)
+        static bool char_to_vk(char c, u8* vk, bool* shift);
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include "PlatformBenchmark.h"
+#include "PlatformLog.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+static const char* s_stage_names[BENCHMARK_STAGE_COUNT] = {
+    "run", "draw"
+};
+
+PlatformBenchmark::PlatformBenchmark(int seconds)
+:
+    m_seconds(seconds),
+    m_cpu_clock_hz(0),
+    m_start_us(0),
+    m_end_us(0),
+    m_emulated_us(0),
+    m_frames(0),
+    m_aborted(false)
+{
+}
+
+void PlatformBenchmark::start(u64 now)
+{
+    m_start_us = now;
+    m_end_us = now;
+    m_emulated_us = 0;
+    m_frames = 0;
+    m_aborted = false;
+    for (int i = 0; i < BENCHMARK_STAGE_COUNT; i++) {
+        m_stages[i].clear();
+    }
+}
+
+void PlatformBenchmark::add_frames(int frames, u32 frame_us)
+{
+    m_frames += frames;
+    m_emulated_us += (u64)frames * frame_us;
+}
+
+bool PlatformBenchmark::is_finished(u64 now)
+{
+    if (m_emulated_us >= (u64)m_seconds * 1000000) {
+        return true;
+    }
+    if (now - m_start_us >= (u64)m_seconds * 1000000 * BENCHMARK_WALL_LIMIT_FACTOR) {
+        m_aborted = true;
+        return true;
+    }
+    return false;
+}
+
+// 1行をシリアルに出力し、ファイルが開けていればそちらにも書き込む
+void PlatformBenchmark::write_line(FILE* fp, const char* format, ...)
+{
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    get_logger()->Write("Benchmark", LogNotice, "%s", line);
+    if (fp) {
+        fprintf(fp, "%s\n", line);
+    }
+}
+
+void PlatformBenchmark::report(const char* path)
+{
+    // 結果は追記していき、以前の実行と並べて比較できるようにする
+    FILE* fp = fopen(path, "a");
+    if (!fp) {
+        get_logger()->Write("Benchmark", LogError, "Failed to open %s", path);
+    }
+
+    u64 wall_us = m_end_us - m_start_us;
+    if (wall_us == 0) {
+        wall_us = 1;
+    }
+    u32 wall_ms = (u32)(wall_us / 1000);
+    u32 fps10 = (u32)((u64)m_frames * 10000000 / wall_us);
+    u32 speed100 = (u32)(m_emulated_us * 100 / wall_us);
+
+    write_line(fp, "RPi %d, built %s %s, %u emulated seconds%s", RPI_MODEL, __DATE__, __TIME__, m_seconds,
+        m_aborted ? " (aborted: emulated time did not advance)" : "");
+    write_line(fp, "%u frames in %u.%03u s, %u.%u fps, %u.%02ux speed",
+        m_frames, wall_ms / 1000, wall_ms % 1000, fps10 / 10, fps10 % 10, speed100 / 100, speed100 % 100);
+    if (m_cpu_clock_hz) {
+        // 公称クロックに速度の比をかけたもの
+        u32 khz = (u32)((u64)m_cpu_clock_hz / 1000 * m_emulated_us / wall_us);
+        write_line(fp, "%u.%03u emulated MHz (nominal %u.%03u MHz)",
+            khz / 1000, khz % 1000, m_cpu_clock_hz / 1000000, (m_cpu_clock_hz / 1000) % 1000);
+    }
+
+    char histogram[160];
+    for (int i = 0; i < BENCHMARK_STAGE_COUNT; i++) {
+        ProfileStageStats* stats = &m_stages[i];
+        stats->format_histogram(histogram, sizeof(histogram));
+        write_line(fp, "%-5s n=%u min=%u avg=%u max=%u us, hist(us):%s",
+            s_stage_names[i], stats->get_count(), stats->get_min(), stats->get_average(), stats->get_max(), histogram);
+    }
+
+    if (fp) {
+        fputc('\n', fp);
+        if (ferror(fp)) {
+            get_logger()->Write("Benchmark", LogError, "Failed to write %s", path);
+        }
+        fclose(fp);
+    }
+}
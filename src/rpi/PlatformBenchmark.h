@@ -0,0 +1,53 @@
+#ifndef _PLATFORM_BENCHMARK_H_
+#define _PLATFORM_BENCHMARK_H_
+
+#include <circle/types.h>
+
+#include "PlatformProfiler.h"
+
+// エミュレーション時間が進まない場合に打ち切るまでの実時間(指定秒数の倍数)
+#define BENCHMARK_WALL_LIMIT_FACTOR 10
+
+// 計測する処理
+enum BenchmarkStage {
+    BENCHMARK_STAGE_RUN = 0,    // EMU::run(サウンドの生成を含む)
+    BENCHMARK_STAGE_DRAW,       // VM::draw_screen(フレームバッファへの転送は行わない)
+    BENCHMARK_STAGE_COUNT
+};
+
+/// @brief 表示と音声の出力を止めて最高速で実行した結果を集計し、シリアルとファイルに出力する
+/// 毎回リセットから指定したエミュレーション時間だけ実行するので、ビルドやボードの違いを比較できる
+class PlatformBenchmark {
+    private:
+        u32 m_seconds;
+        u32 m_cpu_clock_hz;
+
+        u64 m_start_us;
+        u64 m_end_us;
+        u64 m_emulated_us;
+        u32 m_frames;
+        bool m_aborted;
+
+        ProfileStageStats m_stages[BENCHMARK_STAGE_COUNT];
+
+        void write_line(FILE* fp, const char* format, ...);
+
+    public:
+        PlatformBenchmark(int seconds);
+
+        // VMのCPUクロック(Hz)。エミュレーションのMHzの計算に使う(0なら出力しない)
+        void set_cpu_clock(u32 hz) { m_cpu_clock_hz = hz; }
+
+        void start(u64 now);
+        void add(int stage, u32 us) { m_stages[stage].add(us); }
+        // VMをframes進めた(frame_usは1フレームのエミュレーション時間)
+        void add_frames(int frames, u32 frame_us);
+        // 指定したエミュレーション時間に達したか(進まない場合は打ち切る)
+        bool is_finished(u64 now);
+        void finish(u64 now) { m_end_us = now; }
+
+        // 結果をシリアルに出力し、pathのファイルに追記する
+        void report(const char* path);
+};
+
+#endif
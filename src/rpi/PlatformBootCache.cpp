@@ -0,0 +1,243 @@
+#include "PlatformBootCache.h"
+#include "PlatformLog.h"
+#include "config.hpp"
+
+#include <fatfs/ff.h>
+#include <stdio.h>
+#include <string.h>
+
+PlatformBootCache::PlatformBootCache(const char* path)
+:
+    m_menu_data(nullptr),
+    m_dirty(false)
+{
+    strncpy(m_path, path, sizeof(m_path) - 1);
+    m_path[sizeof(m_path) - 1] = '\0';
+
+    memset(&m_data, 0, sizeof(m_data));
+    for (int i = 0; i < BOOT_CACHE_SOURCE_COUNT; i++) {
+        m_source_path[i][0] = '\0';
+        m_valid[i] = false;
+    }
+}
+
+PlatformBootCache::~PlatformBootCache()
+{
+    if (m_menu_data) {
+        delete[] m_menu_data;
+        m_menu_data = nullptr;
+    }
+}
+
+void PlatformBootCache::set_source(BootCacheSource source, const char* path)
+{
+    strncpy(m_source_path[source], path, _MAX_PATH - 1);
+    m_source_path[source][_MAX_PATH - 1] = '\0';
+}
+
+void PlatformBootCache::get_stamp(const char* path, BootCacheStamp* stamp)
+{
+    FILINFO info;
+    if (path[0] == '\0' || f_stat(path, &info) != FR_OK) {
+        stamp->size = BOOT_CACHE_NO_FILE;
+        stamp->time_hash = 0;
+        return;
+    }
+
+    stamp->size = (u32)info.fsize;
+    // 日付と時刻をFNV-1aで混ぜる
+    u32 hash = 2166136261u;
+    u32 values[2] = { info.fdate, info.ftime };
+    for (int i = 0; i < 2; i++) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            hash ^= (values[i] >> shift) & 0xFF;
+            hash *= 16777619u;
+        }
+    }
+    stamp->time_hash = hash;
+}
+
+bool PlatformBootCache::load()
+{
+    FILE* fp = fopen(m_path, "rb");
+    if (!fp) {
+        get_logger()->Write("BootCache", LogNotice, "No boot cache: %s", m_path);
+        return false;
+    }
+    bool result = fread(&m_data, sizeof(m_data), 1, fp) == 1;
+
+    if (!result || m_data.magic != BOOT_CACHE_MAGIC || m_data.version != BOOT_CACHE_VERSION ||
+        m_data.config_size != sizeof(platform_config_t) || m_data.config_layout != PlatformConfig::get_layout_hash() ||
+        m_data.menu_size > BOOT_CACHE_MAX_MENU_SIZE) {
+        fclose(fp);
+        get_logger()->Write("BootCache", LogNotice, "Boot cache is invalid, rebuilding");
+        memset(&m_data, 0, sizeof(m_data));
+        return false;
+    }
+
+    // メニューの木(続きの部分)
+    if (m_data.menu_size) {
+        m_menu_data = new u8[m_data.menu_size];
+        if (fread(m_menu_data, m_data.menu_size, 1, fp) != 1) {
+            delete[] m_menu_data;
+            m_menu_data = nullptr;
+            m_data.menu_size = 0;
+        }
+    }
+    fclose(fp);
+    if (!m_menu_data) {
+        m_data.valid_mask &= ~(1 << BOOT_CACHE_SOURCE_MENU_CFG);
+    }
+
+    // 元ファイルと一致するものだけ使う
+    bool any_valid = false;
+    for (int i = 0; i < BOOT_CACHE_SOURCE_COUNT; i++) {
+        BootCacheStamp stamp;
+        get_stamp(m_source_path[i], &stamp);
+        m_valid[i] = (m_data.valid_mask & (1 << i)) &&
+                     stamp.size == m_data.stamps[i].size && stamp.time_hash == m_data.stamps[i].time_hash;
+        if (!m_valid[i]) {
+            m_data.valid_mask &= ~(1 << i);
+        }
+        any_valid = any_valid || m_valid[i];
+    }
+    return any_valid;
+}
+
+bool PlatformBootCache::save()
+{
+    if (!m_dirty) {
+        return true;
+    }
+
+    m_data.magic = BOOT_CACHE_MAGIC;
+    m_data.version = BOOT_CACHE_VERSION;
+    m_data.config_size = sizeof(platform_config_t);
+    m_data.config_layout = PlatformConfig::get_layout_hash();
+    m_data.menu_size = (m_data.valid_mask & (1 << BOOT_CACHE_SOURCE_MENU_CFG)) && m_menu_data ? m_data.menu_size : 0;
+
+    FILE* fp = fopen(m_path, "wb");
+    if (!fp) {
+        get_logger()->Write("BootCache", LogError, "Failed to open %s for writing", m_path);
+        return false;
+    }
+    bool result = fwrite(&m_data, sizeof(m_data), 1, fp) == 1;
+    if (result && m_data.menu_size) {
+        result = fwrite(m_menu_data, m_data.menu_size, 1, fp) == 1;
+    }
+    result = (fclose(fp) == 0) && result;
+
+    if (result) {
+        m_dirty = false;
+        get_logger()->Write("BootCache", LogNotice, "Boot cache written: %s", m_path);
+    } else {
+        get_logger()->Write("BootCache", LogError, "Failed to write %s", m_path);
+    }
+    return result;
+}
+
+void PlatformBootCache::invalidate(BootCacheSource source)
+{
+    if (!(m_data.valid_mask & (1 << source))) {
+        return;
+    }
+
+    // FATの更新日時は精度が低く、サイズも変わらないことがあるので確実に消しておく
+    m_valid[source] = false;
+    m_data.valid_mask &= ~(1 << source);
+    remove(m_path);
+    m_dirty = m_data.valid_mask != 0;
+}
+
+bool PlatformBootCache::restore_buttons(SystemConfiguration* config)
+{
+    if (!m_valid[BOOT_CACHE_SOURCE_CONFIG_SYS]) {
+        return false;
+    }
+
+    SystemConfiguration::Button** buttons[BOOT_CACHE_BUTTON_COUNT] = {
+        &config->buttonA, &config->buttonB, &config->buttonStart, &config->buttonSelect,
+        &config->buttonUp, &config->buttonDown, &config->buttonLeft, &config->buttonRight
+    };
+    for (int i = 0; i < BOOT_CACHE_BUTTON_COUNT; i++) {
+        const BootCacheButton* cached = &m_data.buttons[i];
+        SystemConfiguration::ButtonType type = (SystemConfiguration::ButtonType)cached->type;
+
+        delete *buttons[i];
+        if (cached->is_axis) {
+            *buttons[i] = new SystemConfiguration::Button(type, (int)cached->axis_index, cached->compare_less_than != 0, (int)cached->compare_value);
+        } else {
+            *buttons[i] = new SystemConfiguration::Button(type, (unsigned)cached->bit_mask);
+        }
+    }
+    return true;
+}
+
+void PlatformBootCache::store_buttons(SystemConfiguration* config)
+{
+    SystemConfiguration::Button* buttons[BOOT_CACHE_BUTTON_COUNT] = {
+        config->buttonA, config->buttonB, config->buttonStart, config->buttonSelect,
+        config->buttonUp, config->buttonDown, config->buttonLeft, config->buttonRight
+    };
+    for (int i = 0; i < BOOT_CACHE_BUTTON_COUNT; i++) {
+        BootCacheButton* cached = &m_data.buttons[i];
+        memset(cached, 0, sizeof(BootCacheButton));
+        cached->type = (u8)buttons[i]->type;
+        cached->is_axis = buttons[i]->isAxis ? 1 : 0;
+        cached->compare_less_than = buttons[i]->compareLessThan ? 1 : 0;
+        cached->bit_mask = buttons[i]->bitMask;
+        cached->axis_index = buttons[i]->axisIndex;
+        cached->compare_value = buttons[i]->compareValue;
+    }
+
+    get_stamp(m_source_path[BOOT_CACHE_SOURCE_CONFIG_SYS], &m_data.stamps[BOOT_CACHE_SOURCE_CONFIG_SYS]);
+    m_data.valid_mask |= 1 << BOOT_CACHE_SOURCE_CONFIG_SYS;
+    m_valid[BOOT_CACHE_SOURCE_CONFIG_SYS] = true;
+    m_dirty = true;
+}
+
+bool PlatformBootCache::restore_config(platform_config_t* config)
+{
+    if (!m_valid[BOOT_CACHE_SOURCE_INI]) {
+        return false;
+    }
+    memcpy(config, &m_data.config, sizeof(platform_config_t));
+    return true;
+}
+
+void PlatformBootCache::store_config(const platform_config_t* config)
+{
+    memcpy(&m_data.config, config, sizeof(platform_config_t));
+
+    get_stamp(m_source_path[BOOT_CACHE_SOURCE_INI], &m_data.stamps[BOOT_CACHE_SOURCE_INI]);
+    m_data.valid_mask |= 1 << BOOT_CACHE_SOURCE_INI;
+    m_valid[BOOT_CACHE_SOURCE_INI] = true;
+    m_dirty = true;
+}
+
+const void* PlatformBootCache::restore_menu(u32* size)
+{
+    if (!m_valid[BOOT_CACHE_SOURCE_MENU_CFG] || !m_menu_data) {
+        return nullptr;
+    }
+    *size = m_data.menu_size;
+    return m_menu_data;
+}
+
+void PlatformBootCache::store_menu(const void* data, u32 size)
+{
+    if (size == 0 || size > BOOT_CACHE_MAX_MENU_SIZE) {
+        return;
+    }
+    if (m_menu_data) {
+        delete[] m_menu_data;
+    }
+    m_menu_data = new u8[size];
+    memcpy(m_menu_data, data, size);
+    m_data.menu_size = size;
+
+    get_stamp(m_source_path[BOOT_CACHE_SOURCE_MENU_CFG], &m_data.stamps[BOOT_CACHE_SOURCE_MENU_CFG]);
+    m_data.valid_mask |= 1 << BOOT_CACHE_SOURCE_MENU_CFG;
+    m_valid[BOOT_CACHE_SOURCE_MENU_CFG] = true;
+    m_dirty = true;
+}
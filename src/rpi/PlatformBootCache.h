@@ -0,0 +1,104 @@
+#ifndef _PLATFORM_BOOT_CACHE_H_
+#define _PLATFORM_BOOT_CACHE_H_
+
+#include <circle/types.h>
+#include "PlatformCommon.h"
+#ifdef USE_EXTERNAL_EMU
+#include "../emu.h"
+#else
+#include "PlatformEmu.h"
+#endif
+#include "PlatformConfig.h"
+
+class SystemConfiguration;
+
+#define BOOT_CACHE_MAGIC   0x43425052   // 'RPBC'
+#define BOOT_CACHE_VERSION 2
+// メニューの木として受け付ける最大のバイト数(壊れたキャッシュで大きな領域を確保しないように)
+#define BOOT_CACHE_MAX_MENU_SIZE 32768
+
+// キャッシュの元になるテキストファイル
+enum BootCacheSource {
+    BOOT_CACHE_SOURCE_CONFIG_SYS,   // config.sys(ジョイスティック設定)
+    BOOT_CACHE_SOURCE_INI,          // emuconf.ini(platform_config_t)
+    BOOT_CACHE_SOURCE_MENU_CFG,     // menu.cfg(解析済みのメニューの木)
+    BOOT_CACHE_SOURCE_COUNT
+};
+
+// 元ファイルの同一性の確認用(サイズと更新日時)
+struct BootCacheStamp {
+    u32 size;           // ファイルが無い場合はBOOT_CACHE_NO_FILE
+    u32 time_hash;
+};
+
+#define BOOT_CACHE_NO_FILE 0xFFFFFFFF
+
+// SystemConfiguration::Buttonを展開したもの
+struct BootCacheButton {
+    u8 type;
+    u8 is_axis;
+    u8 compare_less_than;
+    u8 reserved;
+    u32 bit_mask;
+    s32 axis_index;
+    s32 compare_value;
+};
+
+#define BOOT_CACHE_BUTTON_COUNT 8
+
+// キャッシュファイルの内容(1回のfreadで読み込む。メニューの木はこの後にmenu_sizeバイト続く)
+struct BootCacheData {
+    u32 magic;
+    u32 version;
+    u32 config_size;        // sizeof(platform_config_t)(ビルド構成が変わったら使わない)
+    u32 config_layout;      // PlatformConfig::get_layout_hash()(項目の追加や並べ替えがあったら使わない)
+    u32 menu_size;
+    u32 valid_mask;         // 有効なソースのビット
+    BootCacheStamp stamps[BOOT_CACHE_SOURCE_COUNT];
+
+    BootCacheButton buttons[BOOT_CACHE_BUTTON_COUNT];
+    platform_config_t config;
+};
+
+/// @brief 起動時に読み込むテキスト設定を解析済みの形でSDにキャッシュする
+/// テキストファイルが正であり、サイズと更新日時が一致しない場合はキャッシュを使わない
+class PlatformBootCache {
+    private:
+        char m_path[_MAX_PATH];
+        char m_source_path[BOOT_CACHE_SOURCE_COUNT][_MAX_PATH];
+
+        BootCacheData m_data;
+        u8* m_menu_data;
+        bool m_valid[BOOT_CACHE_SOURCE_COUNT];
+        bool m_dirty;
+
+        static void get_stamp(const char* path, BootCacheStamp* stamp);
+
+    public:
+        PlatformBootCache(const char* path);
+        ~PlatformBootCache();
+
+        void set_source(BootCacheSource source, const char* path);
+
+        // キャッシュファイルを読み込み、元ファイルと一致するものを有効にする
+        bool load();
+        // 更新があればキャッシュファイルを書き込む
+        bool save();
+
+        bool is_valid(BootCacheSource source) { return m_valid[source]; }
+
+        // 元ファイルを書き換えた(キャッシュファイルも削除する)
+        void invalidate(BootCacheSource source);
+
+        bool restore_buttons(SystemConfiguration* config);
+        void store_buttons(SystemConfiguration* config);
+
+        bool restore_config(platform_config_t* config);
+        void store_config(const platform_config_t* config);
+
+        // メニューの木はPlatformMenuが決めた形のバイト列として保持する(無ければnullptr)
+        const void* restore_menu(u32* size);
+        void store_menu(const void* data, u32 size);
+};
+
+#endif
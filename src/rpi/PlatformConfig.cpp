@@ -19,6 +19,11 @@ extern platform_config_t* get_config();
 #endif
 
 #include "ConfigConverter.h"
+#include "PlatformBootCache.h"
+#include "PlatformTrace.h"
+
+#include <stddef.h>
+#include <stdlib.h>
 
 
 #ifdef USE_EXTERNAL_EMU
@@ -35,11 +40,118 @@ platform_config_t* get_config()
 }
 #endif
 
+// ネイティブ側の設定の型(設定テーブルのオフセット計算用)
+#ifdef USE_EXTERNAL_EMU
+typedef config_t native_config_t;
+#else
+typedef platform_config_t native_config_t;
+#endif
+
+#define CONFIG_FIELD_SIZE(type, field) sizeof(((type*)0)->field)
+
+// 単独の値
+#define CONFIG_VALUE(name, type, field, flags) \
+    { name, type, offsetof(platform_config_t, field), 0, 0, 0, 0, flags }
+#define CONFIG_NATIVE_VALUE(name, type, field) \
+    { name, type, offsetof(platform_config_t, field), offsetof(native_config_t, field), 0, 0, 0, CONFIG_FLAG_NATIVE }
+// 配列(ドライブごとの設定など)
+#define CONFIG_NATIVE_ARRAY(name, type, field, flags) \
+    { name, type, offsetof(platform_config_t, field), offsetof(native_config_t, field), \
+      CONFIG_FIELD_SIZE(platform_config_t, field[0]), CONFIG_FIELD_SIZE(native_config_t, field[0]), \
+      (int)(CONFIG_FIELD_SIZE(platform_config_t, field) / CONFIG_FIELD_SIZE(platform_config_t, field[0])), CONFIG_FLAG_NATIVE | (flags) }
+
+// 設定項目の定義テーブル
+// find_entryで二分探索するので、必ずキー名の昇順に並べること(static_assertで確認している)
+static constexpr ConfigEntry config_table[] = {
+    CONFIG_VALUE("auto_key_speed", CONFIG_TYPE_INT, auto_key_speed, 0),
+    CONFIG_VALUE("auto_key_turbo", CONFIG_TYPE_BOOL, auto_key_turbo, 0),
+    CONFIG_NATIVE_ARRAY("baud_high", CONFIG_TYPE_BOOL, baud_high, 0),
+    CONFIG_VALUE("benchmark_seconds", CONFIG_TYPE_INT, benchmark_seconds, 0),
+    CONFIG_NATIVE_ARRAY("correct_disk_timing", CONFIG_TYPE_BOOL, correct_disk_timing, 0),
+    // 以前のバージョンが書き出していた綴り間違いのキー(読み込みのみ)
+    CONFIG_NATIVE_ARRAY("correct_disk_timling", CONFIG_TYPE_BOOL, correct_disk_timing, CONFIG_FLAG_ALIAS),
+    CONFIG_NATIVE_ARRAY("current_floppy_disk_path", CONFIG_TYPE_STRING, current_floppy_disk_path, 0),
+    CONFIG_NATIVE_ARRAY("current_tape_path", CONFIG_TYPE_STRING, current_tape_path, 0),
+    CONFIG_NATIVE_VALUE("display_stretch", CONFIG_TYPE_INT, fullscreen_stretch_type),
+    CONFIG_VALUE("full_speed", CONFIG_TYPE_BOOL, full_speed, 0),
+    CONFIG_NATIVE_ARRAY("ignore_disk_crc", CONFIG_TYPE_BOOL, ignore_disk_crc, 0),
+#if defined(USE_KEYBOARD_TYPE)
+    CONFIG_NATIVE_VALUE("keyboard_type", CONFIG_TYPE_INT, keyboard_type),
+#endif
+#if defined(USE_MONITOR_TYPE)
+    CONFIG_NATIVE_VALUE("monitor_type", CONFIG_TYPE_INT, monitor_type),
+#endif
+    // テープは再生も録音も同じパスを使う
+    CONFIG_NATIVE_ARRAY("record_tape_path", CONFIG_TYPE_STRING, current_tape_path, CONFIG_FLAG_ALIAS),
+    CONFIG_NATIVE_VALUE("sound_frequency", CONFIG_TYPE_INT, sound_frequency),
+    CONFIG_NATIVE_VALUE("sound_latency", CONFIG_TYPE_INT, sound_latency),
+    CONFIG_NATIVE_VALUE("sound_noise_cmt", CONFIG_TYPE_BOOL, sound_noise_cmt),
+    CONFIG_NATIVE_VALUE("sound_noise_fdd", CONFIG_TYPE_BOOL, sound_noise_fdd),
+    CONFIG_NATIVE_VALUE("sound_tape_signal", CONFIG_TYPE_BOOL, sound_tape_signal),
+    CONFIG_NATIVE_VALUE("sound_tape_voice", CONFIG_TYPE_BOOL, sound_tape_voice),
+    CONFIG_NATIVE_ARRAY("wave_shaper", CONFIG_TYPE_BOOL, wave_shaper, 0),
+};
+
+#define CONFIG_TABLE_COUNT ((int)(sizeof(config_table) / sizeof(config_table[0])))
+
+static constexpr bool config_name_less(const char* a, const char* b)
+{
+    return (*a == *b) ? (*a != '\0' && config_name_less(a + 1, b + 1)) : ((unsigned char)*a < (unsigned char)*b);
+}
+
+static constexpr bool config_table_sorted(const ConfigEntry* table, int count)
+{
+    return count <= 1 || (config_name_less(table[0].name, table[1].name) && config_table_sorted(table + 1, count - 1));
+}
+
+static_assert(config_table_sorted(config_table, CONFIG_TABLE_COUNT), "config_table must be sorted by name");
+// 変更のあった項目をu64のビットで管理している
+static_assert(CONFIG_TABLE_COUNT <= 64, "config_table is too large for the dirty mask");
+
+const ConfigEntry* PlatformConfig::get_config_table(int* count)
+{
+    *count = CONFIG_TABLE_COUNT;
+    return config_table;
+}
+
+// FNV-1aで混ぜる
+static u32 hash_bytes(u32 hash, const void* data, size_t size)
+{
+    const u8* bytes = (const u8*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+u32 PlatformConfig::get_layout_hash()
+{
+    // 大きさが変わらない項目の追加(隙間に入る場合)や並べ替えも区別できるように、項目ごとに混ぜる
+    u32 hash = 2166136261u;
+    u32 size = sizeof(platform_config_t);
+    hash = hash_bytes(hash, &size, sizeof(size));
+    for (int i = 0; i < CONFIG_TABLE_COUNT; i++) {
+        const ConfigEntry* entry = &config_table[i];
+        u32 values[5] = { (u32)entry->type, entry->offset, entry->stride, (u32)entry->count, entry->flags };
+        hash = hash_bytes(hash, entry->name, strlen(entry->name) + 1);
+        hash = hash_bytes(hash, values, sizeof(values));
+    }
+    return hash;
+}
+
 PlatformConfig::PlatformConfig(const char* config_path)
+:
+    m_dirty_mask(0),
+    m_save_pending(false),
+    m_save_due_us(0),
+    m_saves_avoided(0),
+    m_boot_cache(nullptr)
 {
     strncpy(this->config_path, config_path, _MAX_PATH);
 
     memset(&m_config, 0, sizeof(platform_config_t));
+    memset(&m_saved_config, 0, sizeof(platform_config_t));
     mpConfigConverter = new ConfigConverter(&m_config, ::get_config() );
 
 }
@@ -64,153 +176,331 @@ void PlatformConfig::ConvertFromNative()
 
 void PlatformConfig::save_config()
 {
+    TRACE_SCOPE("config save");
+    m_save_pending = false;
     ConvertToNative();
+
+    // 前回SDと同期してから変更が無ければ書き込まない
+    update_dirty_mask();
+    if (m_dirty_mask == 0) {
+        m_saves_avoided++;
+        get_logger()->Write("PlatformConfig", LogNotice, "Config unchanged, skip writing (%u writes avoided)", m_saves_avoided);
+        return;
+    }
+
 #ifdef USE_EXTERNAL_EMU
     ::save_config(config_path);
+    mark_clean();
 #else
+    if (write_config_file()) {
+        mark_clean();
+    }
+#endif
+}
+
+void PlatformConfig::request_save(u64 now)
+{
+    // エミュレーター側にはすぐに反映し、SDへの書き込みだけ遅らせる
+    ConvertToNative();
+    m_save_pending = true;
+    m_save_due_us = now + CONFIG_SAVE_DELAY_US;
+}
+
+void PlatformConfig::update(u64 now)
+{
+    if (m_save_pending && now >= m_save_due_us) {
+        save_config();
+    }
+}
+
+bool PlatformConfig::is_dirty()
+{
+    update_dirty_mask();
+    return m_dirty_mask != 0;
+}
+
+#ifndef USE_EXTERNAL_EMU
+// iniの内容をメモリ上で作り、一時ファイルに1回で書き込んでからリネームする
+bool PlatformConfig::write_config_file()
+{
 	char tmp_path[_MAX_PATH];
     // config_pathの拡張子に$$$を追加したパスを作成 
     strncpy(tmp_path, config_path, _MAX_PATH);
     strncat(tmp_path, ".$$$", _MAX_PATH);
 
+    // 書き出す内容の最大サイズを求める
+    int buffer_size = 1;
+    for (int i = 0; i < CONFIG_TABLE_COUNT; i++) {
+        const ConfigEntry* entry = &config_table[i];
+        if (entry->flags & CONFIG_FLAG_ALIAS) {
+            continue;
+        }
+        int count = entry->count > 0 ? entry->count : 1;
+        int value_size = (entry->type == CONFIG_TYPE_STRING) ? entry->stride : 12;
+        buffer_size += count * (strlen(entry->name) + 8 + value_size);
+    }
+
+    char* buffer = (char*)malloc(buffer_size);
+    if (!buffer) {
+        get_logger()->Write("PlatformConfig", LogError, "Failed to allocate %d bytes", buffer_size);
+        return false;
+    }
+
     char key[128];
+    int length = 0;
 
-    // ファイルを作成
-    FILE* fp = fopen(tmp_path, "w");
-    if (fp) {
-        config_write_bool(fp, "sound_noise_fdd", m_config.sound_noise_fdd);
-        config_write_bool(fp, "sound_noise_cmt", m_config.sound_noise_cmt);
-        config_write_bool(fp, "sound_tape_signal", m_config.sound_tape_signal);
-        config_write_bool(fp, "sound_tape_voice", m_config.sound_tape_voice);
-        config_write_int(fp, "sound_frequency", m_config.sound_frequency);
-        config_write_int(fp, "sound_latency", m_config.sound_latency);
-        
-        for (int i = 0; i < USE_FLOPPY_DISK; i++) {
-            snprintf(key, sizeof(key), "correct_disk_timling[%d]", i);
-            config_write_bool(fp, key, m_config.correct_disk_timing[i]);
-            snprintf(key, sizeof(key), "ignore_disk_crc[%d]", i);
-            config_write_bool(fp, key, m_config.ignore_disk_crc[i]);
-            snprintf(key, sizeof(key), "current_floppy_disk_path[%d]", i);
-            config_write_string(fp, key, m_config.current_floppy_disk_path[i]);
-        }
-        
-        for (int i = 0; i < USE_TAPE; i++) {
-            snprintf(key, sizeof(key), "wave_shaper[%d]", i);
-            config_write_bool(fp, key, m_config.wave_shaper[i]);
-            snprintf(key, sizeof(key), "baud_high[%d]", i);
-            config_write_bool(fp, key, m_config.baud_high[i]);
-            snprintf(key, sizeof(key), "current_tape_path[%d]", i);
-            config_write_string(fp, key, m_config.current_tape_path[i]);
+    // テーブルの順に書き出す(別名は書き出さない)
+    for (int i = 0; i < CONFIG_TABLE_COUNT; i++) {
+        const ConfigEntry* entry = &config_table[i];
+        if (entry->flags & CONFIG_FLAG_ALIAS) {
+            continue;
         }
 
-        config_write_int(fp, "monitor_type", m_config.monitor_type);
-        config_write_int(fp, "keyboard_type", m_config.keyboard_type);
-        config_write_bool(fp, "full_speed", m_config.full_speed);
+        int count = entry->count > 0 ? entry->count : 1;
+        for (int index = 0; index < count; index++) {
+            if (entry->count > 0) {
+                snprintf(key, sizeof(key), "%s[%d]", entry->name, index);
+            } else {
+                snprintf(key, sizeof(key), "%s", entry->name);
+            }
 
-        fclose(fp);
+            void* value = get_value_ptr(&m_config, entry, index);
+            char* p = buffer + length;
+            int rest = buffer_size - length;
+            switch (entry->type) {
+                case CONFIG_TYPE_BOOL:
+                    length += config_write_bool(p, rest, key, *(bool*)value);
+                    break;
+                case CONFIG_TYPE_INT:
+                    length += config_write_int(p, rest, key, *(int*)value);
+                    break;
+                case CONFIG_TYPE_STRING:
+                    length += config_write_string(p, rest, key, (const char*)value);
+                    break;
+            }
+        }
+    }
+
+    bool result = false;
+    FILE* fp = fopen(tmp_path, "w");
+    if (fp) {
+        result = fwrite(buffer, 1, length, fp) == (size_t)length;
+        result = (fclose(fp) == 0) && result;
 
         // 削除して$$$をリネームする
-        remove(config_path);
-        rename(tmp_path, config_path);
+        if (result) {
+            remove(config_path);
+            rename(tmp_path, config_path);
+
+            // 解析済みのキャッシュは古くなる
+            if (m_boot_cache) {
+                m_boot_cache->invalidate(BOOT_CACHE_SOURCE_INI);
+            }
+        }
     }
-#endif
+    free(buffer);
+
+    if (!result) {
+        get_logger()->Write("PlatformConfig", LogError, "Failed to write %s", tmp_path);
+    }
+    return result;
 }
+#endif
 
 void PlatformConfig::load_config()
 {
+    // 保存待ちの変更があれば先に書き込む(読み込みで消えないように)
+    if (m_save_pending) {
+        save_config();
+    }
+
 #ifdef USE_EXTERNAL_EMU
     ::load_config(config_path);
+    ConvertFromNative();
+    mark_clean();
 #else
+    // iniが前回解析した時から変わっていなければキャッシュを使う
+    if (m_boot_cache && m_boot_cache->restore_config(&m_config)) {
+        ConvertToNative();
+        mark_clean();
+        return;
+    }
+
     // ファイルを読み込む
     FILE* fp = fopen(config_path, "r");
     if (fp) {
-        char line[_MAX_PATH];
+        char line[_MAX_PATH + 64];
         while (fgets(line, sizeof(line), fp)) {
             char* key;
             char* value;
-            int int_value;
             split_equal(line, &key, &value);
-
-            // とりあえず雑にintに変換してみる
-            if(value != nullptr && *value != '\0') {
-                int_value = atoi(value);
+            if (value == nullptr) {
+                continue;
             }
 
-            // Keyを認識するのがどれか1つなので、どれか当たるだろうという雑な実装
-            apply_config_bool(key, value);
-            apply_config_int(key, int_value);
-            apply_config_string(key, value);
+            // 1行につきテーブルを1回引くだけで済ませる
+            int index;
+            const ConfigEntry* entry = find_entry(key, &index);
+            void* target = entry ? get_value_ptr(&m_config, entry, index) : nullptr;
+            if (!target) {
+                continue;
+            }
+            switch (entry->type) {
+                case CONFIG_TYPE_BOOL:
+                    *(bool*)target = atoi(value) != 0;
+                    break;
+                case CONFIG_TYPE_INT:
+                    *(int*)target = atoi(value);
+                    break;
+                case CONFIG_TYPE_STRING:
+                    strncpy((char*)target, value, entry->stride - 1);
+                    ((char*)target)[entry->stride - 1] = '\0';
+                    break;
+            }
         }
 
         fclose(fp);
     }
+
+    // iniの内容をネイティブ側にも反映する
+    ConvertToNative();
+    mark_clean();
+
+    if (m_boot_cache) {
+        m_boot_cache->store_config(&m_config);
+    }
 #endif
-    ConvertFromNative();
 }
 
 
-void PlatformConfig::config_write_bool(FILE* fp, const char* key, bool value)
+int PlatformConfig::config_write_bool(char* buffer, int size, const char* key, bool value)
 {
-    fprintf(fp, "%s=%d\n", key, value ? 1 : 0);
+    return config_write_int(buffer, size, key, value ? 1 : 0);
 }
 
-
-void PlatformConfig::config_write_int(FILE* fp, const char* key, int value)
+int PlatformConfig::config_write_int(char* buffer, int size, const char* key, int value)
 {
-    fprintf(fp, "%s=%d\n", key, value);
+    int length = snprintf(buffer, size, "%s=%d\n", key, value);
+    return length < size ? length : size - 1;
 }
 
-void PlatformConfig::config_write_string(FILE* fp, const char* key, const char* value)
+int PlatformConfig::config_write_string(char* buffer, int size, const char* key, const char* value)
 {
-    fprintf(fp, "%s=%s\n", key, value);
+    int length = snprintf(buffer, size, "%s=%s\n", key, value);
+    return length < size ? length : size - 1;
 }
 
 void PlatformConfig::split_equal(const char* line, char** key, char** value)
 {
-    static char buffer[_MAX_PATH];
-    strncpy(buffer, line, _MAX_PATH);
+    static char buffer[_MAX_PATH + 64];
+    strncpy(buffer, line, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+
+    // 行末の改行を取り除く
+    buffer[strcspn(buffer, "\r\n")] = '\0';
+
     char* equal = strchr(buffer, '=');
+    *key = buffer;
     if (equal) {
         *equal = '\0';
+        *value = equal + 1;
+    } else {
+        *value = nullptr;
     }
-    *key = buffer;
-    *value = equal + 1;
 }
 
-bool PlatformConfig::get_config_bool(const char* config_name)
+const ConfigEntry* PlatformConfig::find_entry(const char* config_name, int* index)
 {
-    int index = -1;
-    char* bracket = strchr(config_name, '[');
-    if (bracket) {
-        index = atoi(bracket + 1);
-    }
+    // [n]の前までがキー名
+    const char* bracket = strchr(config_name, '[');
+    size_t length = bracket ? (size_t)(bracket - config_name) : strlen(config_name);
+    *index = bracket ? atoi(bracket + 1) : -1;
+
+    int low = 0;
+    int high = CONFIG_TABLE_COUNT - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        const char* name = config_table[mid].name;
+        int cmp = strncmp(config_name, name, length);
+        if (cmp == 0 && name[length] != '\0') {
+            // config_nameの方が短い
+            cmp = -1;
+        }
 
-    if(strcmp(config_name, "sound_noise_fdd") == 0) {
-        return m_config.sound_noise_fdd;
-    }
-    else if(strcmp(config_name, "sound_noise_cmt") == 0) {
-        return m_config.sound_noise_cmt;
-    }
-    else if(strcmp(config_name, "sound_tape_signal") == 0) {
-        return m_config.sound_tape_signal;
-    }
-    else if(strcmp(config_name, "sound_tape_voice") == 0) {
-        return m_config.sound_tape_voice;
+        if (cmp == 0) {
+            return &config_table[mid];
+        } else if (cmp < 0) {
+            high = mid - 1;
+        } else {
+            low = mid + 1;
+        }
     }
-    else if(strncmp(config_name, "correct_disk_timing[", 20) == 0 && index >= 0) {
-        return m_config.correct_disk_timing[index];
+    return nullptr;
+}
+
+void* PlatformConfig::get_value_ptr(platform_config_t* config, const ConfigEntry* entry, int index)
+{
+    u8* base = (u8*)config + entry->offset;
+    if (entry->count == 0) {
+        return base;
     }
-    else if(strncmp(config_name, "ignore_disk_crc[", 16) == 0 && index >= 0) {
-        return m_config.ignore_disk_crc[index];
+    if (index < 0 || index >= entry->count) {
+        return nullptr;
     }
-    else if(strncmp(config_name, "wave_shaper[", 12) == 0 && index >= 0) {
-        return m_config.wave_shaper[index];
+    return base + entry->stride * index;
+}
+
+// SDと同期した内容と比べて変更された項目を求める
+// (EmuControllerがm_configを直接書き換える項目もあるため、比較で求める。元の値に戻した項目は変更無しになる)
+void PlatformConfig::update_dirty_mask()
+{
+    m_dirty_mask = 0;
+    for (int i = 0; i < CONFIG_TABLE_COUNT; i++) {
+        const ConfigEntry* entry = &config_table[i];
+        if (entry->flags & CONFIG_FLAG_ALIAS) {
+            continue;
+        }
+
+        int count = entry->count > 0 ? entry->count : 1;
+        for (int index = 0; index < count; index++) {
+            const void* current = get_value_ptr(&m_config, entry, index);
+            const void* saved = get_value_ptr(&m_saved_config, entry, index);
+            bool changed;
+            switch (entry->type) {
+                case CONFIG_TYPE_BOOL:
+                    changed = *(const bool*)current != *(const bool*)saved;
+                    break;
+                case CONFIG_TYPE_INT:
+                    changed = *(const int*)current != *(const int*)saved;
+                    break;
+                default:
+                    changed = strncmp((const char*)current, (const char*)saved, entry->stride) != 0;
+                    break;
+            }
+            if (changed) {
+                m_dirty_mask |= (u64)1 << i;
+                break;
+            }
+        }
     }
-    else if(strncmp(config_name, "baud_high[", 10) == 0 && index >= 0) {
-        return m_config.baud_high[index];
+}
+
+void PlatformConfig::mark_clean()
+{
+    memcpy(&m_saved_config, &m_config, sizeof(platform_config_t));
+    m_dirty_mask = 0;
+}
+
+bool PlatformConfig::get_config_bool(const char* config_name)
+{
+    int index;
+    const ConfigEntry* entry = find_entry(config_name, &index);
+    if (!entry || entry->type != CONFIG_TYPE_BOOL) {
+        return false; // デフォルト値
     }
 
-    return false; // デフォルト値
+    bool* value = (bool*)get_value_ptr(&m_config, entry, index);
+    return value ? *value : false;
 }
 
 int PlatformConfig::get_config_int(const char* config_name, int* config_value, bool* is_same)
@@ -219,149 +509,88 @@ int PlatformConfig::get_config_int(const char* config_name, int* config_value, b
     *config_value = 0;
     *is_same = false;
 
-    // config_nameの末尾に [(数字)] というのがあれば、その数字を事前に取得しておく
-    int index = -1;
-    char* bracket = strchr(config_name, '[');
-    if (bracket) {
-        index = atoi(bracket + 1);
+    // config_nameの末尾に [(数字)] というのがあれば、その数字がメニューで選択される値になる
+    int index;
+    const ConfigEntry* entry = find_entry(config_name, &index);
+    if (index >= 0) {
         *config_value = index;
     }
+    if (!entry) {
+        return 0;
+    }
 
-    extern CLogger* get_logger();
-    get_logger()->Write("PlatformMenu", LogNotice, "get_config_int: %s, index: %d", config_name, index);
+    void* value = get_value_ptr(&m_config, entry, index);
+    if (!value) {
+        return 0;
+    }
 
-    if(strncmp(config_name, "monitor_type[", 13) == 0 && index >= 0) {
-        int result = 0;
-#if defined(USE_MONITOR_TYPE)
-        result = m_config.monitor_type;
-        get_logger()->Write("PlatformMenu", LogNotice, "get_config_int: %s, index: %d, result: %d", config_name, index, result);
-        if (is_same) {
-            *is_same = index == result;
-        }
-#endif
-        return result;
-    } else if(strncmp(config_name, "keyboard_type[", 14) == 0 && index >= 0) {
-        int result = 0;
-#if defined(USE_KEYBOARD_TYPE)
-        result = m_config.keyboard_type;
-        get_logger()->Write("PlatformMenu", LogNotice, "get_config_int: %s, index: %d, result: %d", config_name, index, result);
-        if (is_same) {
-            *is_same = index == result;
-        }
-#endif
-        return result;
-    }
-    else if(strncmp(config_name, "full_speed", 10) == 0) {
-        int result = 0;
-        result = m_config.full_speed;
-        get_logger()->Write("PlatformMenu", LogNotice, "get_config_int: %s, index: %d, result: %d", config_name, index, result);
-        return result;
-    }
-    else if(strncmp(config_name, "display_stretch[", 16) == 0 && index >= 0) {
-        int result = 0;
-        result = m_config.fullscreen_stretch_type;
-        get_logger()->Write("PlatformMenu", LogNotice, "get_config_int: %s, index: %d, result: %d", config_name, index, result);
-        if (is_same) {
-            *is_same = index == result;
-        }
-        return result;
+    int result = 0;
+    if (entry->type == CONFIG_TYPE_INT) {
+        result = *(int*)value;
+    } else if (entry->type == CONFIG_TYPE_BOOL) {
+        result = *(bool*)value ? 1 : 0;
+    } else {
+        return 0;
+    }
+
+    // 配列でない値の[n]はint_selectの選択肢
+    if (entry->count == 0 && index >= 0) {
+        *is_same = index == result;
     }
-    return 0;
+    return result;
 }
 
 const char* PlatformConfig::get_config_string(const char* config_name)
 {
-    // config_nameの末尾に [(数字)] というのがあれば、その数字を事前に取得しておく
-    int index = -1;
-    char* bracket = strchr(config_name, '[');
-    if (bracket) {
-        index = atoi(bracket + 1);
+    int index;
+    const ConfigEntry* entry = find_entry(config_name, &index);
+    if (!entry || entry->type != CONFIG_TYPE_STRING) {
+        return ""; // デフォルト値
     }
-    
-    if(strncmp(config_name, "current_floppy_disk_path[", 25) == 0 && index >= 0) {
 
-        get_logger()->Write("PlatformMenu", LogNotice, "fetch : current_floppy_disk_path[%d] = %s / config = %s", index, m_config.current_floppy_disk_path[index], m_config.current_floppy_disk_path[index]);
-        return m_config.current_floppy_disk_path[index];
-    }
-    else if(strncmp(config_name, "current_tape_path[", 18) == 0 && index >= 0) {
-        return m_config.current_tape_path[index];
-    }
-    else if(strncmp(config_name, "record_tape_path[", 17) == 0 && index >= 0) {
-        // テープは再生も録音も同じパスを返す(手抜き)
-        return m_config.current_tape_path[index];
-    }
-    return ""; // デフォルト値
+    const char* value = (const char*)get_value_ptr(&m_config, entry, index);
+    return value ? value : "";
 }
 
 void PlatformConfig::apply_config_bool(const char* config_name, bool value)
 {
-    int index = -1;
-    char* bracket = strchr(config_name, '[');
-    if (bracket) {
-        index = atoi(bracket + 1);
+    int index;
+    const ConfigEntry* entry = find_entry(config_name, &index);
+    if (!entry || entry->type != CONFIG_TYPE_BOOL) {
+        return;
     }
 
-    if(strcmp(config_name, "sound_noise_fdd") == 0) {
-        m_config.sound_noise_fdd = value;
-    }
-    else if(strcmp(config_name, "sound_noise_cmt") == 0) {
-        m_config.sound_noise_cmt = value;
-    }
-    else if(strcmp(config_name, "sound_tape_signal") == 0) {
-        m_config.sound_tape_signal = value;
-    }
-    else if(strcmp(config_name, "sound_tape_voice") == 0) {
-        m_config.sound_tape_voice = value;
-    }
-    else if(strncmp(config_name, "correct_disk_timing[", 20) == 0 && index >= 0) {
-        m_config.correct_disk_timing[index] = value;
-    }
-    else if(strncmp(config_name, "ignore_disk_crc[", 16) == 0 && index >= 0) {
-        m_config.ignore_disk_crc[index] = value;
-    }
-    else if(strncmp(config_name, "wave_shaper[", 12) == 0 && index >= 0) {
-        m_config.wave_shaper[index] = value;
-    }
-    else if(strncmp(config_name, "baud_high[", 10) == 0 && index >= 0) {
-        m_config.baud_high[index] = value;
-    }
-    else if(strncmp(config_name, "full_speed", 10) == 0) {
-        m_config.full_speed = value;
+    bool* target = (bool*)get_value_ptr(&m_config, entry, index);
+    if (target && *target != value) {
+        *target = value;
     }
 }
 
 void PlatformConfig::apply_config_int(const char* config_name, int value)
 {
-    if(strncmp(config_name, "keyboard_type", 13) == 0) {
-#if defined(USE_KEYBOARD_TYPE)  
-        m_config.keyboard_type = value;
-#endif
-    }
-    else if(strncmp(config_name, "monitor_type", 12) == 0) {
-        m_config.monitor_type = value;
+    int index;
+    const ConfigEntry* entry = find_entry(config_name, &index);
+    if (!entry || entry->type != CONFIG_TYPE_INT) {
+        return;
     }
-    else if(strncmp(config_name, "display_stretch", 15) == 0) {
-        m_config.fullscreen_stretch_type = value;
+
+    int* target = (int*)get_value_ptr(&m_config, entry, index);
+    if (target && *target != value) {
+        *target = value;
     }
 }
 
 void PlatformConfig::apply_config_string(const char* config_name, const char* value)
 {
-    // config_nameの末尾に [(数字)] というのがあれば、その数字を事前に取得しておく
-    int index = -1;
-    char* bracket = strchr(config_name, '[');
-    if (bracket) {
-        index = atoi(bracket + 1);
+    int index;
+    const ConfigEntry* entry = find_entry(config_name, &index);
+    if (!entry || entry->type != CONFIG_TYPE_STRING) {
+        return;
     }
 
-    if(strncmp(config_name, "current_floppy_disk_path[", 25) == 0 && index >= 0) {
-        strncpy(m_config.current_floppy_disk_path[index], value, _MAX_PATH);
-    }
-    else if(strncmp(config_name, "current_tape_path[", 18) == 0 && index >= 0) {
-        strncpy(m_config.current_tape_path[index], value, _MAX_PATH);
+    char* target = (char*)get_value_ptr(&m_config, entry, index);
+    if (target && strncmp(target, value, entry->stride - 1) != 0) {
+        strncpy(target, value, entry->stride - 1);
+        target[entry->stride - 1] = '\0';
     }
-    else if(strncmp(config_name, "record_tape_path[", 17) == 0 && index >= 0) {
-        // 録音パスは再生パスと同じなので注意
-        strncpy(m_config.current_tape_path[index], value, _MAX_PATH);
-    }
-}
\ No newline at end of file
+}
@@ -6,6 +6,7 @@
 #ifndef _PLATFORM_CONFIG_H_
 #define _PLATFORM_CONFIG_H_
 
+#include <circle/types.h>
 #include <stdbool.h>
 #include <stdio.h>
 
@@ -39,6 +40,11 @@ struct platform_config_t {
     int fullscreen_stretch_type;  // フルスクリーンストレッチタイプ
 
     bool full_speed;         // フルスピード
+    int benchmark_seconds;   // 起動時に実行するベンチマークの秒数(0なら実行しない)
+
+    // 自動キー入力関連設定
+    int auto_key_speed;       // 入力速度(AUTO_KEY_SPEED_*)
+    bool auto_key_turbo;      // 入力中はフレームスキップで高速実行する
 };
 
 #ifdef USE_EXTERNAL_EMU
@@ -48,20 +54,78 @@ extern platform_config_t* get_config();
 #endif
 
 class ConfigConverter;
+class PlatformBootCache;
+
+// 保存要求からSDに書き込むまでの待ち時間(マイクロ秒)
+// この間の保存要求はまとめて1回の書き込みにする
+#define CONFIG_SAVE_DELAY_US 2000000
+
+// 設定項目の型
+enum ConfigValueType {
+    CONFIG_TYPE_BOOL,
+    CONFIG_TYPE_INT,
+    CONFIG_TYPE_STRING
+};
+
+// 設定項目のフラグ
+#define CONFIG_FLAG_NATIVE  0x01    // ネイティブ側の設定(config_t)と相互に変換する
+#define CONFIG_FLAG_ALIAS   0x02    // 別名(読み込み・メニューからは参照できるが保存しない)
+
+// 設定項目の定義(platform_config_tのどこに何があるか)
+// 配列(count > 0)の場合、キー名の [n] は要素番号を表す
+// 配列でないintの場合、キー名の [n] はメニューで選択される値を表す(int_select)
+struct ConfigEntry {
+    const char* name;           // iniのキー名([n]を除いた部分)
+    ConfigValueType type;
+    u32 offset;                 // platform_config_t内のオフセット
+    u32 native_offset;          // ネイティブ側の設定内のオフセット(CONFIG_FLAG_NATIVEの場合のみ有効)
+    u32 stride;                 // 配列の要素サイズ
+    u32 native_stride;
+    int count;                  // 配列の要素数(配列でなければ0)
+    u32 flags;
+};
 
 class PlatformConfig {
     private:
         ConfigConverter* mpConfigConverter;
 
-        void config_write_bool(FILE* fp, const char* key, bool value);
-        void config_write_int(FILE* fp, const char* key, int value);
-        void config_write_string(FILE* fp, const char* key, const char* value);
+        // bufferに1行書き込み、書き込んだ文字数を返す
+        int config_write_bool(char* buffer, int size, const char* key, bool value);
+        int config_write_int(char* buffer, int size, const char* key, int value);
+        int config_write_string(char* buffer, int size, const char* key, const char* value);
 
         void split_equal(const char* line, char** key, char** value);
 
+        // キー名から設定項目を引き、[n]の数値をindexに返す(無ければ-1)
+        const ConfigEntry* find_entry(const char* config_name, int* index);
+        static void* get_value_ptr(platform_config_t* config, const ConfigEntry* entry, int index);
+
         char config_path[_MAX_PATH];
         platform_config_t m_config;
+
+        // 最後にSDと同期した内容と、変更された項目(テーブルのインデックスのビット)
+        platform_config_t m_saved_config;
+        u64 m_dirty_mask;
+
+        // 保存の遅延
+        bool m_save_pending;
+        u64 m_save_due_us;
+
+        // 変更が無いため書き込まなかった回数
+        u32 m_saves_avoided;
+
+        // 解析済みの設定のキャッシュ(無ければnullptr)
+        PlatformBootCache* m_boot_cache;
+
+        void update_dirty_mask();
+        void mark_clean();
+        bool write_config_file();
     public:
+        // 設定項目の定義テーブル(キー名でソート済み)
+        static const ConfigEntry* get_config_table(int* count);
+        // 設定項目の名前、型、オフセットなどのハッシュ(キャッシュした設定と構造が同じかの確認用)
+        static u32 get_layout_hash();
+
         PlatformConfig(const char* config_path);
         ~PlatformConfig();
 
@@ -72,9 +136,21 @@ class PlatformConfig {
         void ConvertToNative();
         void ConvertFromNative();
 
+        // 変更があればすぐに保存する
         void save_config();
         void load_config();
 
+        // 保存を予約し、CONFIG_SAVE_DELAY_US後のupdateで書き込む
+        void request_save(u64 now);
+        void update(u64 now);
+
+        bool is_dirty();
+
+        // iniが変わっていなければ解析せずにキャッシュから読み込む
+        void set_boot_cache(PlatformBootCache* boot_cache) { m_boot_cache = boot_cache; }
+        PlatformBootCache* get_boot_cache() { return m_boot_cache; }
+        u32 get_saves_avoided() { return m_saves_avoided; }
+
         bool get_config_bool(const char* config_name);
         int get_config_int(const char* config_name, int* config_value, bool* is_same);
         const char* get_config_string(const char* config_name);
@@ -0,0 +1,83 @@
+#include "PlatformDeferredLog.h"
+#include "PlatformLog.h"
+
+#include <circle/timer.h>
+#include <stdio.h>
+#include <string.h>
+
+// 整形後の1行の最大長
+#define DEFERRED_LOG_LINE_SIZE 256
+
+static PlatformDeferredLog s_deferred_log;
+
+PlatformDeferredLog* get_deferred_log()
+{
+    return &s_deferred_log;
+}
+
+PlatformDeferredLog::PlatformDeferredLog()
+:
+    m_overflow_reported(0)
+{
+}
+
+// 呼び出し元の文字列は出力までに変わる可能性があるのでコピーしておく
+void PlatformDeferredLog::store(DeferredLogRecord* record, int index, const char* value)
+{
+    if (!value) {
+        value = "(null)";
+    }
+    int space = DEFERRED_LOG_TEXT_SIZE - record->text_used;
+    if (space <= 1) {
+        record->args[index] = (uintptr_t)"...";
+        return;
+    }
+    char* dst = record->text + record->text_used;
+    int length = strlen(value);
+    if (length > space - 1) {
+        length = space - 1;
+    }
+    memcpy(dst, value, length);
+    dst[length] = '\0';
+    // recordはキューにコピーされるので、アドレスではなく位置を覚えておく
+    record->args[index] = record->text_used;
+    record->string_mask |= 1 << index;
+    record->text_used += length + 1;
+}
+
+void PlatformDeferredLog::write_record(const DeferredLogRecord* record)
+{
+    // 引数は全て1ワードにしてあるので、使われない分も含めて常に最大数を渡す
+    char line[DEFERRED_LOG_LINE_SIZE];
+    uintptr_t a[DEFERRED_LOG_MAX_ARGS];
+    for (int i = 0; i < DEFERRED_LOG_MAX_ARGS; i++) {
+        a[i] = (record->string_mask & (1 << i)) ? (uintptr_t)(record->text + record->args[i]) : record->args[i];
+    }
+    snprintf(line, sizeof(line), record->format, a[0], a[1], a[2], a[3], a[4], a[5]);
+    get_logger()->Write(record->source, (TLogSeverity)record->severity, "%s", line);
+}
+
+void PlatformDeferredLog::flush(u64 deadline_us)
+{
+    u32 overflow = m_queue.get_overflow_count();
+    if (overflow != m_overflow_reported) {
+        get_logger()->Write("DeferredLog", LogWarning, "%u log lines dropped", overflow - m_overflow_reported);
+        m_overflow_reported = overflow;
+    }
+
+    DeferredLogRecord record;
+    while (CTimer::GetClockTicks64() < deadline_us && m_queue.pop(&record)) {
+        write_record(&record);
+    }
+}
+
+void PlatformDeferredLog::flush_if_crowded()
+{
+    if (m_queue.size() < DEFERRED_LOG_QUEUE_SIZE / 2) {
+        return;
+    }
+    DeferredLogRecord record;
+    for (int i = 0; i < DEFERRED_LOG_FORCED_FLUSH && m_queue.pop(&record); i++) {
+        write_record(&record);
+    }
+}
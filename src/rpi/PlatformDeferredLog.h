@@ -0,0 +1,103 @@
+#ifndef _PLATFORM_DEFERRED_LOG_H_
+#define _PLATFORM_DEFERRED_LOG_H_
+
+#include <circle/types.h>
+#include <circle/logger.h>
+#include <stdint.h>
+
+#include "PlatformSPSCQueue.h"
+
+// 溜めておけるログの数(2のべき乗)
+#define DEFERRED_LOG_QUEUE_SIZE 128
+// 1件あたりの引数の最大数
+#define DEFERRED_LOG_MAX_ARGS 6
+// 1件あたりの文字列引数(%s)のコピー先の大きさ
+#define DEFERRED_LOG_TEXT_SIZE 64
+// 空き時間が無い場合でも、半分以上溜まっていればループごとに出力する件数
+#define DEFERRED_LOG_FORCED_FLUSH 2
+
+// この重要度より低いログはコンパイル時に取り除かれる
+#ifndef DEFERRED_LOG_LEVEL
+#define DEFERRED_LOG_LEVEL LogNotice
+#endif
+
+// コンポーネントごとの有効/無効(-DDEFERRED_LOG_EMU=0 などで取り除ける)
+#ifndef DEFERRED_LOG_EMU
+#define DEFERRED_LOG_EMU 1
+#endif
+#ifndef DEFERRED_LOG_FRAMESKIP
+#define DEFERRED_LOG_FRAMESKIP 1
+#endif
+
+// 書式と引数をそのまま保持する
+// 文字列引数はtextにコピーし、argsにはtext内の位置を入れる(string_maskのビットが立つ)
+struct DeferredLogRecord {
+    const char* source;
+    const char* format;
+    u8 severity;
+    u8 text_used;
+    u8 string_mask;
+    uintptr_t args[DEFERRED_LOG_MAX_ARGS];
+    char text[DEFERRED_LOG_TEXT_SIZE];
+};
+
+/// @brief ログの整形とシリアルへの出力を空き時間まで遅らせる
+/// 書式は文字列リテラル、引数は32ビット以下の整数・ポインタ・文字列のみ(浮動小数点は不可)
+/// 記録はメインループからのみ行う事(割り込みハンドラからは使えない)
+class PlatformDeferredLog {
+    private:
+        PlatformSPSCQueue<DeferredLogRecord, DEFERRED_LOG_QUEUE_SIZE> m_queue;
+        u32 m_overflow_reported;
+
+        static void store(DeferredLogRecord* record, int index, const char* value);
+        static void store(DeferredLogRecord* record, int index, char* value) { store(record, index, (const char*)value); }
+        static void store(DeferredLogRecord* record, int index, double value) = delete;
+        template <typename T>
+        static void store(DeferredLogRecord* record, int index, T value) { record->args[index] = (uintptr_t)value; }
+
+        static void store_args(DeferredLogRecord* record, int index) {}
+        template <typename T, typename... Rest>
+        static void store_args(DeferredLogRecord* record, int index, T value, Rest... rest)
+        {
+            store(record, index, value);
+            store_args(record, index + 1, rest...);
+        }
+
+        void write_record(const DeferredLogRecord* record);
+
+    public:
+        PlatformDeferredLog();
+
+        template <typename... Args>
+        void write(const char* source, TLogSeverity severity, const char* format, Args... args)
+        {
+            static_assert(sizeof...(Args) <= DEFERRED_LOG_MAX_ARGS, "too many log arguments");
+            DeferredLogRecord record;
+            record.source = source;
+            record.format = format;
+            record.severity = (u8)severity;
+            record.text_used = 0;
+            record.string_mask = 0;
+            store_args(&record, 0, args...);
+            m_queue.push(record);
+        }
+
+        // deadline_us(CTimer::GetClockTicks64の値)を過ぎるか空になるまで出力する
+        void flush(u64 deadline_us);
+        // 空き時間が無くても溜まりすぎないように少しだけ出力する
+        void flush_if_crowded();
+
+        u32 get_pending() { return m_queue.size(); }
+};
+
+extern PlatformDeferredLog* get_deferred_log();
+
+// componentはDEFERRED_LOG_<component>が定義されている名前(出力時のソース名になる)
+#define DEFERRED_LOG(component, severity, ...) \
+    do { \
+        if (DEFERRED_LOG_##component && (severity) <= DEFERRED_LOG_LEVEL) { \
+            get_deferred_log()->write(#component, severity, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#endif
@@ -0,0 +1,363 @@
+#include "PlatformDirIndex.h"
+#include "PlatformLog.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+// 最初に確保するエントリ数と名前の領域
+#define DIR_INDEX_INITIAL_ENTRIES 64
+#define DIR_INDEX_INITIAL_NAMES   2048
+
+// qsortの比較関数から名前を引くためのプール(ソート中のみ有効)
+static const char* s_sort_names = nullptr;
+
+static int compare_entry(const void* a, const void* b)
+{
+    const DirIndexEntry* ea = (const DirIndexEntry*)a;
+    const DirIndexEntry* eb = (const DirIndexEntry*)b;
+
+    // ディレクトリが先
+    bool dir_a = (ea->attrib & AM_DIR) != 0;
+    bool dir_b = (eb->attrib & AM_DIR) != 0;
+    if (dir_a != dir_b) {
+        return dir_a ? -1 : 1;
+    }
+    return strcasecmp(s_sort_names + ea->name, s_sort_names + eb->name);
+}
+
+PlatformDirIndex::PlatformDirIndex()
+:
+    m_entries(nullptr),
+    m_count(0),
+    m_capacity(0),
+    m_names(nullptr),
+    m_names_size(0),
+    m_names_capacity(0),
+    m_valid(false),
+    m_last_used(0),
+    m_scanning(false)
+{
+    m_path[0] = '\0';
+}
+
+PlatformDirIndex::~PlatformDirIndex()
+{
+    clear();
+    free(m_entries);
+    free(m_names);
+}
+
+void PlatformDirIndex::clear()
+{
+    if (m_scanning) {
+        f_closedir(&m_dir);
+        m_scanning = false;
+    }
+
+    // 領域は次に使う時のために残しておく
+    m_path[0] = '\0';
+    m_count = 0;
+    m_names_size = 0;
+    m_valid = false;
+}
+
+void PlatformDirIndex::begin(const char* path)
+{
+    clear();
+    strncpy(m_path, path, sizeof(m_path) - 1);
+    m_path[sizeof(m_path) - 1] = '\0';
+}
+
+bool PlatformDirIndex::add_entry(const FILINFO* info)
+{
+    // ドットで始まるファイルはスキップ（隠しファイル）
+    if (info->fname[0] == '.') {
+        return true;
+    }
+
+    if (m_count >= m_capacity) {
+        int capacity = m_capacity ? m_capacity * 2 : DIR_INDEX_INITIAL_ENTRIES;
+        DirIndexEntry* entries = (DirIndexEntry*)realloc(m_entries, capacity * sizeof(DirIndexEntry));
+        if (!entries) {
+            return false;
+        }
+        m_entries = entries;
+        m_capacity = capacity;
+    }
+
+    u32 length = strlen(info->fname) + 1;
+    if (m_names_size + length > m_names_capacity) {
+        u32 capacity = m_names_capacity ? m_names_capacity * 2 : DIR_INDEX_INITIAL_NAMES;
+        while (m_names_size + length > capacity) {
+            capacity *= 2;
+        }
+        char* names = (char*)realloc(m_names, capacity);
+        if (!names) {
+            return false;
+        }
+        m_names = names;
+        m_names_capacity = capacity;
+    }
+
+    DirIndexEntry* entry = &m_entries[m_count++];
+    entry->name = m_names_size;
+    entry->size = (u32)info->fsize;
+    entry->attrib = info->fattrib;
+    memcpy(m_names + m_names_size, info->fname, length);
+    m_names_size += length;
+    return true;
+}
+
+void PlatformDirIndex::finish()
+{
+    if (m_count > 1) {
+        s_sort_names = m_names;
+        qsort(m_entries, m_count, sizeof(DirIndexEntry), compare_entry);
+        s_sort_names = nullptr;
+    }
+    m_valid = true;
+}
+
+bool PlatformDirIndex::start_scan(const char* path)
+{
+    begin(path);
+
+    FRESULT fr = f_opendir(&m_dir, path);
+    if (fr != FR_OK) {
+        get_logger()->Write("DirIndex", LogError, "directory opening failed: %s, error code %d", path, (int)fr);
+        clear();
+        return false;
+    }
+    m_scanning = true;
+    return true;
+}
+
+DirScanResult PlatformDirIndex::scan(int max_entries)
+{
+    if (!m_scanning) {
+        return m_valid ? DIR_SCAN_DONE : DIR_SCAN_ERROR;
+    }
+
+    FILINFO info;
+    for (int i = 0; i < max_entries; i++) {
+        FRESULT fr = f_readdir(&m_dir, &info);
+        if (fr != FR_OK || info.fname[0] == 0) {
+            // 最後まで読んだ(読めなくなった所までを使う)
+            f_closedir(&m_dir);
+            m_scanning = false;
+            finish();
+            get_logger()->Write("DirIndex", LogNotice, "indexed %s: %d entries, %u bytes of names", m_path, m_count, m_names_size);
+            return DIR_SCAN_DONE;
+        }
+        if (!add_entry(&info)) {
+            get_logger()->Write("DirIndex", LogError, "out of memory: %s (%d entries)", m_path, m_count);
+            clear();
+            return DIR_SCAN_ERROR;
+        }
+    }
+    return DIR_SCAN_CONTINUE;
+}
+
+bool PlatformDirIndex::match(int index, const char* pattern, int length)
+{
+    const char* name = get_name(index);
+    for (; *name; name++) {
+        int i = 0;
+        while (i < length && name[i] && toupper((unsigned char)name[i]) == toupper((unsigned char)pattern[i])) {
+            i++;
+        }
+        if (i == length) {
+            return true;
+        }
+    }
+    return length == 0;
+}
+
+PlatformDirCache::PlatformDirCache()
+:
+    m_tick(0)
+{
+}
+
+PlatformDirIndex* PlatformDirCache::request(const char* path)
+{
+    PlatformDirIndex* victim = nullptr;
+
+    // 読み込みは1つずつ(別のディレクトリに移ったので中断する)
+    for (int i = 0; i < DIR_INDEX_CACHE_SLOTS; i++) {
+        PlatformDirIndex* slot = &m_slots[i];
+        if (slot->is_scanning() && strcmp(slot->get_path(), path) != 0) {
+            get_logger()->Write("DirIndex", LogNotice, "scan cancelled: %s", slot->get_path());
+            slot->clear();
+        }
+    }
+
+    m_tick++;
+    for (int i = 0; i < DIR_INDEX_CACHE_SLOTS; i++) {
+        PlatformDirIndex* slot = &m_slots[i];
+        if (slot->is_scanning()) {
+            slot->set_last_used(m_tick);
+            return slot;
+        }
+        if (!slot->is_valid()) {
+            // 空きがあればそこを使う
+            if (!victim || victim->is_valid()) {
+                victim = slot;
+            }
+            continue;
+        }
+        if (strcmp(slot->get_path(), path) == 0) {
+            slot->set_last_used(m_tick);
+            return slot;
+        }
+        // 空きが無ければ一番長く使っていないものを置き換える
+        if (!victim || (victim->is_valid() && slot->get_last_used() < victim->get_last_used())) {
+            victim = slot;
+        }
+    }
+
+    if (!victim->start_scan(path)) {
+        return nullptr;
+    }
+    victim->set_last_used(m_tick);
+    return victim;
+}
+
+void PlatformDirCache::cancel_scan()
+{
+    for (int i = 0; i < DIR_INDEX_CACHE_SLOTS; i++) {
+        if (m_slots[i].is_scanning()) {
+            get_logger()->Write("DirIndex", LogNotice, "scan cancelled: %s", m_slots[i].get_path());
+            m_slots[i].clear();
+        }
+    }
+}
+
+void PlatformDirCache::invalidate(const char* path)
+{
+    // ファイルならそれを含むディレクトリ、ディレクトリなら自身と親が対象
+    char parent[DIR_INDEX_MAX_PATH];
+    strncpy(parent, path, sizeof(parent) - 1);
+    parent[sizeof(parent) - 1] = '\0';
+    char* last_slash = strrchr(parent, '/');
+    if (last_slash) {
+        if (last_slash == parent) {
+            last_slash[1] = '\0';
+        } else {
+            *last_slash = '\0';
+        }
+    }
+
+    for (int i = 0; i < DIR_INDEX_CACHE_SLOTS; i++) {
+        PlatformDirIndex* slot = &m_slots[i];
+        if ((slot->is_valid() || slot->is_scanning()) &&
+            (strcmp(slot->get_path(), path) == 0 || strcmp(slot->get_path(), parent) == 0)) {
+            get_logger()->Write("DirIndex", LogNotice, "invalidated %s", slot->get_path());
+            slot->clear();
+        }
+    }
+}
+
+void PlatformDirCache::invalidate_all()
+{
+    for (int i = 0; i < DIR_INDEX_CACHE_SLOTS; i++) {
+        m_slots[i].clear();
+    }
+}
+
+PlatformDirFilter::PlatformDirFilter()
+:
+    m_index(nullptr),
+    m_length(0),
+    m_matches(nullptr),
+    m_count(0),
+    m_capacity(0)
+{
+    m_pattern[0] = '\0';
+}
+
+PlatformDirFilter::~PlatformDirFilter()
+{
+    free(m_matches);
+}
+
+void PlatformDirFilter::reset(PlatformDirIndex* index)
+{
+    m_index = index;
+    m_length = 0;
+    m_pattern[0] = '\0';
+    m_count = 0;
+}
+
+// インデックス全体から絞り込み直す
+void PlatformDirFilter::rebuild()
+{
+    m_count = 0;
+    if (!m_index || m_length == 0) {
+        return;
+    }
+
+    int count = m_index->get_count();
+    if (count > m_capacity) {
+        int* matches = (int*)realloc(m_matches, count * sizeof(int));
+        if (!matches) {
+            return;
+        }
+        m_matches = matches;
+        m_capacity = count;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (m_index->match(i, m_pattern, m_length)) {
+            m_matches[m_count++] = i;
+        }
+    }
+}
+
+bool PlatformDirFilter::push_char(char c)
+{
+    if (!m_index || m_length >= DIR_FILTER_MAX_LENGTH) {
+        return false;
+    }
+    m_pattern[m_length++] = c;
+    m_pattern[m_length] = '\0';
+
+    if (m_length == 1) {
+        rebuild();
+        return true;
+    }
+
+    // 今の結果から更に絞り込む
+    int count = 0;
+    for (int i = 0; i < m_count; i++) {
+        if (m_index->match(m_matches[i], m_pattern, m_length)) {
+            m_matches[count++] = m_matches[i];
+        }
+    }
+    m_count = count;
+    return true;
+}
+
+bool PlatformDirFilter::pop_char()
+{
+    if (m_length == 0) {
+        return false;
+    }
+    m_pattern[--m_length] = '\0';
+    rebuild();
+    return true;
+}
+
+int PlatformDirFilter::get_count()
+{
+    if (!m_index) {
+        return 0;
+    }
+    return m_length > 0 ? m_count : m_index->get_count();
+}
+
+int PlatformDirFilter::get_entry(int position)
+{
+    return m_length > 0 ? m_matches[position] : position;
+}
@@ -0,0 +1,137 @@
+#ifndef _PLATFORM_DIR_INDEX_H_
+#define _PLATFORM_DIR_INDEX_H_
+
+#include <circle/types.h>
+#include <fatfs/ff.h>
+
+// メモリに保持しておくディレクトリの数(最近開いたもの)
+#define DIR_INDEX_CACHE_SLOTS 4
+// ディレクトリのパスの最大長(ファイルブラウザのパスと同じ)
+#define DIR_INDEX_MAX_PATH 256
+// 絞り込みに使う文字列の最大長
+#define DIR_FILTER_MAX_LENGTH 32
+
+// scanの結果
+enum DirScanResult {
+    DIR_SCAN_ERROR = -1,    // 読み込みに失敗した(インデックスは空になる)
+    DIR_SCAN_CONTINUE = 0,  // まだ残りがある
+    DIR_SCAN_DONE = 1       // ソートまで終わった
+};
+
+// ディレクトリ内の1エントリ(名前はm_namesへのオフセット)
+struct DirIndexEntry {
+    u32 name;
+    u32 size;
+    u8 attrib;
+    u8 reserved[3];
+};
+
+/// @brief 1つのディレクトリの内容をソート済みで保持する
+/// ディレクトリが先、その中は大文字小文字を区別しない名前順。ドットで始まる名前は含めない
+class PlatformDirIndex {
+    private:
+        char m_path[DIR_INDEX_MAX_PATH];
+
+        DirIndexEntry* m_entries;
+        int m_count;
+        int m_capacity;
+
+        // 名前の文字列プール
+        char* m_names;
+        u32 m_names_size;
+        u32 m_names_capacity;
+
+        bool m_valid;
+        u32 m_last_used;
+
+        // 読み込み中のディレクトリ
+        DIR m_dir;
+        bool m_scanning;
+
+        void begin(const char* path);
+        bool add_entry(const FILINFO* info);
+        void finish();
+
+    public:
+        PlatformDirIndex();
+        ~PlatformDirIndex();
+
+        // 読み込み中なら中断する
+        void clear();
+
+        // 読み込みを始め、scanを繰り返し呼んで少しずつ進める(表示を止めないため)
+        bool start_scan(const char* path);
+        DirScanResult scan(int max_entries);
+        bool is_scanning() { return m_scanning; }
+
+        bool is_valid() { return m_valid; }
+        const char* get_path() { return m_path; }
+
+        int get_count() { return m_count; }
+        const char* get_name(int index) { return m_names + m_entries[index].name; }
+        u32 get_size(int index) { return m_entries[index].size; }
+        bool is_dir(int index) { return (m_entries[index].attrib & AM_DIR) != 0; }
+
+        // 名前にpatternを含むか(大文字小文字を区別しない)
+        bool match(int index, const char* pattern, int length);
+
+        void set_last_used(u32 tick) { m_last_used = tick; }
+        u32 get_last_used() { return m_last_used; }
+};
+
+/// @brief 最近開いたディレクトリのインデックスを保持する(LRU)
+/// ファイルを書き込んだ場合はinvalidateで作り直させる
+class PlatformDirCache {
+    private:
+        PlatformDirIndex m_slots[DIR_INDEX_CACHE_SLOTS];
+        u32 m_tick;
+
+    public:
+        PlatformDirCache();
+
+        // pathのインデックスを返す(無ければ読み込みを始める、開けなければnullptr)
+        // 読み込み中のものはis_scanningがtrueになる。別のディレクトリの読み込みは中断する
+        PlatformDirIndex* request(const char* path);
+        // 読み込み中のものがあれば中断する
+        void cancel_scan();
+
+        // path(ファイルまたはディレクトリ)を含むディレクトリを破棄する
+        void invalidate(const char* path);
+        void invalidate_all();
+};
+
+/// @brief 入力した文字列を名前に含む項目だけに絞り込む
+/// 文字を追加した時は今の結果だけを、削除した時は全体を調べ直す(SDカードは読まない)
+class PlatformDirFilter {
+    private:
+        PlatformDirIndex* m_index;
+
+        char m_pattern[DIR_FILTER_MAX_LENGTH + 1];
+        int m_length;
+
+        // 一致した項目のインデックス(m_index内)
+        int* m_matches;
+        int m_count;
+        int m_capacity;
+
+        void rebuild();
+
+    public:
+        PlatformDirFilter();
+        ~PlatformDirFilter();
+
+        // 対象のインデックスを設定し、絞り込みを解除する
+        void reset(PlatformDirIndex* index);
+
+        bool push_char(char c);
+        bool pop_char();
+
+        bool is_active() { return m_length > 0; }
+        const char* get_pattern() { return m_pattern; }
+
+        // 絞り込み中でなければインデックスの全項目
+        int get_count();
+        int get_entry(int position);
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "PlatformFrameSkip.h"
+#include "PlatformDeferredLog.h"
+
+#include <stdio.h>
+
+PlatformFrameSkip::PlatformFrameSkip()
+:
+    m_frame_us(16667),
+    m_clock_hz(0),
+    m_run_average(0),
+    m_present_average(0),
+    m_ratio(1),
+    m_min_ratio(1),
+    m_phase(0),
+    m_changes(0)
+{
+}
+
+void PlatformFrameSkip::update_average(u32* average, u32 us)
+{
+    u32 limit = m_frame_us * FRAME_SKIP_SAMPLE_LIMIT;
+    if (us > limit) {
+        us = limit;
+    }
+    if (*average == 0) {
+        *average = us << 4;
+        return;
+    }
+    s32 diff = (s32)(us << 4) - (s32)*average;
+    *average += diff >> FRAME_SKIP_AVERAGE_SHIFT;
+}
+
+void PlatformFrameSkip::set_clock(u32 clock_hz)
+{
+    if (m_clock_hz && clock_hz && clock_hz != m_clock_hz) {
+        // 処理時間はクロックに反比例するとみなす
+        m_run_average = (u32)((u64)m_run_average * m_clock_hz / clock_hz);
+        m_present_average = (u32)((u64)m_present_average * m_clock_hz / clock_hz);
+        DEFERRED_LOG(FRAMESKIP, LogNotice, "clock %u -> %u MHz (run %u us, draw %u us)",
+            m_clock_hz / 1000000, clock_hz / 1000000, get_run_average(), get_present_average());
+    }
+    m_clock_hz = clock_hz;
+}
+
+void PlatformFrameSkip::set_min_ratio(int ratio)
+{
+    if (ratio < 1) {
+        ratio = 1;
+    } else if (ratio > FRAME_SKIP_MAX_RATIO) {
+        ratio = FRAME_SKIP_MAX_RATIO;
+    }
+    m_min_ratio = ratio;
+}
+
+// 実行 + 表示/N が目標の時間に収まる一番小さいNを選ぶ
+int PlatformFrameSkip::choose_ratio()
+{
+    u32 run = get_run_average();
+    u32 present = get_present_average();
+    u32 target = m_frame_us * FRAME_SKIP_TARGET_PERCENT / 100;
+
+    int ratio;
+    if (run >= target) {
+        ratio = FRAME_SKIP_MAX_RATIO;
+    } else {
+        u32 spare = target - run;
+        ratio = (int)((present + spare - 1) / spare);
+        if (ratio < 1) {
+            ratio = 1;
+        } else if (ratio > FRAME_SKIP_MAX_RATIO) {
+            ratio = FRAME_SKIP_MAX_RATIO;
+        }
+    }
+
+    // 減らす場合は1段階ずつ、減らした後も余裕がある場合だけにする
+    if (ratio < m_ratio) {
+        int relaxed = m_ratio - 1;
+        u32 relax = m_frame_us * FRAME_SKIP_RELAX_PERCENT / 100;
+        ratio = (run + present / relaxed <= relax) ? relaxed : m_ratio;
+    }
+    return ratio < m_min_ratio ? m_min_ratio : ratio;
+}
+
+bool PlatformFrameSkip::should_present()
+{
+    if (m_phase == 0) {
+        int ratio = choose_ratio();
+        if (ratio != m_ratio) {
+            DEFERRED_LOG(FRAMESKIP, LogNotice, "draw 1/%d -> 1/%d (run %u us, draw %u us, frame %u us)",
+                m_ratio, ratio, get_run_average(), get_present_average(), m_frame_us);
+            m_ratio = ratio;
+            m_changes++;
+        }
+    }
+    bool present = (m_phase == 0);
+    if (++m_phase >= m_ratio) {
+        m_phase = 0;
+    }
+    return present;
+}
+
+void PlatformFrameSkip::format(char* buffer, int size)
+{
+    snprintf(buffer, size, "draw 1/%d", m_ratio);
+}
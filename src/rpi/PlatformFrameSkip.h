@@ -0,0 +1,66 @@
+#ifndef _PLATFORM_FRAME_SKIP_H_
+#define _PLATFORM_FRAME_SKIP_H_
+
+#include <circle/types.h>
+
+// 表示を間引く最大の割合(このフレーム数に1回は表示する)
+#define FRAME_SKIP_MAX_RATIO 8
+// 1フレームの時間のうち、実行と表示に使ってよい割合(%)
+#define FRAME_SKIP_TARGET_PERCENT 90
+// 間引きを減らすのは、減らしてもこの割合(%)に収まる場合だけにする(行ったり来たりしないように)
+#define FRAME_SKIP_RELAX_PERCENT 75
+// 移動平均の重み(1/2^n)
+#define FRAME_SKIP_AVERAGE_SHIFT 3
+// 1回の計測値の上限(1フレームの時間の倍数)。SDアクセスなどで平均が跳ね上がらないようにする
+#define FRAME_SKIP_SAMPLE_LIMIT 4
+// これ以上遅れた場合は追いつこうとせずに時刻を合わせる(マイクロ秒)
+#define FRAME_SKIP_MAX_LAG_US 100000
+
+/// @brief VMの実行と画面表示にかかる時間の移動平均から表示を間引く割合を決める
+/// 割合が1/Nの場合はNフレームに1回、等間隔で表示する
+class PlatformFrameSkip {
+    private:
+        u32 m_frame_us;
+        // 計測した時点のARMクロック(0なら不明)
+        u32 m_clock_hz;
+        // 移動平均(16倍した値、0なら未計測)
+        u32 m_run_average;
+        u32 m_present_average;
+
+        int m_ratio;
+        int m_min_ratio;
+        int m_phase;
+        u32 m_changes;
+
+        void update_average(u32* average, u32 us);
+        int choose_ratio();
+
+    public:
+        PlatformFrameSkip();
+
+        // 1フレームのエミュレーション時間(マイクロ秒)
+        void set_frame_time(u32 frame_us) { m_frame_us = frame_us; }
+
+        void add_run_cost(u32 us) { update_average(&m_run_average, us); }
+        void add_present_cost(u32 us) { update_average(&m_present_average, us); }
+
+        // ARMクロックが変わった場合に、移動平均が追いつくのを待たずに処理時間を見積もり直す
+        void set_clock(u32 clock_hz);
+        // 間引く割合の下限(スロットリング中は余裕を持たせる)
+        void set_min_ratio(int ratio);
+
+        // フレームごとに呼び、このフレームを表示するかを返す(割合は表示の周期の始めに決め直す)
+        bool should_present();
+        // 早送りやメニューから戻った場合に周期をやり直す
+        void restart() { m_phase = 0; }
+
+        int get_ratio() { return m_ratio; }
+        u32 get_run_average() { return m_run_average >> 4; }
+        u32 get_present_average() { return m_present_average >> 4; }
+        u32 get_changes() { return m_changes; }
+
+        // オーバーレイ表示用の文字列を作る("draw 1/2")
+        void format(char* buffer, int size);
+};
+
+#endif
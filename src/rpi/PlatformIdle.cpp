@@ -0,0 +1,82 @@
+#include "PlatformIdle.h"
+#include "PlatformLog.h"
+
+#include <circle/timer.h>
+#include <circle/synchronize.h>
+
+PlatformIdle::PlatformIdle()
+:
+    m_timer(nullptr),
+    m_scheduler(nullptr),
+    m_timer_fired(false),
+    m_idle_us(0),
+    m_wakeups(0)
+{
+}
+
+PlatformIdle::~PlatformIdle()
+{
+    if (m_timer) {
+        m_timer->Stop();
+        delete m_timer;
+        m_timer = nullptr;
+    }
+}
+
+bool PlatformIdle::initialize(CInterruptSystem* interrupt, CScheduler* scheduler)
+{
+    m_scheduler = scheduler;
+
+    m_timer = new CUserTimer(interrupt, timer_handler, this);
+    if (!m_timer->Initialize()) {
+        get_logger()->Write("Idle", LogWarning, "Failed to initialize user timer, falling back to busy waiting");
+        delete m_timer;
+        m_timer = nullptr;
+        return false;
+    }
+    return true;
+}
+
+// 割り込みハンドラ(WFIから起こすのが目的なので、印を付けるだけ)
+void PlatformIdle::timer_handler(CUserTimer* timer, void* param)
+{
+    PlatformIdle* idle = static_cast<PlatformIdle*>(param);
+    idle->m_timer_fired = true;
+}
+
+u32 PlatformIdle::wait_until(u64 deadline_us)
+{
+    u32 idle_us = 0;
+    for (;;) {
+        // USBやVCHIQのタスクを先に動かす
+        if (m_scheduler) {
+            m_scheduler->Yield();
+        }
+
+        u64 now = CTimer::GetClockTicks64();
+        if (now >= deadline_us) {
+            break;
+        }
+        u32 remaining = (u32)(deadline_us - now);
+        if (!m_timer || remaining < IDLE_MIN_WAIT_US) {
+            CTimer::SimpleusDelay(remaining);
+            break;
+        }
+
+        m_timer_fired = false;
+        m_timer->Start(remaining);
+
+        // 割り込みを止めてから確認する(確認とWFIの間に割り込みが来ても、保留中の割り込みでWFIから戻る)
+        DisableIRQs();
+        if (!m_timer_fired) {
+            platform_wait_for_interrupt();
+        }
+        EnableIRQs();
+
+        idle_us += (u32)(CTimer::GetClockTicks64() - now);
+        m_wakeups++;
+    }
+
+    m_idle_us += idle_us;
+    return idle_us;
+}
@@ -0,0 +1,47 @@
+#ifndef _PLATFORM_IDLE_H_
+#define _PLATFORM_IDLE_H_
+
+#include <circle/types.h>
+#include <circle/interrupt.h>
+#include <circle/usertimer.h>
+#include <circle/sched/scheduler.h>
+
+// これより短い待ちはタイマー割り込みを使わずにビジーウェイトする(マイクロ秒)
+#define IDLE_MIN_WAIT_US 100
+
+// 割り込みが入るまでコアを止める(WFI)
+static inline void platform_wait_for_interrupt()
+{
+#if defined(__arm__) || defined(__aarch64__)
+    asm volatile ("wfi");
+#endif
+}
+
+/// @brief 次の期限までWFIでコアを止めて待つ(ビジーウェイトの代わり)
+/// 期限にはワンショットのタイマー割り込みを使い、USBなどの割り込みで起きた場合は他のタスクを動かしてから再び止める
+class PlatformIdle {
+    private:
+        CUserTimer* m_timer;
+        CScheduler* m_scheduler;
+        volatile bool m_timer_fired;
+
+        u64 m_idle_us;
+        u32 m_wakeups;
+
+        static void timer_handler(CUserTimer* timer, void* param);
+
+    public:
+        PlatformIdle();
+        ~PlatformIdle();
+
+        // タイマーを初期化できなかった場合は、従来どおりビジーウェイトで待つ
+        bool initialize(CInterruptSystem* interrupt, CScheduler* scheduler);
+
+        // deadline_us(CTimer::GetClockTicks64の値)まで待ち、WFIで止まっていた時間(マイクロ秒)を返す
+        u32 wait_until(u64 deadline_us);
+
+        u64 get_idle_us() { return m_idle_us; }
+        u32 get_wakeups() { return m_wakeups; }
+};
+
+#endif
@@ -1,3 +1,92 @@
-
 #include <circle/sched/scheduler.h>
+#include <circle/usb/usbgamepad.h>
 #include "PlatformInput.h"
+#include "config.hpp"
+
+void GamePadMapping::add_button(u32 mask, u32 bit)
+{
+    if (mask == 0 || m_button_count >= 8) {
+        return;
+    }
+    m_button_mask[m_button_count] = mask;
+    m_button_bit[m_button_count] = bit;
+    m_button_count++;
+}
+
+void GamePadMapping::add_axis(int index, bool less_than, int value, u32 bit)
+{
+    // デバイスに存在しない軸は最初から除外しておく
+    if (index < 0 || index >= m_naxes || m_axis_count >= 8) {
+        return;
+    }
+    m_axis[m_axis_count].index = index;
+    m_axis[m_axis_count].less_than = less_than;
+    m_axis[m_axis_count].value = value;
+    m_axis[m_axis_count].bit = bit;
+    m_axis_count++;
+}
+
+void GamePadMapping::build(SystemConfiguration* config, int naxes)
+{
+    m_button_count = 0;
+    m_axis_count = 0;
+    m_naxes = naxes;
+
+    if (!config) {
+        // config.sysが無い場合の割り当て(デジタル方向ボタンとアナログスティック)
+        add_button(GamePadButtonUp, GAMEPAD_BIT_UP);
+        add_button(GamePadButtonDown, GAMEPAD_BIT_DOWN);
+        add_button(GamePadButtonLeft, GAMEPAD_BIT_LEFT);
+        add_button(GamePadButtonRight, GAMEPAD_BIT_RIGHT);
+        add_button(GamePadButtonA, GAMEPAD_BIT_A);
+        add_button(GamePadButtonB, GAMEPAD_BIT_B);
+        add_button(GamePadButtonStart, GAMEPAD_BIT_START);
+        add_button(GamePadButtonSelect, GAMEPAD_BIT_SELECT);
+        add_axis(0, true, 64, GAMEPAD_BIT_LEFT);
+        add_axis(0, false, 192, GAMEPAD_BIT_RIGHT);
+        add_axis(1, true, 64, GAMEPAD_BIT_UP);
+        add_axis(1, false, 192, GAMEPAD_BIT_DOWN);
+        return;
+    }
+
+    SystemConfiguration::Button* buttons[8] = {
+        config->buttonUp, config->buttonDown, config->buttonLeft, config->buttonRight,
+        config->buttonA, config->buttonB, config->buttonSelect, config->buttonStart
+    };
+    static const u32 bits[8] = {
+        GAMEPAD_BIT_UP, GAMEPAD_BIT_DOWN, GAMEPAD_BIT_LEFT, GAMEPAD_BIT_RIGHT,
+        GAMEPAD_BIT_A, GAMEPAD_BIT_B, GAMEPAD_BIT_SELECT, GAMEPAD_BIT_START
+    };
+
+    for (int i = 0; i < 8; i++) {
+        SystemConfiguration::Button* button = buttons[i];
+        if (!button) {
+            continue;
+        }
+        if (button->isAxis) {
+            add_axis(button->axisIndex, button->compareLessThan, button->compareValue, bits[i]);
+        } else {
+            add_button(button->bitMask, bits[i]);
+        }
+    }
+}
+
+u32 GamePadMapping::map(const TGamePadState* state) const
+{
+    u32 result = 0;
+
+    for (int i = 0; i < m_button_count; i++) {
+        if (state->buttons & m_button_mask[i]) {
+            result |= m_button_bit[i];
+        }
+    }
+
+    for (int i = 0; i < m_axis_count; i++) {
+        int value = state->axes[m_axis[i].index].value;
+        if (m_axis[i].less_than ? (value < m_axis[i].value) : (value > m_axis[i].value)) {
+            result |= m_axis[i].bit;
+        }
+    }
+
+    return result;
+}
@@ -4,6 +4,23 @@
 
 #include <circle/types.h>
 
+// 同時に扱うデバイスの最大数
+#define MAX_GAMEPADS 4
+#define MAX_KEYBOARDS 4
+
+// rpi_gamepad_statusのビット割り当て
+#define GAMEPAD_BIT_UP      (1 << 0)
+#define GAMEPAD_BIT_DOWN    (1 << 1)
+#define GAMEPAD_BIT_LEFT    (1 << 2)
+#define GAMEPAD_BIT_RIGHT   (1 << 3)
+#define GAMEPAD_BIT_A       (1 << 4)
+#define GAMEPAD_BIT_B       (1 << 5)
+#define GAMEPAD_BIT_SELECT  (1 << 8)
+#define GAMEPAD_BIT_START   (1 << 9)
+
+class SystemConfiguration;
+struct TGamePadState;
+
 enum KeyEventType {
     KEY_EVENT_DOWN,
     KEY_EVENT_UP
@@ -15,6 +32,42 @@ struct PlatformKeyEvent {
     u8 code;              // 仮想キーコード
     bool extended;        // 拡張キーフラグ
     bool repeat;          // リピートフラグ
+    u64 timestamp;        // イベント発生時刻(マイクロ秒)
+};
+
+// SystemConfigurationのボタン割り当てをビットマスクに展開したもの
+// デバイスごとに持ち、軸の数が変わった時だけ作り直す
+class GamePadMapping {
+    private:
+        // ボタン割り当て(マスクが立っていればbitをセット)
+        u32 m_button_mask[8];
+        u32 m_button_bit[8];
+        int m_button_count;
+
+        // 軸割り当て(閾値と比較してbitをセット)
+        struct AxisRule {
+            int index;
+            bool less_than;
+            int value;
+            u32 bit;
+        } m_axis[8];
+        int m_axis_count;
+
+        // 構築時のデバイスの軸数(-1は未構築)
+        int m_naxes;
+
+        void add_button(u32 mask, u32 bit);
+        void add_axis(int index, bool less_than, int value, u32 bit);
+
+    public:
+        GamePadMapping() : m_button_count(0), m_axis_count(0), m_naxes(-1) {}
+
+        // configがnullptrの場合はデフォルトの割り当てで構築する
+        void build(SystemConfiguration* config, int naxes);
+        bool is_built_for(int naxes) { return m_naxes == naxes; }
+        void invalidate() { m_naxes = -1; }
+
+        u32 map(const TGamePadState* state) const;
 };
 
 #endif
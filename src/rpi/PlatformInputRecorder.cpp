@@ -0,0 +1,319 @@
+#include "PlatformInputRecorder.h"
+#include "PlatformLog.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+PlatformInputRecorder::PlatformInputRecorder()
+:
+    m_mode(MODE_IDLE),
+    m_records(nullptr),
+    m_record_count(0),
+    m_record_capacity(0),
+    m_key_index(0),
+    m_gamepad_index(0),
+    m_hash_index(0),
+    m_frame_count(0),
+    m_hash_checked(0),
+    m_hash_mismatch(0),
+    m_first_mismatch_frame(0)
+{
+    m_path[0] = '\0';
+    memset(m_gamepad_status, 0, sizeof(m_gamepad_status));
+}
+
+PlatformInputRecorder::~PlatformInputRecorder()
+{
+    release();
+}
+
+void PlatformInputRecorder::release()
+{
+    if (m_records) {
+        free(m_records);
+        m_records = nullptr;
+    }
+    m_record_count = 0;
+    m_record_capacity = 0;
+}
+
+bool PlatformInputRecorder::start_recording(const char* path)
+{
+    if (m_mode != MODE_IDLE || !path) {
+        return false;
+    }
+
+    release();
+    m_records = (InputRecord*)malloc(sizeof(InputRecord) * INPUT_RECORD_INITIAL_CAPACITY);
+    if (!m_records) {
+        get_logger()->Write("InputRecorder", LogError, "Failed to allocate record buffer");
+        return false;
+    }
+    m_record_capacity = INPUT_RECORD_INITIAL_CAPACITY;
+
+    strncpy(m_path, path, sizeof(m_path) - 1);
+    m_path[sizeof(m_path) - 1] = '\0';
+    m_frame_count = 0;
+    memset(m_gamepad_status, 0, sizeof(m_gamepad_status));
+
+    m_mode = MODE_RECORDING;
+    get_logger()->Write("InputRecorder", LogNotice, "Recording started: %s", m_path);
+    return true;
+}
+
+bool PlatformInputRecorder::start_playback(const char* path)
+{
+    if (m_mode != MODE_IDLE || !path) {
+        return false;
+    }
+
+    strncpy(m_path, path, sizeof(m_path) - 1);
+    m_path[sizeof(m_path) - 1] = '\0';
+
+    if (!read_file()) {
+        release();
+        return false;
+    }
+
+    m_key_index = 0;
+    m_gamepad_index = 0;
+    m_hash_index = 0;
+    m_hash_checked = 0;
+    m_hash_mismatch = 0;
+    m_first_mismatch_frame = 0;
+
+    m_mode = MODE_PLAYING;
+    get_logger()->Write("InputRecorder", LogNotice, "Playback started: %s (%u records, %u frames)",
+                        m_path, m_record_count, m_frame_count);
+    return true;
+}
+
+void PlatformInputRecorder::stop(u32 frame)
+{
+    if (m_mode == MODE_RECORDING) {
+        m_frame_count = frame;
+        write_file();
+        get_logger()->Write("InputRecorder", LogNotice, "Recording stopped: %u records, %u frames",
+                            m_record_count, m_frame_count);
+    } else if (m_mode == MODE_PLAYING) {
+        get_logger()->Write("InputRecorder", LogNotice, "Playback stopped at frame %u: %u hashes checked, %u mismatches (first at frame %u)",
+                            frame, m_hash_checked, m_hash_mismatch, m_first_mismatch_frame);
+    }
+
+    release();
+    m_mode = MODE_IDLE;
+}
+
+bool PlatformInputRecorder::append(const InputRecord& record)
+{
+    if (m_record_count >= m_record_capacity) {
+        // 倍々で拡張する
+        u32 new_capacity = m_record_capacity * 2;
+        InputRecord* new_records = (InputRecord*)realloc(m_records, sizeof(InputRecord) * new_capacity);
+        if (!new_records) {
+            get_logger()->Write("InputRecorder", LogError, "Record buffer full (%u records)", m_record_count);
+            return false;
+        }
+        m_records = new_records;
+        m_record_capacity = new_capacity;
+    }
+    m_records[m_record_count++] = record;
+    return true;
+}
+
+void PlatformInputRecorder::record_key(u32 frame, const PlatformKeyEvent& event)
+{
+    if (m_mode != MODE_RECORDING) {
+        return;
+    }
+
+    InputRecord record;
+    record.frame = frame;
+    record.type = (event.type == KEY_EVENT_DOWN) ? INPUT_RECORD_KEY_DOWN : INPUT_RECORD_KEY_UP;
+    record.code = event.code;
+    record.flags = (event.extended ? 0x01 : 0) | (event.repeat ? 0x02 : 0);
+    record.index = 0;
+    record.value = 0;
+    append(record);
+}
+
+void PlatformInputRecorder::record_gamepad(u32 frame, const u32* status)
+{
+    if (m_mode != MODE_RECORDING) {
+        return;
+    }
+
+    // 変化があったものだけ記録する
+    for (int i = 0; i < INPUT_GAMEPAD_COUNT; i++) {
+        if (status[i] != m_gamepad_status[i]) {
+            InputRecord record;
+            record.frame = frame;
+            record.type = INPUT_RECORD_GAMEPAD;
+            record.code = 0;
+            record.flags = 0;
+            record.index = (u8)i;
+            record.value = status[i];
+            append(record);
+
+            m_gamepad_status[i] = status[i];
+        }
+    }
+}
+
+void PlatformInputRecorder::record_ram_hash(u32 frame, u32 hash)
+{
+    if (m_mode != MODE_RECORDING) {
+        return;
+    }
+
+    InputRecord record;
+    record.frame = frame;
+    record.type = INPUT_RECORD_RAM_HASH;
+    record.code = 0;
+    record.flags = 0;
+    record.index = 0;
+    record.value = hash;
+    append(record);
+}
+
+bool PlatformInputRecorder::pop_key(u32 frame, PlatformKeyEvent* event)
+{
+    if (m_mode != MODE_PLAYING) {
+        return false;
+    }
+
+    while (m_key_index < m_record_count) {
+        const InputRecord& record = m_records[m_key_index];
+        if (record.frame > frame) {
+            return false;
+        }
+        m_key_index++;
+
+        if (record.type == INPUT_RECORD_KEY_DOWN || record.type == INPUT_RECORD_KEY_UP) {
+            event->type = (record.type == INPUT_RECORD_KEY_DOWN) ? KEY_EVENT_DOWN : KEY_EVENT_UP;
+            event->code = record.code;
+            event->extended = (record.flags & 0x01) != 0;
+            event->repeat = (record.flags & 0x02) != 0;
+            event->timestamp = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+void PlatformInputRecorder::apply_gamepad(u32 frame, u32* status)
+{
+    if (m_mode != MODE_PLAYING) {
+        return;
+    }
+
+    while (m_gamepad_index < m_record_count) {
+        const InputRecord& record = m_records[m_gamepad_index];
+        if (record.frame > frame) {
+            return;
+        }
+        m_gamepad_index++;
+
+        if (record.type == INPUT_RECORD_GAMEPAD && record.index < INPUT_GAMEPAD_COUNT) {
+            status[record.index] = record.value;
+        }
+    }
+}
+
+bool PlatformInputRecorder::verify_ram_hash(u32 frame, u32 hash)
+{
+    if (m_mode != MODE_PLAYING) {
+        return true;
+    }
+
+    while (m_hash_index < m_record_count) {
+        const InputRecord& record = m_records[m_hash_index];
+        if (record.frame > frame) {
+            return true;
+        }
+        m_hash_index++;
+
+        if (record.type == INPUT_RECORD_RAM_HASH && record.frame == frame) {
+            m_hash_checked++;
+            if (record.value != hash) {
+                if (m_hash_mismatch == 0) {
+                    m_first_mismatch_frame = frame;
+                    get_logger()->Write("InputRecorder", LogWarning, "RAM hash mismatch at frame %u: expected %08X, actual %08X",
+                                        frame, record.value, hash);
+                }
+                m_hash_mismatch++;
+                return false;
+            }
+            return true;
+        }
+    }
+    return true;
+}
+
+bool PlatformInputRecorder::is_finished(u32 frame)
+{
+    return m_mode == MODE_PLAYING && frame >= m_frame_count;
+}
+
+bool PlatformInputRecorder::write_file()
+{
+    FILE* fp = fopen(m_path, "wb");
+    if (!fp) {
+        get_logger()->Write("InputRecorder", LogError, "Failed to open %s for writing", m_path);
+        return false;
+    }
+
+    InputMovieHeader header;
+    header.magic = INPUT_MOVIE_MAGIC;
+    header.version = INPUT_MOVIE_VERSION;
+    header.record_count = m_record_count;
+    header.frame_count = m_frame_count;
+
+    bool result = fwrite(&header, sizeof(header), 1, fp) == 1;
+    if (result && m_record_count > 0) {
+        result = fwrite(m_records, sizeof(InputRecord), m_record_count, fp) == m_record_count;
+    }
+    fclose(fp);
+
+    if (!result) {
+        get_logger()->Write("InputRecorder", LogError, "Failed to write %s", m_path);
+    }
+    return result;
+}
+
+bool PlatformInputRecorder::read_file()
+{
+    FILE* fp = fopen(m_path, "rb");
+    if (!fp) {
+        get_logger()->Write("InputRecorder", LogError, "Failed to open %s", m_path);
+        return false;
+    }
+
+    InputMovieHeader header;
+    if (fread(&header, sizeof(header), 1, fp) != 1 ||
+        header.magic != INPUT_MOVIE_MAGIC || header.version != INPUT_MOVIE_VERSION) {
+        get_logger()->Write("InputRecorder", LogError, "Invalid input movie: %s", m_path);
+        fclose(fp);
+        return false;
+    }
+
+    release();
+    m_record_capacity = header.record_count > 0 ? header.record_count : 1;
+    m_records = (InputRecord*)malloc(sizeof(InputRecord) * m_record_capacity);
+    if (!m_records) {
+        get_logger()->Write("InputRecorder", LogError, "Failed to allocate %u records", header.record_count);
+        fclose(fp);
+        return false;
+    }
+
+    m_record_count = (u32)fread(m_records, sizeof(InputRecord), header.record_count, fp);
+    m_frame_count = header.frame_count;
+    fclose(fp);
+
+    if (m_record_count != header.record_count) {
+        get_logger()->Write("InputRecorder", LogWarning, "Input movie truncated: %u/%u records",
+                            m_record_count, header.record_count);
+    }
+    return true;
+}
@@ -0,0 +1,110 @@
+#ifndef _PLATFORM_INPUT_RECORDER_H_
+#define _PLATFORM_INPUT_RECORDER_H_
+
+#include <circle/types.h>
+#include "PlatformInput.h"
+
+// 入力ムービーファイルの識別子("RPIM")とバージョン
+#define INPUT_MOVIE_MAGIC   0x4D495052
+#define INPUT_MOVIE_VERSION 1
+
+// 記録バッファの初期確保数(足りなくなったら倍々で拡張する)
+#define INPUT_RECORD_INITIAL_CAPACITY 4096
+
+// ゲームパッドの記録対象数(rpi_gamepad_statusと同じ)
+#define INPUT_GAMEPAD_COUNT MAX_GAMEPADS
+
+// 入力レコードの種類
+enum InputRecordType {
+    INPUT_RECORD_KEY_DOWN = 0,
+    INPUT_RECORD_KEY_UP,
+    INPUT_RECORD_GAMEPAD,
+    INPUT_RECORD_RAM_HASH
+};
+
+// ファイルヘッダ
+struct InputMovieHeader {
+    u32 magic;          // INPUT_MOVIE_MAGIC
+    u32 version;        // INPUT_MOVIE_VERSION
+    u32 record_count;   // 後続するInputRecordの数
+    u32 frame_count;    // 記録したフレーム数
+};
+
+// 1レコード(12バイト固定)
+struct InputRecord {
+    u32 frame;          // 適用するフレーム番号
+    u8 type;            // InputRecordType
+    u8 code;            // 仮想キーコード(キーイベント時)
+    u8 flags;           // bit0:extended, bit1:repeat
+    u8 index;           // ゲームパッド番号(ゲームパッド時)
+    u32 value;          // ゲームパッドの状態、あるいはRAMハッシュ
+};
+
+/// @brief フレーム番号付きで入力を記録・再生するクラス
+/// 記録中はメモリ上に溜めておき、停止時にまとめてSDに書き込む(エミュ実行中のSDアクセスを避けるため)
+class PlatformInputRecorder {
+    public:
+        enum Mode {
+            MODE_IDLE,
+            MODE_RECORDING,
+            MODE_PLAYING
+        };
+
+    private:
+        Mode m_mode;
+        char m_path[256];
+
+        InputRecord* m_records;
+        u32 m_record_count;
+        u32 m_record_capacity;
+
+        // 再生位置(種類ごとに独立して進める)
+        u32 m_key_index;
+        u32 m_gamepad_index;
+        u32 m_hash_index;
+        u32 m_frame_count;
+
+        // ゲームパッドの前回状態(変化があった時だけ記録する)
+        u32 m_gamepad_status[INPUT_GAMEPAD_COUNT];
+
+        // RAMハッシュの検証結果
+        u32 m_hash_checked;
+        u32 m_hash_mismatch;
+        u32 m_first_mismatch_frame;
+
+        bool append(const InputRecord& record);
+        bool write_file();
+        bool read_file();
+        void release();
+
+    public:
+        PlatformInputRecorder();
+        ~PlatformInputRecorder();
+
+        bool start_recording(const char* path);
+        bool start_playback(const char* path);
+        void stop(u32 frame);
+
+        Mode get_mode() { return m_mode; }
+        bool is_recording() { return m_mode == MODE_RECORDING; }
+        bool is_playing() { return m_mode == MODE_PLAYING; }
+
+        // 記録
+        void record_key(u32 frame, const PlatformKeyEvent& event);
+        void record_gamepad(u32 frame, const u32* status);
+        void record_ram_hash(u32 frame, u32 hash);
+
+        // 再生(指定フレームのキーイベントを1つずつ取り出す)
+        bool pop_key(u32 frame, PlatformKeyEvent* event);
+        // 再生(指定フレームまでのゲームパッド状態をstatusに反映)
+        void apply_gamepad(u32 frame, u32* status);
+        // 再生(指定フレームのRAMハッシュと比較)
+        bool verify_ram_hash(u32 frame, u32 hash);
+        // 再生の終端に達したか
+        bool is_finished(u32 frame);
+
+        u32 get_hash_mismatch() { return m_hash_mismatch; }
+        u32 get_first_mismatch_frame() { return m_first_mismatch_frame; }
+};
+
+#endif
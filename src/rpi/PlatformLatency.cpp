@@ -0,0 +1,119 @@
+#include "PlatformLatency.h"
+#include "PlatformLog.h"
+
+#include <stdio.h>
+#include <string.h>
+
+void LatencyHistogram::add(u32 value)
+{
+    m_samples[m_pos] = value;
+    m_pos = (m_pos + 1) % LATENCY_SAMPLE_COUNT;
+    if (m_count < LATENCY_SAMPLE_COUNT) {
+        m_count++;
+    }
+    m_total++;
+}
+
+void LatencyHistogram::get_percentiles(u32* p50, u32* p95, u32* p99, u32* max)
+{
+    *p50 = *p95 = *p99 = *max = 0;
+    if (m_count == 0) {
+        return;
+    }
+
+    // サンプル数が少ないので挿入ソートで十分
+    u32 sorted[LATENCY_SAMPLE_COUNT];
+    for (u32 i = 0; i < m_count; i++) {
+        u32 value = m_samples[i];
+        u32 j = i;
+        while (j > 0 && sorted[j - 1] > value) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = value;
+    }
+
+    *p50 = sorted[(m_count - 1) * 50 / 100];
+    *p95 = sorted[(m_count - 1) * 95 / 100];
+    *p99 = sorted[(m_count - 1) * 99 / 100];
+    *max = sorted[m_count - 1];
+}
+
+PlatformLatency::PlatformLatency()
+:
+    m_pending_count(0),
+    m_inflight_count(0),
+    m_consumed_frame(0),
+    m_next_report_us(0),
+    m_reported_total(0)
+{
+}
+
+void PlatformLatency::input_dispatched(u64 timestamp)
+{
+    if (timestamp == 0 || m_pending_count >= LATENCY_PENDING_MAX) {
+        return;
+    }
+    m_pending[m_pending_count++] = timestamp;
+}
+
+void PlatformLatency::frame_run(u32 frame, u64 now)
+{
+    if (m_pending_count == 0) {
+        return;
+    }
+
+    // このフレームで消費されたものとして記録し、表示待ちに移す
+    for (int i = 0; i < m_pending_count; i++) {
+        m_consume.add((u32)(now - m_pending[i]));
+        if (m_inflight_count < LATENCY_PENDING_MAX) {
+            m_inflight[m_inflight_count++] = m_pending[i];
+        }
+    }
+    m_pending_count = 0;
+    m_consumed_frame = frame;
+}
+
+void PlatformLatency::frame_presented(u64 now)
+{
+    for (int i = 0; i < m_inflight_count; i++) {
+        m_present.add((u32)(now - m_inflight[i]));
+    }
+    m_inflight_count = 0;
+}
+
+void PlatformLatency::update(u64 now)
+{
+    if (now < m_next_report_us) {
+        return;
+    }
+    m_next_report_us = now + LATENCY_REPORT_INTERVAL_US;
+
+    // 新しいサンプルが無ければ出力しない
+    if (m_present.get_total() == m_reported_total) {
+        return;
+    }
+    m_reported_total = m_present.get_total();
+
+    char consume[64];
+    char present[64];
+    format_consume(consume, sizeof(consume));
+    format_present(present, sizeof(present));
+    get_logger()->Write("Latency", LogNotice, "%s / %s (frame %u)", consume, present, m_consumed_frame);
+}
+
+void PlatformLatency::format_consume(char* buffer, int size)
+{
+    u32 p50, p95, p99, max;
+    m_consume.get_percentiles(&p50, &p95, &p99, &max);
+    snprintf(buffer, size, "VM  p50:%u.%01u p95:%u.%01u p99:%u.%01u ms",
+             p50 / 1000, (p50 % 1000) / 100, p95 / 1000, (p95 % 1000) / 100, p99 / 1000, (p99 % 1000) / 100);
+}
+
+void PlatformLatency::format_present(char* buffer, int size)
+{
+    u32 p50, p95, p99, max;
+    m_present.get_percentiles(&p50, &p95, &p99, &max);
+    snprintf(buffer, size, "DSP p50:%u.%01u p95:%u.%01u p99:%u.%01u ms",
+             p50 / 1000, (p50 % 1000) / 100, p95 / 1000, (p95 % 1000) / 100, p99 / 1000, (p99 % 1000) / 100);
+}
@@ -0,0 +1,72 @@
+#ifndef _PLATFORM_LATENCY_H_
+#define _PLATFORM_LATENCY_H_
+
+#include <circle/types.h>
+
+// パーセンタイル計算に使う直近のサンプル数
+#define LATENCY_SAMPLE_COUNT 256
+// VMに渡されてから表示されるまでの間に保持しておく入力の最大数
+#define LATENCY_PENDING_MAX 32
+// シリアルへの出力間隔(マイクロ秒)
+#define LATENCY_REPORT_INTERVAL_US 5000000
+
+/// @brief 直近のサンプルからp50/p95/p99を求める簡易ヒストグラム
+class LatencyHistogram {
+    private:
+        u32 m_samples[LATENCY_SAMPLE_COUNT];
+        u32 m_count;
+        u32 m_pos;
+        u32 m_total;
+
+    public:
+        LatencyHistogram() : m_count(0), m_pos(0), m_total(0) {}
+
+        void add(u32 value);
+        void clear() { m_count = 0; m_pos = 0; }
+
+        u32 get_count() { return m_count; }
+        u32 get_total() { return m_total; }
+        // 直近のサンプルのパーセンタイル値を求める(サンプルが無い場合は全て0)
+        void get_percentiles(u32* p50, u32* p95, u32* p99, u32* max);
+};
+
+/// @brief 入力(USBレポート受信時刻)から、VMが消費したフレーム、画面に表示されるまでの遅延を計測する
+class PlatformLatency {
+    private:
+        // 今回のフレームでVMに渡された入力の受信時刻
+        u64 m_pending[LATENCY_PENDING_MAX];
+        int m_pending_count;
+
+        // VMが消費したがまだ表示されていない入力の受信時刻
+        u64 m_inflight[LATENCY_PENDING_MAX];
+        int m_inflight_count;
+        // 最後に入力を消費したフレーム番号
+        u32 m_consumed_frame;
+
+        LatencyHistogram m_consume;     // 受信 → VMが消費
+        LatencyHistogram m_present;     // 受信 → 画面表示
+
+        u64 m_next_report_us;
+        u32 m_reported_total;
+
+    public:
+        PlatformLatency();
+
+        // 入力がVMに渡された(timestampはUSBハンドラで記録した時刻)
+        void input_dispatched(u64 timestamp);
+        // VMが1フレーム実行された(渡された入力を消費した)
+        void frame_run(u32 frame, u64 now);
+        // 画面が表示された
+        void frame_presented(u64 now);
+
+        // 一定間隔でシリアルに出力する
+        void update(u64 now);
+
+        // オーバーレイ表示用の文字列を作る
+        void format_consume(char* buffer, int size);
+        void format_present(char* buffer, int size);
+
+        u32 get_consumed_frame() { return m_consumed_frame; }
+};
+
+#endif
@@ -19,6 +19,8 @@
 
 #include "EmuController.h"
 #include "PlatformMenu.h"
+#include "PlatformTrace.h"
+#include "PlatformBootCache.h"
 #include "FBConsole.hpp"
 
 #include <circle/logger.h>
@@ -47,6 +49,9 @@ PlatformMenu::PlatformMenu(EmuController* emulator)
     m_selected_index = 0;
     m_visible = false;
     m_capturing_keys = false;
+    m_menu_redraw = true;
+    m_drawn_parent = -1;
+    m_drawn_selected = 0;
     
     // キーリピート用の変数を初期化
     m_key_pressed = 0;
@@ -56,17 +61,21 @@ PlatformMenu::PlatformMenu(EmuController* emulator)
     // Initialize arrays
     memset(m_menu_items, 0, sizeof(m_menu_items));
     memset(m_current_menu_path, 0, sizeof(m_current_menu_path));
+    m_string_pool[0] = '\0';
+    m_string_pool_size = 1;
+    m_string_pool_overflow = false;
+    m_root_first_child = 0;
+    m_root_num_children = 0;
     
     // ファイルブラウザの初期化
     memset(&m_file_browser, 0, sizeof(m_file_browser));
     m_file_browser.browser_active = false;
     m_file_browser.current_page = 0;
-    m_file_browser.entry_count = 0;
+    m_file_browser.index = nullptr;
     m_file_browser.selected_index = 0;
     m_file_browser.page_count = 0;
     m_file_browser.target_menu_index = -1;
     m_file_browser.current_dir[0] = '\0';
-    m_file_browser.cache_start_index = 0;
     m_file_browser.total_entries = 0;
     m_file_browser.has_parent_dir = false;
 }
@@ -92,8 +101,20 @@ bool PlatformMenu::initialize(EmuController* emulator, PlatformScreen* screen)
     // このタイミングで確実にconfigは拾えるはず
     this->m_config = emulator->get_platform_config();
     
+    // 解析済みのメニューがキャッシュにあれば、menu.cfgを読まずに使う
+    PlatformBootCache* boot_cache = m_config ? m_config->get_boot_cache() : nullptr;
+    if (boot_cache && restore_menu_tree(boot_cache)) {
+        return true;
+    }
+
     // Load menu configuration
-    return load_menu_file("menu.cfg");
+    if (!load_menu_file("menu.cfg")) {
+        return false;
+    }
+    if (boot_cache) {
+        store_menu_tree(boot_cache);
+    }
+    return true;
 }
 
 void PlatformMenu::update_draw_buffer()
@@ -122,6 +143,9 @@ void PlatformMenu::update_draw_buffer()
 
     // 上下40ドット分のヘッダーとフッターを引いた分を表示する
     m_files_per_page = (height - 40 - 40) / 16;
+
+    // 新しいバッファには何も描かれていない
+    m_menu_redraw = true;
 }
 
 // Toggle menu visibility
@@ -149,8 +173,12 @@ void PlatformMenu::toggle_menu()
         m_is_repeating = false;
 
         // 初回描画(メニューはキーを押した時しか描画しないため、ここで描画)
+        m_menu_redraw = true;
         draw_menu();
     } else {
+        // 読み込み中のディレクトリがあれば中断する
+        m_dir_cache.cancel_scan();
+        
         // When hiding menu, save the config
         m_emulator->update_config();
         m_emulator->save_config();
@@ -160,66 +188,27 @@ void PlatformMenu::toggle_menu()
 // カーソル位置を調整（セパレーターの上にカーソルがある場合は移動）
 void PlatformMenu::adjust_cursor_position()
 {
-    int current_parent = (m_current_depth > 0) ? m_current_menu_path[m_current_depth - 1] : -1;
-    int items_in_level = 0;
-    
+    int current_parent = get_current_parent();
+    int items_in_level = get_child_count(current_parent);
+
     // 現在のカーソル位置にあるアイテムを特定
-    int count = 0;
-    int item_index = -1;
-    for (int i = 0; i < m_num_items; i++) {
-        if (m_menu_items[i].parent_index == current_parent) {
-            if (count == m_selected_index) {
-                item_index = i;
-                break;
-            }
-            count++;
-            items_in_level++;
-        }
-    }
-    
+    int item_index = get_child_item(current_parent, m_selected_index);
+
     // セパレーターの場合は次の非セパレーター項目を探す
     if (item_index >= 0 && m_menu_items[item_index].type == MENU_TYPE_SEPARATOR) {
         // まず下方向に探す
-        int next_index = m_selected_index;
-        bool found = false;
-        
-        while (next_index < items_in_level - 1) {
-            next_index++;
-            count = 0;
-            for (int i = 0; i < m_num_items; i++) {
-                if (m_menu_items[i].parent_index == current_parent) {
-                    if (count == next_index) {
-                        if (m_menu_items[i].type != MENU_TYPE_SEPARATOR) {
-                            m_selected_index = next_index;
-                            found = true;
-                        }
-                        break;
-                    }
-                    count++;
-                }
+        for (int next_index = m_selected_index + 1; next_index < items_in_level; next_index++) {
+            if (m_menu_items[get_child_item(current_parent, next_index)].type != MENU_TYPE_SEPARATOR) {
+                m_selected_index = next_index;
+                return;
             }
-            if (found) break;
         }
-        
+
         // 下に見つからなければ上方向に探す
-        if (!found) {
-            int prev_index = m_selected_index;
-            while (prev_index > 0) {
-                prev_index--;
-                count = 0;
-                for (int i = 0; i < m_num_items; i++) {
-                    if (m_menu_items[i].parent_index == current_parent) {
-                        if (count == prev_index) {
-                            if (m_menu_items[i].type != MENU_TYPE_SEPARATOR) {
-                                m_selected_index = prev_index;
-                                found = true;
-                            }
-                            break;
-                        }
-                        count++;
-                    }
-                }
-                if (found) break;
+        for (int prev_index = m_selected_index - 1; prev_index >= 0; prev_index--) {
+            if (m_menu_items[get_child_item(current_parent, prev_index)].type != MENU_TYPE_SEPARATOR) {
+                m_selected_index = prev_index;
+                return;
             }
         }
     }
@@ -264,9 +253,19 @@ void PlatformMenu::draw()
     // ファイルブラウザのアクティブ状態が変化したらtrueにする(描画される)
     browser_changed = m_file_browser.browser_active != browser_pre_active;
     browser_pre_active = m_file_browser.browser_active;
+    if (browser_changed) {
+        // ブラウザで描き換えられているのでメニューは全体を描き直す
+        m_menu_redraw = true;
+    }
+    
+    // ディレクトリの読み込みを少し進める(進んだら描画する)
+    bool scan_updated = update_dir_scan();
+    
+    // メニューの描き直しはブラウザを閉じている時だけ
+    bool menu_redraw = m_menu_redraw && !m_file_browser.browser_active;
     
     // キーリピート処理
-    if (m_key_pressed || browser_changed) {
+    if (m_key_pressed || browser_changed || scan_updated || menu_redraw) {
         uint64_t current_time = CTimer::GetClockTicks64() / 1000; // ミリ秒単位の時間を取得
         
         if(m_key_pressed) {
@@ -310,8 +309,20 @@ void PlatformMenu::draw()
 // Internal method to draw the menu
 void PlatformMenu::draw_menu() 
 {
-    int width = m_fb_console->getWidth();
     int height = m_fb_console->getHeight();
+    int current_parent = get_current_parent();
+    
+    // 同じ階層で値も変わっていなければ、カーソルの移動分だけを描き直す
+    if (!m_menu_redraw && current_parent == m_drawn_parent) {
+        if (m_selected_index != m_drawn_selected) {
+            redraw_menu_cursor(m_drawn_selected, m_selected_index);
+            m_drawn_selected = m_selected_index;
+        }
+        return;
+    }
+    m_menu_redraw = false;
+    m_drawn_parent = current_parent;
+    m_drawn_selected = m_selected_index;
     
     // Draw background
     m_fb_console->clear(MENU_COLOR_BACKGROUND);
@@ -333,7 +344,7 @@ void PlatformMenu::draw_menu()
                 strcat(path, " > ");
             }
             memset(part, 0, sizeof(part));
-            strcpy(part, m_menu_items[menu_idx].display_name);
+            strcpy(part, get_string(m_menu_items[menu_idx].display_name));
             strcat(path, part);
         }
         
@@ -343,102 +354,10 @@ void PlatformMenu::draw_menu()
     
     // Draw menu items for current level
     int y_pos = 40;
-    int count = 0;
-    int current_parent = (m_current_depth > 0) ? m_current_menu_path[m_current_depth - 1] : -1;
+    int items_in_level = get_child_count(current_parent);
     
-    for (int i = 0; i < m_num_items; i++) {
-        if (m_menu_items[i].parent_index == current_parent) {
-            char item_text[MAX_STRING_LENGTH * 2];
-            memset(item_text, 0, sizeof(item_text));  // バッファを完全にクリアする
-            
-            // セパレーター処理
-            if (m_menu_items[i].type == MENU_TYPE_SEPARATOR) {
-                // セパレーターの場合は横線を描画する
-                int line_y = y_pos;
-                int line_start_x = 10;
-                int line_width = width - 20; // 画面幅から左右のマージンを引く
-                
-                // 横線を描画（白色）
-                m_fb_console->drawHLine(line_start_x, line_start_x + line_width, line_y, MENU_COLOR_TEXT);
-
-                // テキストは空にする（描画しない）
-                item_text[0] = '\0';
-            } else {
-                // 名前を設定
-                strcpy(item_text, m_menu_items[i].display_name);
-
-                char tmp_str[10];
-                
-                // タイプに基づいてインジケータを追加
-                if (m_menu_items[i].type == MENU_TYPE_SUBMENU) {
-                    strcat(item_text, " >");
-                } else if (m_menu_items[i].type == MENU_TYPE_BOOL) {
-                    // 設定から現在の値を取得
-                    bool value = get_config_bool(m_menu_items[i].config_name);
-                    strcat(item_text, value ? ": ON" : ": OFF");
-                } else if (m_menu_items[i].type == MENU_TYPE_INT_SELECT) {
-                    // 同じ値の場合「V」を表示
-                    bool is_same;
-                    int config_value;
-                    int value = get_config_int(m_menu_items[i].config_name, &config_value, &is_same);
-                    sprintf(item_text, "%s%s", is_same ? "[X] " : "[ ] ", m_menu_items[i].display_name);
-                } else if (m_menu_items[i].type == MENU_TYPE_INT) {
-                    // 値をそのまま表示
-                    bool is_same;
-                    int config_value;
-                    int value = get_config_int(m_menu_items[i].config_name, &config_value, &is_same);
-                    sprintf(tmp_str, ": %d", value);
-                    strcat(item_text, tmp_str);
-                }
-            }
-            
-            // 選択項目をハイライト
-            FBConsoleColor text_color = (count == m_selected_index) ? MENU_COLOR_SELECTED : MENU_COLOR_TEXT;
-            
-            // メニュー項目を描画 (セパレーターの場合は既に線を描画済みなのでスキップ)
-            if (m_menu_items[i].type != MENU_TYPE_SEPARATOR) {
-                m_fb_console->drawString(item_text, 20, y_pos, text_color, MENU_COLOR_BACKGROUND, false);
-            }
-            
-            // FILE型項目の場合、下に現在のファイルパスを表示
-            if (m_menu_items[i].type == MENU_TYPE_FILE) {
-                char file_path[MAX_STRING_LENGTH];
-                memset(file_path, 0, sizeof(file_path));  // バッファを完全にクリアする
-                
-                // 設定から現在のファイルパスを取得
-                strcpy(file_path, get_config_string(m_menu_items[i].config_name));
-                
-                // テキストオーバーフローを避けるために最大幅を計算
-                int max_width = width - 50;  // マージンを残す
-                
-                // 必要ならパスを切り詰める（単純な方法）
-                if (strlen(file_path) > max_width / 8) {  // 適合する文字数の大まかな見積もり
-                    file_path[max_width / 8 - 3] = '.';
-                    file_path[max_width / 8 - 2] = '.';
-                    file_path[max_width / 8 - 1] = '.';
-                    file_path[max_width / 8] = '\0';
-                }
-                
-                // ファイルが挿入されていない場合のメッセージを表示
-                if (file_path[0] == '\0') {
-                    strcpy(file_path, "< Not Inserted >");
-                    m_fb_console->drawString(file_path, 40, y_pos + 12, MENU_COLOR_VALUE, MENU_COLOR_BACKGROUND, false);
-                } else {
-                    m_fb_console->drawString(file_path, 40, y_pos + 12, MENU_COLOR_TEXT, MENU_COLOR_BACKGROUND, false);
-                }
-                
-                // 追加の行を考慮して次の項目のy位置を調整
-                y_pos += 12;
-            }
-            
-            // セパレーターの場合は高さを少し小さくする（通常アイテムの約2/3）
-            if (m_menu_items[i].type == MENU_TYPE_SEPARATOR) {
-                y_pos += 10; // 通常の16の代わりに10にする
-            } else {
-                y_pos += 16;
-            }
-            count++;
-        }
+    for (int count = 0; count < items_in_level; count++) {
+        y_pos = draw_menu_item(count, y_pos);
     }
     
     // Draw navigation help
@@ -446,39 +365,139 @@ void PlatformMenu::draw_menu()
     m_fb_console->drawString(navigation_help, m_fb_console->getWidth() / 2 - strlen(navigation_help) * 8 / 2, height - 20, MENU_COLOR_TEXT, MENU_COLOR_BACKGROUND, false);
 }
 
-// Handle keyboard input
-void PlatformMenu::handle_key_input(int key) 
+// 階層内のposition番目の項目をy_posに描画し、次の項目のy位置を返す
+int PlatformMenu::draw_menu_item(int position, int y_pos)
 {
-    int current_parent = (m_current_depth > 0) ? m_current_menu_path[m_current_depth - 1] : -1;
-    int items_in_level = 0;
+    int width = m_fb_console->getWidth();
+    int i = get_child_item(get_current_parent(), position);
     
-    // Count items in current level
-    for (int i = 0; i < m_num_items; i++) {
-        if (m_menu_items[i].parent_index == current_parent) {
-            items_in_level++;
+    char item_text[MAX_STRING_LENGTH * 2];
+    memset(item_text, 0, sizeof(item_text));  // バッファを完全にクリアする
+    
+    // セパレーター処理
+    if (m_menu_items[i].type == MENU_TYPE_SEPARATOR) {
+        // セパレーターの場合は横線を描画する
+        int line_y = y_pos;
+        int line_start_x = 10;
+        int line_width = width - 20; // 画面幅から左右のマージンを引く
+        
+        // 横線を描画（白色）
+        m_fb_console->drawHLine(line_start_x, line_start_x + line_width, line_y, MENU_COLOR_TEXT);
+
+        // テキストは空にする（描画しない）
+        item_text[0] = '\0';
+    } else {
+        // 名前を設定
+        strcpy(item_text, get_string(m_menu_items[i].display_name));
+
+        char tmp_str[10];
+        
+        // タイプに基づいてインジケータを追加
+        if (m_menu_items[i].type == MENU_TYPE_SUBMENU) {
+            strcat(item_text, " >");
+        } else if (m_menu_items[i].type == MENU_TYPE_BOOL) {
+            // 設定から現在の値を取得
+            bool value = get_config_bool(get_string(m_menu_items[i].config_name));
+            strcat(item_text, value ? ": ON" : ": OFF");
+        } else if (m_menu_items[i].type == MENU_TYPE_INT_SELECT) {
+            // 同じ値の場合「V」を表示
+            bool is_same;
+            int config_value;
+            int value = get_config_int(get_string(m_menu_items[i].config_name), &config_value, &is_same);
+            sprintf(item_text, "%s%s", is_same ? "[X] " : "[ ] ", get_string(m_menu_items[i].display_name));
+        } else if (m_menu_items[i].type == MENU_TYPE_INT) {
+            // 値をそのまま表示
+            bool is_same;
+            int config_value;
+            int value = get_config_int(get_string(m_menu_items[i].config_name), &config_value, &is_same);
+            sprintf(tmp_str, ": %d", value);
+            strcat(item_text, tmp_str);
         }
     }
     
+    // 選択項目をハイライト
+    FBConsoleColor text_color = (position == m_selected_index) ? MENU_COLOR_SELECTED : MENU_COLOR_TEXT;
+    
+    // メニュー項目を描画 (セパレーターの場合は既に線を描画済みなのでスキップ)
+    if (m_menu_items[i].type != MENU_TYPE_SEPARATOR) {
+        m_fb_console->drawString(item_text, 20, y_pos, text_color, MENU_COLOR_BACKGROUND, false);
+    }
+    
+    // FILE型項目の場合、下に現在のファイルパスを表示
+    if (m_menu_items[i].type == MENU_TYPE_FILE) {
+        char file_path[MAX_STRING_LENGTH];
+        memset(file_path, 0, sizeof(file_path));  // バッファを完全にクリアする
+        
+        // 設定から現在のファイルパスを取得
+        strcpy(file_path, get_config_string(get_string(m_menu_items[i].config_name)));
+        
+        // テキストオーバーフローを避けるために最大幅を計算
+        int max_width = width - 50;  // マージンを残す
+        
+        // 必要ならパスを切り詰める（単純な方法）
+        if (strlen(file_path) > max_width / 8) {  // 適合する文字数の大まかな見積もり
+            file_path[max_width / 8 - 3] = '.';
+            file_path[max_width / 8 - 2] = '.';
+            file_path[max_width / 8 - 1] = '.';
+            file_path[max_width / 8] = '\0';
+        }
+        
+        // ファイルが挿入されていない場合のメッセージを表示
+        if (file_path[0] == '\0') {
+            strcpy(file_path, "< Not Inserted >");
+            m_fb_console->drawString(file_path, 40, y_pos + 12, MENU_COLOR_VALUE, MENU_COLOR_BACKGROUND, false);
+        } else {
+            m_fb_console->drawString(file_path, 40, y_pos + 12, MENU_COLOR_TEXT, MENU_COLOR_BACKGROUND, false);
+        }
+    }
+    
+    return y_pos + get_menu_item_height(i);
+}
+
+// 項目の表示上の高さ
+int PlatformMenu::get_menu_item_height(int item_index)
+{
+    switch (m_menu_items[item_index].type) {
+        case MENU_TYPE_SEPARATOR:
+            // セパレーターの場合は高さを少し小さくする（通常アイテムの約2/3）
+            return 10;
+        case MENU_TYPE_FILE:
+            // FILE型項目は下に現在のファイルパスを表示する分だけ高くなる
+            return 16 + 12;
+        default:
+            return 16;
+    }
+}
+
+// カーソルが動いただけなので、前後の項目だけを描き直す
+void PlatformMenu::redraw_menu_cursor(int old_position, int new_position)
+{
+    int current_parent = get_current_parent();
+    int items_in_level = get_child_count(current_parent);
+    int y_pos = 40;
+    
+    for (int position = 0; position < items_in_level; position++) {
+        if (position == old_position || position == new_position) {
+            draw_menu_item(position, y_pos);
+        }
+        y_pos += get_menu_item_height(get_child_item(current_parent, position));
+    }
+}
+
+// Handle keyboard input
+void PlatformMenu::handle_key_input(int key) 
+{
+    int current_parent = get_current_parent();
+    int items_in_level = get_child_count(current_parent);
+    
     // Handle different keys
     switch (key) {
         case MENU_KEY_UP:
             if (m_selected_index > 0) {
                 m_selected_index--;
                 
-                // セパレーターの上にカーソルがある場合は、さらに上に移動
-                int count = 0;
-                int item_index = -1;
-                for (int i = 0; i < m_num_items; i++) {
-                    if (m_menu_items[i].parent_index == current_parent) {
-                        if (count == m_selected_index) {
-                            item_index = i;
-                            break;
-                        }
-                        count++;
-                    }
-                }
-                
                 // セパレーターならさらに上へ
+                int item_index = get_child_item(current_parent, m_selected_index);
                 if (item_index >= 0 && m_menu_items[item_index].type == MENU_TYPE_SEPARATOR) {
                     if (m_selected_index > 0) {
                         m_selected_index--;
@@ -494,20 +513,8 @@ void PlatformMenu::handle_key_input(int key)
             if (m_selected_index < items_in_level - 1) {
                 m_selected_index++;
                 
-                // セパレーターの上にカーソルがある場合は、さらに下に移動
-                int count = 0;
-                int item_index = -1;
-                for (int i = 0; i < m_num_items; i++) {
-                    if (m_menu_items[i].parent_index == current_parent) {
-                        if (count == m_selected_index) {
-                            item_index = i;
-                            break;
-                        }
-                        count++;
-                    }
-                }
-                
                 // セパレーターならさらに下へ
+                int item_index = get_child_item(current_parent, m_selected_index);
                 if (item_index >= 0 && m_menu_items[item_index].type == MENU_TYPE_SEPARATOR) {
                     if (m_selected_index < items_in_level - 1) {
                         m_selected_index++;
@@ -530,16 +537,7 @@ void PlatformMenu::handle_key_input(int key)
                 m_selected_index = 0;
                 
                 // 初期表示時にセパレーターを選択しないように調整
-                int count = 0;
-                for (int i = 0; i < m_num_items; i++) {
-                    if (m_menu_items[i].parent_index == current_parent) {
-                        if (count == m_selected_index && m_menu_items[i].type == MENU_TYPE_SEPARATOR) {
-                            // 最初の項目がセパレーターなら次の項目へ
-                            m_selected_index++;
-                        }
-                        count++;
-                    }
-                }
+                adjust_cursor_position();
             } else {
                 // トップレベルでは何もしない (ESCキーを無視)
                 // toggle_menu()を呼ぶとシステム全体のmenu_enabledと不整合が生じるため
@@ -556,20 +554,8 @@ void PlatformMenu::handle_key_input(int key)
 // Handle selection of menu item
 void PlatformMenu::handle_selection() 
 {
-    int current_parent = (m_current_depth > 0) ? m_current_menu_path[m_current_depth - 1] : -1;
-    int count = 0;
-    int selected_item_index = -1;
-    
     // Find the actual index of the selected item
-    for (int i = 0; i < m_num_items; i++) {
-        if (m_menu_items[i].parent_index == current_parent) {
-            if (count == m_selected_index) {
-                selected_item_index = i;
-                break;
-            }
-            count++;
-        }
-    }
+    int selected_item_index = get_child_item(get_current_parent(), m_selected_index);
     
     if (selected_item_index < 0) {
         return;
@@ -606,8 +592,8 @@ void PlatformMenu::handle_selection()
                     logger->Write("PlatformMenu", LogNotice, "file selection started: index=%d, type=%d, display_name=%s, config_name=%s", 
                                selected_item_index, 
                                m_menu_items[selected_item_index].type,
-                               m_menu_items[selected_item_index].display_name,
-                               m_menu_items[selected_item_index].config_name);
+                               get_string(m_menu_items[selected_item_index].display_name),
+                               get_string(m_menu_items[selected_item_index].config_name));
                 }
                 handle_file_selection(selected_item_index);
             }
@@ -615,9 +601,12 @@ void PlatformMenu::handle_selection()
             
         case MENU_TYPE_ACTION:
             // Execute action
-            handle_action(m_menu_items[selected_item_index].action);
+            handle_action(get_string(m_menu_items[selected_item_index].action));
             break;
     }
+    
+    // 値が変わった可能性があるので全体を描き直す
+    m_menu_redraw = true;
 }
 
 /* ───────────── 共通ユーティリティ ───────────── */
@@ -629,49 +618,174 @@ static inline void skip_ws(char **p)
 static inline int safe_copy(char *dst, const char *src, size_t max) /* NUL 終端保証 */
 {
     size_t n = strlen(src);
+    if (n >= max) n = max - 1;
     memcpy(dst, src, n);
     dst[n] = '\0';
     return (int)n;
 }
 
-/* 追加：1 コンポーネントだけを安全にコピー */
-static inline void copy_component(char *dst, const char *src, size_t max)
+/* 文字列をプールに登録してオフセットを返す(同じ文字列があればそれを使う) */
+u16 PlatformMenu::intern_string(const char *str, size_t length)
+{
+    if (length == 0) return 0;
+    if (length >= MAX_STRING_LENGTH) length = MAX_STRING_LENGTH - 1;
+
+    for (int offset = 1; offset < m_string_pool_size; offset += strlen(m_string_pool + offset) + 1) {
+        if (strncmp(m_string_pool + offset, str, length) == 0 && m_string_pool[offset + length] == '\0')
+            return (u16)offset;
+    }
+
+    if (m_string_pool_size + (int)length + 1 > MENU_STRING_POOL_SIZE) {
+        // 0(空文字列)を返すと別の名前どうしが同じとみなされるので、呼び出し元で読み込みを失敗にする
+        if (!m_string_pool_overflow) {
+            get_logger()->Write("PlatformMenu", LogError, "menu string pool overflow");
+        }
+        m_string_pool_overflow = true;
+        return 0;
+    }
+
+    const int offset = m_string_pool_size;
+    memcpy(m_string_pool + offset, str, length);
+    m_string_pool[offset + length] = '\0';
+    m_string_pool_size += length + 1;
+    return (u16)offset;
+}
+
+/* メニュー項目を追加してそのindexを返す(一杯なら-1) */
+int PlatformMenu::add_menu_item(int type, u16 display_name, u16 original_path, int parent)
 {
-    size_t len = strcspn(src, "/");          /* '/' か NUL までの長さ */
-    if (len >= max) len = max - 1;           /* オーバーフロー防止 */
-    memcpy(dst, src, len);
-    dst[len] = '\0';
+    if (m_num_items >= MAX_MENU_ITEMS) return -1;
+
+    const int idx = m_num_items++;
+    MenuItemInfo *mi = &m_menu_items[idx];
+    memset(mi, 0, sizeof(*mi));
+
+    mi->display_name  = display_name;
+    mi->original_path = original_path;
+    mi->type          = type;
+    mi->parent_index  = parent;
+    return idx;
 }
 
 /* path が既存 submenu ならその index、無ければ生成して返す */
-static int find_or_add_submenu(const char *full_path,
-                               const char *disp_name,
-                               int parent,
-                               MenuItemInfo *items,
-                               int *num)
+int PlatformMenu::find_or_add_submenu(const char *full_path,
+                                      const char *disp_name,
+                                      size_t disp_length,
+                                      int parent)
 {
-    for (int i = 0; i < *num; ++i)
-        if (items[i].type == MENU_TYPE_SUBMENU &&
-            strcmp(items[i].original_path, full_path) == 0)
+    const u16 path = intern_string(full_path, strlen(full_path));
+    for (int i = 0; i < m_num_items; ++i)
+        if (m_menu_items[i].type == MENU_TYPE_SUBMENU &&
+            m_menu_items[i].original_path == path)
             return i;
 
-    /* 生成 */
-    if (*num >= MAX_MENU_ITEMS) return -1;
+    return add_menu_item(MENU_TYPE_SUBMENU, intern_string(disp_name, disp_length), path, parent);
+}
 
-    const int idx = (*num)++;
-    MenuItemInfo *mi = &items[idx];
-    memset(mi, 0, sizeof(*mi));
+/* 親ごとに子のindexを連続して並べる(登録順を保つ) */
+void PlatformMenu::build_child_indices()
+{
+    int pos = 0;
 
-    copy_component(mi->display_name, disp_name, sizeof(mi->display_name));
-    safe_copy(mi->original_path, full_path, sizeof(mi->original_path));
-    mi->type         = MENU_TYPE_SUBMENU;
-    mi->parent_index = parent;
-    if (parent >= 0) {
-        if (items[parent].num_children == 0)
-            items[parent].first_child_index = idx;
-        items[parent].num_children++;
+    m_root_first_child = pos;
+    for (int i = 0; i < m_num_items; i++) {
+        if (m_menu_items[i].parent_index == -1) m_child_indices[pos++] = i;
     }
-    return idx;
+    m_root_num_children = pos - m_root_first_child;
+
+    for (int parent = 0; parent < m_num_items; parent++) {
+        MenuItemInfo *mi = &m_menu_items[parent];
+        mi->first_child_index = pos;
+        for (int i = 0; i < m_num_items; i++) {
+            if (m_menu_items[i].parent_index == parent) m_child_indices[pos++] = i;
+        }
+        mi->num_children = pos - mi->first_child_index;
+    }
+}
+
+// キャッシュに書き込むメニューの木の形(この後に項目、子のインデックス、文字列プールが続く)
+struct MenuTreeHeader {
+    u16 item_size;          // sizeof(MenuItemInfo)(構造体が変わったら使わない)
+    u16 num_items;
+    u16 root_first_child;
+    u16 root_num_children;
+    u32 string_pool_size;
+};
+
+bool PlatformMenu::restore_menu_tree(PlatformBootCache* boot_cache)
+{
+    u32 size = 0;
+    const u8* data = (const u8*)boot_cache->restore_menu(&size);
+    if (!data || size < sizeof(MenuTreeHeader)) {
+        return false;
+    }
+
+    MenuTreeHeader header;
+    memcpy(&header, data, sizeof(header));
+    u32 items_size = header.num_items * sizeof(MenuItemInfo);
+    u32 indices_size = header.num_items * sizeof(u16);
+    if (header.item_size != sizeof(MenuItemInfo) || header.num_items > MAX_MENU_ITEMS ||
+        header.string_pool_size == 0 || header.string_pool_size > MENU_STRING_POOL_SIZE ||
+        size != sizeof(header) + items_size + indices_size + header.string_pool_size) {
+        get_logger()->Write("PlatformMenu", LogNotice, "Cached menu tree does not match, parsing menu.cfg");
+        return false;
+    }
+
+    data += sizeof(header);
+    memcpy(m_menu_items, data, items_size);
+    data += items_size;
+    memcpy(m_child_indices, data, indices_size);
+    data += indices_size;
+    memcpy(m_string_pool, data, header.string_pool_size);
+
+    m_num_items = header.num_items;
+    m_root_first_child = header.root_first_child;
+    m_root_num_children = header.root_num_children;
+    m_string_pool_size = header.string_pool_size;
+
+    get_logger()->Write("PlatformMenu", LogNotice, "menu.cfg loaded from boot cache: items=%d, strings=%d bytes",
+                        m_num_items, m_string_pool_size);
+    return true;
+}
+
+void PlatformMenu::store_menu_tree(PlatformBootCache* boot_cache)
+{
+    MenuTreeHeader header;
+    header.item_size = sizeof(MenuItemInfo);
+    header.num_items = m_num_items;
+    header.root_first_child = m_root_first_child;
+    header.root_num_children = m_root_num_children;
+    header.string_pool_size = m_string_pool_size;
+
+    u32 items_size = m_num_items * sizeof(MenuItemInfo);
+    u32 indices_size = m_num_items * sizeof(u16);
+    u32 size = sizeof(header) + items_size + indices_size + m_string_pool_size;
+    u8* data = new u8[size];
+    u8* p = data;
+    memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+    memcpy(p, m_menu_items, items_size);
+    p += items_size;
+    memcpy(p, m_child_indices, indices_size);
+    p += indices_size;
+    memcpy(p, m_string_pool, m_string_pool_size);
+
+    boot_cache->store_menu(data, size);
+    delete[] data;
+}
+
+int PlatformMenu::get_child_count(int parent)
+{
+    return (parent < 0) ? m_root_num_children : m_menu_items[parent].num_children;
+}
+
+/* 階層内の position 番目の子の index (範囲外なら-1) */
+int PlatformMenu::get_child_item(int parent, int position)
+{
+    if (position < 0 || position >= get_child_count(parent)) return -1;
+
+    const int first = (parent < 0) ? m_root_first_child : m_menu_items[parent].first_child_index;
+    return m_child_indices[first + position];
 }
 
 /* ───────────── 本体 ───────────── */
@@ -739,21 +853,12 @@ void PlatformMenu::parse_menu_item(const char *line)
     if (type == MENU_TYPE_SEPARATOR) {
         // セパレーターは特別処理
         int  parent   = -1;
+        const u16 separator_name = intern_string("separator", 9);
         
         // パスが空の場合、トップレベルのセパレーターとして扱う
         if (p[0] == '\0') {
             // トップレベルのセパレーター
-            if (m_num_items >= MAX_MENU_ITEMS) return;
-            MenuItemInfo *mi = &m_menu_items[m_num_items];
-            memset(mi, 0, sizeof(*mi));
-            
-            strcpy(mi->display_name, "separator");
-            safe_copy(mi->original_path, "separator", sizeof(mi->original_path));
-            
-            mi->type = MENU_TYPE_SEPARATOR;
-            mi->parent_index = -1; // トップレベル
-            
-            m_num_items++;
+            if (add_menu_item(MENU_TYPE_SEPARATOR, separator_name, separator_name, -1) < 0) return;
             
             if (logger) {
                 logger->Write("PlatformMenu", LogNotice, "Added top-level separator at index %d", m_num_items - 1);
@@ -769,32 +874,17 @@ void PlatformMenu::parse_menu_item(const char *line)
             p[path_len - 1] = '\0';
             
             // 対応するサブメニューを探す
+            const u16 path = intern_string(p, path_len - 1);
             for (int i = 0; i < m_num_items; i++) {
                 if (m_menu_items[i].type == MENU_TYPE_SUBMENU && 
-                    strcmp(m_menu_items[i].original_path, p) == 0) {
+                    m_menu_items[i].original_path == path) {
                     parent = i;
                     break;
                 }
             }
             
             // サブメニュー内のセパレーターとして登録
-            if (m_num_items >= MAX_MENU_ITEMS) return;
-            MenuItemInfo *mi = &m_menu_items[m_num_items];
-            memset(mi, 0, sizeof(*mi));
-            
-            strcpy(mi->display_name, "separator");
-            safe_copy(mi->original_path, "separator", sizeof(mi->original_path));
-            
-            mi->type = MENU_TYPE_SEPARATOR;
-            mi->parent_index = parent;
-            
-            if (parent >= 0) {
-                if (m_menu_items[parent].num_children == 0)
-                    m_menu_items[parent].first_child_index = m_num_items;
-                m_menu_items[parent].num_children++;
-            }
-            
-            m_num_items++;
+            if (add_menu_item(MENU_TYPE_SEPARATOR, separator_name, separator_name, parent) < 0) return;
             
             if (logger) {
                 logger->Write("PlatformMenu", LogNotice, "Added separator in submenu '%s' at index %d", 
@@ -818,61 +908,46 @@ void PlatformMenu::parse_menu_item(const char *line)
         if (seg_len == 0) break;   /* "//" などは無視 */
 
         /* path_so_far = 既存 + "/" + seg */
-        if (path_so_far[0]) strncat(path_so_far, "/", sizeof(path_so_far) - 1);
+        if (path_so_far[0]) strncat(path_so_far, "/", sizeof(path_so_far) - strlen(path_so_far) - 1);
         strncat(path_so_far, seg, seg_len);
 
         if (!last) {
-            char seg_name[MAX_STRING_LENGTH];
-            safe_copy(seg_name, seg, seg_len + 1);
-            parent = find_or_add_submenu(path_so_far, seg_name, parent,
-                                         m_menu_items, &m_num_items);
+            parent = find_or_add_submenu(path_so_far, seg, seg_len, parent);
+            if (parent < 0) return;
             // display_nameを表示
             if (logger) {
-                logger->Write("PlatformMenu", LogNotice, "menu parsing(!last): display_name=%s", m_menu_items[parent].display_name);
+                logger->Write("PlatformMenu", LogNotice, "menu parsing(!last): display_name=%s", get_string(m_menu_items[parent].display_name));
             }
         } else {
             /* 5) leaf 自体を登録 --------------------------------------- */
-            if (m_num_items >= MAX_MENU_ITEMS) return;
-            MenuItemInfo *mi = &m_menu_items[m_num_items];
-            memset(mi, 0, sizeof(*mi));
-
-            copy_component(mi->display_name, seg, sizeof(mi->display_name));
-            safe_copy(mi->original_path, p, sizeof(mi->original_path));
+            const int idx = add_menu_item(type, intern_string(seg, seg_len), intern_string(p, strlen(p)), parent);
+            if (idx < 0) return;
+            MenuItemInfo *mi = &m_menu_items[idx];
 
             if (logger) {   
-                logger->Write("PlatformMenu", LogNotice, "menu parsing: original_path=%s", mi->original_path);
-            }
-
-            mi->type         = type;
-            mi->parent_index = parent;
-            if (parent >= 0) {
-                if (m_menu_items[parent].num_children == 0)
-                    m_menu_items[parent].first_child_index = m_num_items;
-                m_menu_items[parent].num_children++;
+                logger->Write("PlatformMenu", LogNotice, "menu parsing: original_path=%s", get_string(mi->original_path));
             }
 
             if (param) {
                 if (type == MENU_TYPE_BOOL || type == MENU_TYPE_FILE || type == MENU_TYPE_INT_SELECT || type == MENU_TYPE_INT)
-                    safe_copy(mi->config_name, param, sizeof(mi->config_name));
+                    mi->config_name = intern_string(param, strlen(param));
                 else if (type == MENU_TYPE_ACTION)
-                    safe_copy(mi->action, param, sizeof(mi->action));
+                    mi->action = intern_string(param, strlen(param));
             }
 
             if (type == MENU_TYPE_FILE) {
                 if (CLogger *lg = get_logger())
                     lg->Write("PlatformMenu", LogNotice,
                               "registered: idx=%d type=FILE name=%s cfg=%s path=%s",
-                              m_num_items, mi->display_name,
-                              mi->config_name, mi->original_path);
+                              idx, get_string(mi->display_name),
+                              get_string(mi->config_name), get_string(mi->original_path));
             } else if (type == MENU_TYPE_INT_SELECT) {
                 if (CLogger *lg = get_logger())
                     lg->Write("PlatformMenu", LogNotice,
                               "registered: idx=%d type=INT_SELECT name=%s cfg=%s path=%s",
-                              m_num_items, mi->display_name,
-                              mi->config_name, mi->original_path);
+                              idx, get_string(mi->display_name),
+                              get_string(mi->config_name), get_string(mi->original_path));
             }
-
-            m_num_items++;
             break;
         }
         seg = slash + 1;
@@ -892,6 +967,9 @@ bool PlatformMenu::load_menu_file(const char* filename)
     }
     
     m_num_items = 0;
+    m_string_pool[0] = '\0';
+    m_string_pool_size = 1;
+    m_string_pool_overflow = false;
     
     // Read and parse each line
     while (fgets(line, sizeof(line), fp) && m_num_items < MAX_MENU_ITEMS) {
@@ -906,21 +984,28 @@ bool PlatformMenu::load_menu_file(const char* filename)
     }
     
     fclose(fp);
+
+    // 文字列が入りきらなかった場合は、名前の比較ができないので使わない
+    if (m_string_pool_overflow) {
+        get_logger()->Write("PlatformMenu", LogError, "load_menu_file: %s has too many strings (pool %d bytes)",
+                            filename, MENU_STRING_POOL_SIZE);
+        m_num_items = 0;
+        m_root_first_child = 0;
+        m_root_num_children = 0;
+        return false;
+    }
     
     // サブメニュー階層の調整
     // 同じ階層に同じ名前のメニュー項目があれば修正
+    // (文字列はプール内で1つにまとめてあるのでオフセットの比較で済む)
     for (int i = 0; i < m_num_items; i++) {
         for (int j = 0; j < m_num_items; j++) {
             if (i != j && 
                 m_menu_items[i].parent_index == m_menu_items[j].parent_index && 
-                strcmp(m_menu_items[i].display_name, m_menu_items[j].display_name) == 0) {
+                m_menu_items[i].display_name == m_menu_items[j].display_name) {
                 
                 // サブメニューの場合
                 if (m_menu_items[i].type == MENU_TYPE_SUBMENU && m_menu_items[j].type == MENU_TYPE_SUBMENU) {
-                    // original_pathを比較して、より適切な親を選択
-                    char* i_last_slash = strrchr(m_menu_items[i].original_path, '/');
-                    char* j_last_slash = strrchr(m_menu_items[j].original_path, '/');
-                    
                     // 両方のサブメニューに子アイテムがある場合、片方の子を他方に移動
                     for (int k = 0; k < m_num_items; k++) {
                         if (m_menu_items[k].parent_index == j) {
@@ -932,6 +1017,12 @@ bool PlatformMenu::load_menu_file(const char* filename)
         }
     }
     
+    // 階層ごとの子の並びを作っておく(カーソル移動や描画で走査しないように)
+    build_child_indices();
+
+    get_logger()->Write("PlatformMenu", LogNotice, "load_menu_file: items=%d, strings=%d bytes, tree=%d bytes",
+                        m_num_items, m_string_pool_size, (int)(sizeof(m_menu_items) + sizeof(m_child_indices)));
+    
     return true;
 }
 
@@ -947,8 +1038,8 @@ void PlatformMenu::toggle_bool_value(int item_index)
     }
 
     // iniではなくconfigをいじる(これでsave_configすればiniが書き変わる)
-    bool current_value = get_config_bool(m_menu_items[item_index].config_name);
-    apply_config_bool(m_menu_items[item_index].config_name, !current_value);
+    bool current_value = get_config_bool(get_string(m_menu_items[item_index].config_name));
+    apply_config_bool(get_string(m_menu_items[item_index].config_name), !current_value);
 }
 
 // Set int select value
@@ -965,13 +1056,13 @@ void PlatformMenu::set_int_select_value(int item_index)
     // 選択された値を取得
     int config_value;
     bool is_same;
-    int selected_value = get_config_int(m_menu_items[item_index].config_name, &config_value, &is_same);
+    int selected_value = get_config_int(get_string(m_menu_items[item_index].config_name), &config_value, &is_same);
 
     // config_valueで得られた値をそのまま値として設定する
-    apply_config_int(m_menu_items[item_index].config_name, config_value);
+    apply_config_int(get_string(m_menu_items[item_index].config_name), config_value);
 
     // ストレッチモードが変わったら実行してやる
-    if(strncmp(m_menu_items[item_index].config_name, "display_stretch", 15) == 0) {
+    if(strncmp(get_string(m_menu_items[item_index].config_name), "display_stretch", 15) == 0) {
         m_emulator->set_host_window_size(-1, -1, false);
     }
 }
@@ -990,17 +1081,19 @@ void PlatformMenu::handle_file_selection(int item_index)
     CLogger* logger = get_logger();
     if (logger) {
         logger->Write("PlatformMenu", LogNotice, "file selection started: %s (index: %d, config_name: %s)", 
-                     m_menu_items[item_index].display_name, 
+                     get_string(m_menu_items[item_index].display_name), 
                      item_index, 
-                     m_menu_items[item_index].config_name);
+                     get_string(m_menu_items[item_index].config_name));
     }
     
     // ファイルブラウザを初期化して表示
-    // menu_items[item_index].original_pathにCMTがあれば「tapes」フォルダ、そうでなれば「disks」フォルダをルートにする
+    // menu_items[item_index].original_pathにCMTがあれば「tapes」フォルダ、AutoKeyなら「texts」フォルダ、そうでなれば「disks」フォルダをルートにする
     const char* root_dir = "/disks";
-    if (strstr(m_menu_items[item_index].original_path, "CMT") != NULL) {
+    if (strstr(get_string(m_menu_items[item_index].original_path), "CMT") != NULL) {
         root_dir = "/tapes";
-    }   
+    } else if (strstr(get_string(m_menu_items[item_index].original_path), "AutoKey") != NULL) {
+        root_dir = "/texts";
+    }
     bool result = init_file_browser(root_dir, item_index);
 
     
@@ -1025,7 +1118,6 @@ bool PlatformMenu::init_file_browser(const char* path, int menu_index)
     m_file_browser.current_page = 0;
     m_file_browser.selected_index = 0;
     m_file_browser.target_menu_index = menu_index;
-    m_file_browser.cache_start_index = 0;
     m_file_browser.total_entries = 0;
     m_file_browser.has_parent_dir = false;
     
@@ -1067,161 +1159,105 @@ bool PlatformMenu::load_file_entries(const char* path)
         }
     }
     
-    DIR dir;
-    FILINFO temp_info;
-    FRESULT fr;
-    
-    // ディレクトリをオープン
-    fr = f_opendir(&dir, path);
-    if (fr != FR_OK) {
+    // ディレクトリの内容はインデックスから引く(最近開いたものは読み直さない)
+    // 無ければ読み込みを始め、drawのたびに少しずつ進める
+    PlatformDirIndex* index = m_dir_cache.request(path);
+    if (!index) {
         if (logger) {
-            logger->Write("PlatformMenu", LogError, "directory opening failed: %s, error code %d", path, (int)fr);
+            logger->Write("PlatformMenu", LogError, "directory reading failed: %s", path);
         }
         return false;
     }
+    m_file_browser.index = index;
     
-    // 新しいディレクトリに移動した場合は、すべてのエントリを数え直す
-    if (m_file_browser.total_entries <= 0 || strcmp(path, m_file_browser.current_dir) != 0) {
-        int total_count = 0;
-        
-        // ルートディレクトリ、または初期ルートでなければ親ディレクトリへのリンクを追加
-        if (strcmp(path, "/") != 0 && 
-           (m_file_browser.initial_root_dir[0] == '\0' || strcmp(path, m_file_browser.initial_root_dir) != 0)) {
-            m_file_browser.has_parent_dir = true;
-            total_count++; // ".." 用に1カウント増やす
-        } else {
-            m_file_browser.has_parent_dir = false;
-        }
-        
-        for (;;) {
-            fr = f_readdir(&dir, &temp_info);
-            if (fr != FR_OK || temp_info.fname[0] == 0) {
-                break;
-            }
-            
-            // ドットで始まるファイルはスキップ（隠しファイル）
-            if (temp_info.fname[0] == '.' && strcmp(temp_info.fname, "..") != 0) {
-                continue;
-            }
-            
-            total_count++;
-        }
-        
-        // 合計エントリ数を設定
-        m_file_browser.total_entries = total_count;
-        
-        // ページ数を計算
-        m_file_browser.page_count = (m_file_browser.total_entries + m_files_per_page - 1) / m_files_per_page;
-        if (m_file_browser.page_count < 1) {
-            m_file_browser.page_count = 1; // 少なくとも1ページ
-        }
-        
-        // 新しいディレクトリに移動した場合はキャッシュを先頭からにする
-        m_file_browser.cache_start_index = 0;
-        
-        // ディレクトリを巻き戻す
-        f_closedir(&dir);
-        fr = f_opendir(&dir, path);
-        if (fr != FR_OK) {
-            if (logger) {
-                logger->Write("PlatformMenu", LogError, "directory reopening failed: %s", path);
-            }
-            return false;
-        }
-    }
-    
-    // キャッシュする範囲を確認
-    int display_start = m_file_browser.cache_start_index;
-    int display_end = display_start + MAX_FILE_ENTRIES;
-    
-    // 合計エントリ数より大きい場合は調整
-    if (display_end > m_file_browser.total_entries) {
-        display_end = m_file_browser.total_entries;
+    // ルートディレクトリ、または初期ルートでなければ親ディレクトリへのリンクを追加
+    if (strcmp(path, "/") != 0 && 
+       (m_file_browser.initial_root_dir[0] == '\0' || strcmp(path, m_file_browser.initial_root_dir) != 0)) {
+        m_file_browser.has_parent_dir = true;
+    } else {
+        m_file_browser.has_parent_dir = false;
     }
     
-    // 実際にキャッシュするエントリ数
-    m_file_browser.entry_count = display_end - display_start;
+    // 絞り込みを解除して合計エントリ数とページ数を求める
+    m_file_filter.reset(index);
+    update_file_list();
     
     if (logger) {
-        logger->Write("PlatformMenu", LogNotice, "cache range: %d-%d (total %d entries)", 
-                     display_start, display_end - 1, m_file_browser.total_entries);
-    }
-    
-    // エントリの読み込み
-    int real_index = 0;  // 実際のファイルシステム上のインデックス
-    int cache_index = 0; // キャッシュ配列内のインデックス
-    
-    // 親ディレクトリのエントリを追加（必要な場合）
-    if (m_file_browser.has_parent_dir) {
-        // キャッシュ範囲に含まれる場合のみ追加
-        if (display_start == 0) {
-            // キャッシュの先頭に親ディレクトリのエントリを追加
-            FILINFO* fno = &m_file_browser.entries[cache_index++];
-            strcpy(fno->fname, "..");
-            fno->fattrib = AM_DIR;
-            fno->fsize = 0;
+        if (index->is_scanning()) {
+            logger->Write("PlatformMenu", LogNotice, "directory scanning started: %s", path);
+        } else {
+            logger->Write("PlatformMenu", LogNotice, "file entry reading completed: total %d entries", 
+                          m_file_browser.total_entries);
         }
-        real_index = 1;  // 実際のファイルシステム上では親ディレクトリの次から
     }
     
-    // 表示開始位置までスキップ
-    int skip_count = 0;
-    if (m_file_browser.has_parent_dir) {
-        skip_count = (display_start == 0) ? 0 : display_start - 1;
-    } else {
-        skip_count = display_start;
+    return true;
+}
+
+// 読み込み中のディレクトリを一定時間だけ進める(進めた場合はtrue)
+bool PlatformMenu::update_dir_scan()
+{
+    if (!m_file_browser.browser_active || !is_dir_scanning()) {
+        return false;
     }
     
-    for (int i = 0; i < skip_count; i++) {
-        fr = f_readdir(&dir, &temp_info);
-        if (fr != FR_OK || temp_info.fname[0] == 0) {
-            break;
-        }
-        
-        // ドットファイルをスキップ
-        while (temp_info.fname[0] == '.' && strcmp(temp_info.fname, "..") != 0) {
-            fr = f_readdir(&dir, &temp_info);
-            if (fr != FR_OK || temp_info.fname[0] == 0) {
-                break;
-            }
-        }
-        
-        real_index++;
-    }
+    TRACE_SCOPE("dir scan");
+    PlatformDirIndex* index = m_file_browser.index;
+    uint64_t start_time = CTimer::GetClockTicks64();
+    DirScanResult result;
+    do {
+        result = index->scan(DIR_SCAN_ENTRIES_PER_STEP);
+    } while (result == DIR_SCAN_CONTINUE && CTimer::GetClockTicks64() - start_time < DIR_SCAN_SLICE_US);
     
-    // 必要な分だけエントリを読み込む
-    while (cache_index < m_file_browser.entry_count) {
-        // 親ディレクトリのエントリが先頭にある場合はスキップ
-        if (m_file_browser.has_parent_dir && display_start == 0 && cache_index == 0) {
-            cache_index++;
-            continue;
-        }
-        
-        FILINFO* fno = &m_file_browser.entries[cache_index];
-        
-        fr = f_readdir(&dir, fno);
-        if (fr != FR_OK || fno->fname[0] == 0) {
-            break;
+    if (result != DIR_SCAN_CONTINUE) {
+        if (result == DIR_SCAN_ERROR) {
+            get_logger()->Write("PlatformMenu", LogError, "directory reading failed: %s", m_file_browser.current_dir);
         }
-        
-        // ドットで始まるファイルはスキップ（隠しファイル）
-        if (fno->fname[0] == '.' && strcmp(fno->fname, "..") != 0) {
-            continue;
-        }
-        
-        cache_index++;
-        real_index++;
+        // 読み終わったので一覧を表示する
+        m_file_filter.reset(index);
+        update_file_list();
     }
+    return true;
+}
+
+// 表示する項目数が変わったので合計エントリ数とページ数を求め直す
+void PlatformMenu::update_file_list()
+{
+    // 合計エントリ数を設定（".." 用に1カウント増やす、絞り込み中は出さない）
+    // 読み込み中は並びが決まっていないので".."だけにする
+    int count = is_dir_scanning() ? 0 : m_file_filter.get_count();
+    m_file_browser.total_entries = count + (has_parent_entry() ? 1 : 0);
     
-    // ディレクトリクローズ
-    f_closedir(&dir);
+    // ページ数を計算
+    m_file_browser.page_count = (m_file_browser.total_entries + m_files_per_page - 1) / m_files_per_page;
+    if (m_file_browser.page_count < 1) {
+        m_file_browser.page_count = 1; // 少なくとも1ページ
+    }
     
-    if (logger) {
-        logger->Write("PlatformMenu", LogNotice, "file entry reading completed: cache %d entries, total %d entries", 
-                      m_file_browser.entry_count, m_file_browser.total_entries);
+    // 選択位置は先頭に戻す
+    m_file_browser.current_page = 0;
+    m_file_browser.selected_index = 0;
+}
+
+// 表示上のindex番目のエントリ名を返す(先頭の".."を含む)
+const char* PlatformMenu::get_file_entry(int index, bool* is_dir)
+{
+    if (has_parent_entry()) {
+        if (index == 0) {
+            *is_dir = true;
+            return "..";
+        }
+        index--;
     }
     
-    return true;
+    PlatformDirIndex* dir_index = m_file_browser.index;
+    if (!dir_index || dir_index->is_scanning() || index < 0 || index >= m_file_filter.get_count()) {
+        *is_dir = false;
+        return nullptr;
+    }
+    index = m_file_filter.get_entry(index);
+    *is_dir = dir_index->is_dir(index);
+    return dir_index->get_name(index);
 }
 
 // ファイルブラウザの描画
@@ -1239,13 +1275,20 @@ void PlatformMenu::draw_file_browser()
     // target_menu_indexが範囲内かチェック
     if (m_file_browser.target_menu_index >= 0 && m_file_browser.target_menu_index < m_num_items) {
         snprintf(header, sizeof(header), "file select - %s", 
-                 m_menu_items[m_file_browser.target_menu_index].display_name);
+                 get_string(m_menu_items[m_file_browser.target_menu_index].display_name));
     } else {
         snprintf(header, sizeof(header), "file select");
     }
     
     m_fb_console->drawString(header, 10, 10, MENU_COLOR_HEADER, MENU_COLOR_BACKGROUND, false);
     
+    // 絞り込み中の文字列を表示
+    if (m_file_filter.is_active()) {
+        char search[DIR_FILTER_MAX_LENGTH + 16];
+        snprintf(search, sizeof(search), "search: %s_", m_file_filter.get_pattern());
+        m_fb_console->drawString(search, width - 200, 10, MENU_COLOR_VALUE, MENU_COLOR_BACKGROUND, false);
+    }
+    
     // 現在のディレクトリパスを表示
     m_fb_console->drawString(m_file_browser.current_dir, 10, 25, MENU_COLOR_TEXT, MENU_COLOR_BACKGROUND, false);
     
@@ -1267,31 +1310,21 @@ void PlatformMenu::draw_file_browser()
     // 表示すべき項目数を計算
     int items_to_display = end_index - start_index;
     
-    // 現在表示しているページの範囲がキャッシュにない場合は更新
-    int current_page_end = start_index + items_to_display - 1;
-    if (start_index < m_file_browser.cache_start_index || 
-        current_page_end >= m_file_browser.cache_start_index + m_file_browser.entry_count) {
-        update_file_cache(start_index);
-    }
-    
     // 現在のページの各項目を描画
     for (int i = 0; i < items_to_display; i++) {
         int global_index = start_index + i;
         
-        // キャッシュ内のインデックスに変換
-        int cache_index = global_index - m_file_browser.cache_start_index;
+        bool is_dir;
+        const char* name = get_file_entry(global_index, &is_dir);
         
-        // キャッシュから取得できる場合のみ表示（範囲外チェック）
-        if (cache_index >= 0 && cache_index < m_file_browser.entry_count) {
-            // キャッシュ内に存在する項目を描画
-            FILINFO* fno = &m_file_browser.entries[cache_index];
+        if (name) {
             char item_text[MAX_STRING_LENGTH];
             
             // ディレクトリならアイコンを付ける
-            if (fno->fattrib & AM_DIR) {
-                snprintf(item_text, sizeof(item_text), "[DIR] %s", fno->fname);
+            if (is_dir) {
+                snprintf(item_text, sizeof(item_text), "[DIR] %s", name);
             } else {
-                strncpy(item_text, fno->fname, sizeof(item_text) - 1);
+                strncpy(item_text, name, sizeof(item_text) - 1);
                 item_text[sizeof(item_text) - 1] = '\0';
             }
             
@@ -1306,8 +1339,15 @@ void PlatformMenu::draw_file_browser()
         y_pos += 16;
     }
     
+    // 読み込み中は読んだ数を表示
+    if (is_dir_scanning()) {
+        char loading[64];
+        snprintf(loading, sizeof(loading), "loading %d...", m_file_browser.index->get_count());
+        m_fb_console->drawString(loading, 20, y_pos, MENU_COLOR_VALUE, MENU_COLOR_BACKGROUND, false);
+    }
+    
     // フッター（ナビゲーションヘルプ）を表示
-    m_fb_console->drawString("↑↓: item select  ←→: page switch  Enter: select  ESC: back", 
+    m_fb_console->drawString("↑↓: item select  ←→: page switch  Enter: select  A-Z: search  ESC: back", 
                           10, height - 20, MENU_COLOR_TEXT, MENU_COLOR_BACKGROUND, false);
 }
 
@@ -1324,11 +1364,6 @@ void PlatformMenu::handle_file_browser_key(int key)
                 if (m_file_browser.selected_index < m_file_browser.current_page * m_files_per_page) {
                     m_file_browser.current_page--;
                 }
-                
-                // キャッシュ範囲外にアクセスする場合はキャッシュを更新
-                if (m_file_browser.selected_index < m_file_browser.cache_start_index) {
-                    update_file_cache(m_file_browser.selected_index);
-                }
             }
             break;
             
@@ -1341,11 +1376,6 @@ void PlatformMenu::handle_file_browser_key(int key)
                 if (m_file_browser.selected_index >= (m_file_browser.current_page + 1) * m_files_per_page) {
                     m_file_browser.current_page++;
                 }
-                
-                // キャッシュ範囲外にアクセスする場合はキャッシュを更新
-                if (m_file_browser.selected_index >= m_file_browser.cache_start_index + m_file_browser.entry_count) {
-                    update_file_cache(m_file_browser.selected_index);
-                }
             }
             break;
             
@@ -1355,11 +1385,6 @@ void PlatformMenu::handle_file_browser_key(int key)
                 m_file_browser.current_page--;
                 // ページの先頭を選択
                 m_file_browser.selected_index = m_file_browser.current_page * m_files_per_page;
-                
-                // キャッシュ範囲外にアクセスする場合はキャッシュを更新
-                if (m_file_browser.selected_index < m_file_browser.cache_start_index) {
-                    update_file_cache(m_file_browser.selected_index);
-                }
             }
             break;
             
@@ -1374,11 +1399,6 @@ void PlatformMenu::handle_file_browser_key(int key)
                 if (m_file_browser.selected_index >= m_file_browser.total_entries) {
                     m_file_browser.selected_index = m_file_browser.total_entries - 1;
                 }
-                
-                // キャッシュ範囲外にアクセスする場合はキャッシュを更新
-                if (m_file_browser.selected_index >= m_file_browser.cache_start_index + m_file_browser.entry_count) {
-                    update_file_cache(m_file_browser.selected_index);
-                }
             }
             break;
             
@@ -1388,15 +1408,52 @@ void PlatformMenu::handle_file_browser_key(int key)
             break;
             
         case MENU_KEY_ESC:
-            // ブラウザを閉じる
-            m_file_browser.browser_active = false;
+            if (m_file_filter.is_active()) {
+                // 絞り込み中なら解除する
+                m_file_filter.reset(m_file_browser.index);
+                update_file_list();
+            } else {
+                // ブラウザを閉じる(読み込み中なら中断する)
+                m_dir_cache.cancel_scan();
+                m_file_browser.browser_active = false;
+            }
+            break;
+            
+        case MENU_KEY_BACKSPACE:
+            // 絞り込みの文字を1つ消す
+            if (m_file_filter.pop_char()) {
+                update_file_list();
+            }
             break;
             
         case MENU_KEY_F12:
             // メニュー全体を閉じる
             toggle_menu();
             break;
+            
+        default:
+            // 文字キーは名前の絞り込みに使う
+            {
+                char c = key_to_filter_char(key);
+                if (c && !is_dir_scanning() && m_file_filter.push_char(c)) {
+                    update_file_list();
+                }
+            }
+            break;
+    }
+}
+
+// 絞り込みに使えるキーを文字に変換する(使えないキーは0)
+char PlatformMenu::key_to_filter_char(int key)
+{
+    if ((key >= '0' && key <= '9') || (key >= 'A' && key <= 'Z') || key == ' ') {
+        return (char)key;
     }
+    switch (key) {
+        case MENU_KEY_MINUS:  return '-';
+        case MENU_KEY_PERIOD: return '.';
+    }
+    return 0;
 }
 
 // ファイル項目選択時の処理
@@ -1405,45 +1462,31 @@ void PlatformMenu::select_file_entry(int index)
     if (index < 0 || index >= m_file_browser.total_entries) {
         return;
     }
+    TRACE_SCOPE("menu file");
     
     CLogger* logger = get_logger();
     
-    // インデックスをキャッシュ内のインデックスに変換
-    int cache_index = index - m_file_browser.cache_start_index;
-    
-    // キャッシュ範囲外の場合はキャッシュを更新して再試行
-    if (cache_index < 0 || cache_index >= m_file_browser.entry_count) {
-        if (update_file_cache(index)) {
-            // 更新後の新しいキャッシュインデックスを計算
-            cache_index = index - m_file_browser.cache_start_index;
-            // キャッシュ更新後も範囲外の場合は処理終了
-            if (cache_index < 0 || cache_index >= m_file_browser.entry_count) {
-                if (logger) {
-                    logger->Write("PlatformMenu", LogError, "index out of range after cache update: %d", index);
-                }
-                return;
-            }
-        } else {
-            if (logger) {
-                logger->Write("PlatformMenu", LogError, "cache update failed: %d", index);
-            }
-            return; // キャッシュ更新失敗
-        }
+    bool is_dir;
+    const char* name = get_file_entry(index, &is_dir);
+    if (!name) {
+        return;
     }
     
-    FILINFO* fno = &m_file_browser.entries[cache_index];
+    // ディレクトリを移動するとインデックスが入れ替わる可能性があるのでコピーしておく
+    char fname[MAX_STRING_LENGTH];
+    strncpy(fname, name, sizeof(fname) - 1);
+    fname[sizeof(fname) - 1] = '\0';
     
     if (logger) {
-        logger->Write("PlatformMenu", LogNotice, "selected: %s (index: %d, cache: %d)", 
-                      fno->fname, index, cache_index);
+        logger->Write("PlatformMenu", LogNotice, "selected: %s (index: %d)", fname, index);
     }
     
     // ディレクトリの場合はそのディレクトリに移動
-    if (fno->fattrib & AM_DIR) {
+    if (is_dir) {
         char new_path[MAX_STRING_LENGTH];
         
         // ".."（親ディレクトリ）の場合は特別処理
-        if (strcmp(fno->fname, "..") == 0) {
+        if (strcmp(fname, "..") == 0) {
             // 現在のパスから最後のディレクトリ部分を削除
             char* last_slash = strrchr(m_file_browser.current_dir, '/');
             if (last_slash) {
@@ -1467,15 +1510,14 @@ void PlatformMenu::select_file_entry(int index)
             // 通常のディレクトリの場合
             if (strcmp(m_file_browser.current_dir, "/") == 0) {
                 // ルートディレクトリの場合はスラッシュを一つだけにする
-                snprintf(new_path, sizeof(new_path), "/%s", fno->fname);
+                snprintf(new_path, sizeof(new_path), "/%s", fname);
             } else {
                 // それ以外の場合はパスを連結
-                snprintf(new_path, sizeof(new_path), "%s/%s", m_file_browser.current_dir, fno->fname);
+                snprintf(new_path, sizeof(new_path), "%s/%s", m_file_browser.current_dir, fname);
             }
         }
         
         // 新しいディレクトリをロード
-        m_file_browser.cache_start_index = 0; // キャッシュをリセット
         if (load_file_entries(new_path)) {
             // 成功したら現在のディレクトリを更新
             strncpy(m_file_browser.current_dir, new_path, sizeof(m_file_browser.current_dir) - 1);
@@ -1491,9 +1533,9 @@ void PlatformMenu::select_file_entry(int index)
         
         // フルパスを構築
         if (strcmp(m_file_browser.current_dir, "/") == 0) {
-            snprintf(full_path, sizeof(full_path), "/%s", fno->fname);
+            snprintf(full_path, sizeof(full_path), "/%s", fname);
         } else {
-            snprintf(full_path, sizeof(full_path), "%s/%s", m_file_browser.current_dir, fno->fname);
+            snprintf(full_path, sizeof(full_path), "%s/%s", m_file_browser.current_dir, fname);
         }
         
         if (logger) {
@@ -1501,13 +1543,13 @@ void PlatformMenu::select_file_entry(int index)
                          m_file_browser.target_menu_index, full_path, 
                          m_num_items,
                          (m_file_browser.target_menu_index >= 0 && m_file_browser.target_menu_index < m_num_items) 
-                             ? m_menu_items[m_file_browser.target_menu_index].config_name 
+                             ? get_string(m_menu_items[m_file_browser.target_menu_index].config_name) 
                              : "out of range error");
         }
         
         // 設定を適用
         if (m_file_browser.target_menu_index >= 0 && m_file_browser.target_menu_index < m_num_items) {
-            apply_config_string(m_menu_items[m_file_browser.target_menu_index].config_name, full_path);
+            apply_config_string(get_string(m_menu_items[m_file_browser.target_menu_index].config_name), full_path);
         } else if (logger) {
             logger->Write("PlatformMenu", LogError, "invalid menu_index: %d (array size: %d)", 
                          m_file_browser.target_menu_index, m_num_items);
@@ -1612,23 +1654,56 @@ bool PlatformMenu::handle_action(const char* action)
         save_tape_changes();
         return true;
     }
+    else if (strcmp(action_copy, "InputRecord") == 0) {
+        // 入力の記録を開始(リセットしてから記録する)
+        if (m_emulator->start_input_recording()) {
+            toggle_menu();
+        }
+        return true;
+    }
+    else if (strcmp(action_copy, "InputReplay") == 0) {
+        // 記録した入力の再生を開始
+        if (m_emulator->start_input_playback()) {
+            toggle_menu();
+        }
+        return true;
+    }
+    else if (strcmp(action_copy, "InputStop") == 0) {
+        // 記録・再生を停止(記録中ならここでSDに書き込む)
+        m_emulator->stop_input_movie();
+        return true;
+    }
+    else if (strcmp(action_copy, "Benchmark") == 0 && param > 0) {
+        // メニューを閉じてから、指定した秒数のベンチマークを実行する
+        m_emulator->request_benchmark(param);
+        toggle_menu();
+        return true;
+    }
+    else if (strcmp(action_copy, "AutoKeyStop") == 0) {
+        // 自動キー入力を停止
+        m_emulator->stop_auto_key();
+        return true;
+    }
     return false;
 } 
 
 void PlatformMenu::save_disk_changes()
 {
+    TRACE_SCOPE("save disks");
     // ディスクの変更を保存
     // 一度クローズして開きなおす……
     for(int drv = 0; drv < USE_FLOPPY_DISK; drv++) {
         if(m_emulator->is_floppy_disk_inserted(drv)) {
             m_emulator->close_floppy_disk(drv);
             m_emulator->open_floppy_disk(drv, m_config->get_config()->current_floppy_disk_path[drv], 0);
+            m_dir_cache.invalidate(m_config->get_config()->current_floppy_disk_path[drv]);
         }
     }
 }
 
 void PlatformMenu::save_tape_changes()
 {
+    TRACE_SCOPE("save tapes");
     // テープの変更を保存
     // 一度クローズしてから再生して止めてやる(強引)
     for(int drv = 0; drv < USE_TAPE; drv++) {
@@ -1636,6 +1711,7 @@ void PlatformMenu::save_tape_changes()
             m_emulator->close_tape(drv);
             m_emulator->play_tape(drv, m_config->get_config()->current_tape_path[drv]);
             m_emulator->push_stop(drv);
+            m_dir_cache.invalidate(m_config->get_config()->current_tape_path[drv]);
         }
     }
 }
@@ -1684,54 +1760,16 @@ void PlatformMenu::apply_config_string(const char* config_name, const char* valu
     }
     else if(strncmp(config_name, "record_tape_path[", 17) == 0 && index >= 0) {
         m_emulator->record_tape(index, value);
+        // 書き込むのでディレクトリの内容(サイズ)を読み直させる
+        m_dir_cache.invalidate(value);
+    }
+    else if(strncmp(config_name, "auto_key_path[", 14) == 0 && index >= 0) {
+        // 入力先を見せるため、開始できたらメニューを閉じる
+        if (m_emulator->start_auto_key_file(value) && is_visible()) {
+            toggle_menu();
+        }
     }
 
     // 特例として↑のようにエミュレーター側で反映させてやる
     // mpConfig->apply_config_string(config_name, value);
 }
-
-// キャッシュ範囲を更新して再読み込み
-bool PlatformMenu::update_file_cache(int new_index)
-{
-    CLogger* logger = get_logger();
-    
-    // 表示されるページを保証するためのキャッシュ更新
-    // 新しいインデックスを中心に、表示に必要なページサイズを考慮する
-    
-    // 現在のページを特定
-    int current_page = new_index / m_files_per_page;
-    int page_start = current_page * m_files_per_page;
-    
-    // 新しいキャッシュの開始と終了を計算
-    // 最低でも現在のページを含める
-    int new_start = page_start;
-    
-    // MAX_FILE_ENTRIESを最大限に活用するため、余分なスペースがあれば前後のページも含める
-    int pages_to_cache = MAX_FILE_ENTRIES / m_files_per_page;
-    
-    // 可能なら前後に均等にページを配置
-    int half_pages = pages_to_cache / 2;
-    new_start = page_start - (half_pages * m_files_per_page);
-    
-    // 範囲調整（最小0）
-    if (new_start < 0) new_start = 0;
-    
-    // 末尾に十分なエントリがない場合は前半を増やす
-    int new_end = new_start + MAX_FILE_ENTRIES;
-    if (new_end > m_file_browser.total_entries) {
-        new_end = m_file_browser.total_entries;
-        new_start = new_end - MAX_FILE_ENTRIES;
-        if (new_start < 0) new_start = 0;
-    }
-    
-    if (logger) {
-        logger->Write("PlatformMenu", LogNotice, "cache range updated: %d → %d (page %d, page start %d)", 
-                      m_file_browser.cache_start_index, new_start, current_page, page_start);
-    }
-    
-    // キャッシュ開始位置を更新
-    m_file_browser.cache_start_index = new_start;
-    
-    // 現在のディレクトリを再読み込み
-    return load_file_entries(m_file_browser.current_dir);
-}
@@ -6,16 +6,22 @@
 
 // FatFsのためのヘッダ
 #include <fatfs/ff.h>
+#include "PlatformDirIndex.h"
 
 class FBConsole;
 class EmuController;
 class PlatformConfig;
+class PlatformBootCache;
 
 // Constants
 #define MAX_MENU_ITEMS 256      // Maximum number of menu items
 #define MAX_MENU_DEPTH 8        // Maximum menu depth
 #define MAX_STRING_LENGTH 256   // Maximum length of strings
-#define MAX_FILE_ENTRIES 64    // ファイルブラウザがキャッシュする最大エントリ数
+#define MENU_STRING_POOL_SIZE 16384 // メニューの文字列プールのサイズ
+
+// ディレクトリの読み込みを1回のdrawで進める時間(マイクロ秒)と、時間を確認する間隔(エントリ数)
+#define DIR_SCAN_SLICE_US 8000
+#define DIR_SCAN_ENTRIES_PER_STEP 16
 
 // キーリピート設定
 #define KEY_REPEAT_DELAY 500    // 最初のリピートまでの遅延（ミリ秒）
@@ -38,6 +44,9 @@ class PlatformConfig;
 #define MENU_KEY_ENTER   0x0D
 #define MENU_KEY_ESC     0x1B
 #define MENU_KEY_F12     0x7B
+#define MENU_KEY_BACKSPACE 0x08
+#define MENU_KEY_MINUS   0xBD
+#define MENU_KEY_PERIOD  0xBE
 
 // Menu colors
 #define MENU_COLOR_BACKGROUND 0x0000  // Black
@@ -47,26 +56,25 @@ class PlatformConfig;
 #define MENU_COLOR_VALUE      0x07E0  // Green
 
 // Menu item structure
+// 文字列はm_string_poolへのオフセットで持つ(同じ文字列は1つにまとめる)
 typedef struct {
-    char display_name[MAX_STRING_LENGTH];  // Display name
-    char original_path[MAX_STRING_LENGTH]; // Original full path (e.g. "Drive/FD0/Insert")
-    int type;                             // Item type (bool, file, action, etc.)
-    char action[MAX_STRING_LENGTH];       // Action string
-    char config_name[MAX_STRING_LENGTH];  // Config name
-    int parent_index;                     // Parent menu item index
-    int first_child_index;                // First child menu item index
-    int num_children;                     // Number of child menu items
+    u16 display_name;                     // Display name
+    u16 original_path;                    // Original full path (e.g. "Drive/FD0/Insert")
+    u16 action;                           // Action string
+    u16 config_name;                      // Config name
+    s16 parent_index;                     // Parent menu item index
+    u16 first_child_index;                // m_child_indices内の子の先頭
+    u16 num_children;                     // Number of child menu items
+    u8 type;                              // Item type (bool, file, action, etc.)
 } MenuItemInfo;
 
 // ファイルブラウザの状態を保持する構造体
 typedef struct {
-    FILINFO entries[MAX_FILE_ENTRIES]; // ファイルエントリのキャッシュ
-    int entry_count;                   // 合計エントリ数
+    PlatformDirIndex* index;           // 表示しているディレクトリの内容(m_dir_cacheが保持)
     int current_page;                  // 現在表示しているページ
     int selected_index;                // 選択されているファイルのインデックス
     int page_count;                    // 合計ページ数
-    int cache_start_index;             // キャッシュの先頭インデックス
-    int total_entries;                 // ディレクトリ内の合計エントリ数（キャッシュされていないものも含む）
+    int total_entries;                 // 表示する合計エントリ数（".."を含む）
     bool has_parent_dir;               // 親ディレクトリへの項目があるかどうか
     char current_dir[MAX_STRING_LENGTH]; // 現在のディレクトリパス
     char initial_root_dir[MAX_STRING_LENGTH]; // 初期ルートディレクトリ（これより上には行けない）
@@ -79,6 +87,16 @@ class PlatformMenu {
 private:
     MenuItemInfo m_menu_items[MAX_MENU_ITEMS];  // Menu items array
     int m_num_items;                           // Total number of menu items
+
+    // メニューの文字列(先頭は空文字列)
+    char m_string_pool[MENU_STRING_POOL_SIZE];
+    int m_string_pool_size;
+    bool m_string_pool_overflow;              // プールに入りきらない文字列があった(読み込みは失敗にする)
+
+    // 階層ごとの子のインデックス(親ごとに連続して並べる)
+    u16 m_child_indices[MAX_MENU_ITEMS];
+    u16 m_root_first_child;
+    u16 m_root_num_children;
     
     int m_current_menu_path[MAX_MENU_DEPTH];  // Current menu path (indexes)
     int m_current_depth;                      // Current menu depth
@@ -88,6 +106,9 @@ private:
     
     bool m_visible;                           // Is menu visible
     bool m_capturing_keys;                    // Is menu capturing key input
+    bool m_menu_redraw;                       // 次のdraw_menuで全体を描き直すか
+    int m_drawn_parent;                       // 最後に描画した階層
+    int m_drawn_selected;                     // 最後に描画したカーソル位置
     
     // キーリピート用の変数
     int m_key_pressed;                        // 現在押されているキー
@@ -101,15 +122,30 @@ private:
     
     // ファイルブラウザ関連
     FileBrowserState m_file_browser;          // ファイルブラウザの状態
+    PlatformDirCache m_dir_cache;             // 最近開いたディレクトリの内容
+    PlatformDirFilter m_file_filter;          // 入力した文字列による絞り込み
 
     PlatformConfig* m_config;
     
     // Internal methods
     void draw_menu();
+    int draw_menu_item(int position, int y_pos);
+    int get_menu_item_height(int item_index);
+    void redraw_menu_cursor(int old_position, int new_position);
     void handle_key_input(int key);
     void handle_selection();
     bool load_menu_file(const char* filename);
     void parse_menu_item(const char* line);
+    u16 intern_string(const char* str, size_t length);
+    const char* get_string(u16 offset) { return m_string_pool + offset; }
+    int add_menu_item(int type, u16 display_name, u16 original_path, int parent);
+    int find_or_add_submenu(const char* full_path, const char* disp_name, size_t disp_length, int parent);
+    void build_child_indices();
+    bool restore_menu_tree(PlatformBootCache* boot_cache);
+    void store_menu_tree(PlatformBootCache* boot_cache);
+    int get_current_parent() { return (m_current_depth > 0) ? m_current_menu_path[m_current_depth - 1] : -1; }
+    int get_child_count(int parent);
+    int get_child_item(int parent, int position);
     bool handle_action(const char* action);
     void toggle_bool_value(int item_index);
     void set_int_select_value(int item_index);
@@ -126,7 +162,12 @@ private:
     void draw_file_browser();
     void handle_file_browser_key(int key);
     bool load_file_entries(const char* path);
-    bool update_file_cache(int new_index);
+    const char* get_file_entry(int index, bool* is_dir);
+    bool has_parent_entry() { return m_file_browser.has_parent_dir && !m_file_filter.is_active(); }
+    void update_file_list();
+    bool update_dir_scan();
+    bool is_dir_scanning() { return m_file_browser.index && m_file_browser.index->is_scanning(); }
+    char key_to_filter_char(int key);
     void select_file_entry(int index);
     void save_disk_changes();
     void save_tape_changes();
@@ -145,6 +186,7 @@ public:
     int update();
 
     void update_draw_buffer();
+    FBConsole* get_fb_console() { return m_fb_console; }
 };
 
 #endif // _PLATFORM_MENU_H_ 
\ No newline at end of file
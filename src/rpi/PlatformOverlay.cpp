@@ -0,0 +1,175 @@
+#include "PlatformOverlay.h"
+#include "PlatformLog.h"
+
+#include <circle/timer.h>
+#include <stdlib.h>
+#include <string.h>
+
+// RGB565の2色をアルファ(0〜32)で混ぜる
+// G成分を上位16ビットに移して、3成分を1回の乗算でまとめて計算する
+static inline u16 blend_rgb565(u16 dst, u16 src, u32 alpha)
+{
+    u32 d = (dst | ((u32)dst << 16)) & 0x07E0F81F;
+    u32 s = (src | ((u32)src << 16)) & 0x07E0F81F;
+    u32 r = ((((s - d) * alpha) >> 5) + d) & 0x07E0F81F;
+    return (u16)(r | (r >> 16));
+}
+
+PlatformOverlay::PlatformOverlay(int width, int height)
+:
+    m_width(width),
+    m_height(height),
+    m_console(nullptr),
+    m_alpha(nullptr),
+    m_min_x(1),
+    m_min_y(1),
+    m_max_x(0),
+    m_max_y(0),
+    m_compose_ticks(0),
+    m_compose_count(0),
+    m_compose_pixels(0)
+{
+}
+
+PlatformOverlay::~PlatformOverlay()
+{
+    delete m_console;
+    free(m_alpha);
+}
+
+bool PlatformOverlay::initialize()
+{
+    m_console = new FBConsole(m_width, m_height);
+    if (!m_console->init(nullptr, m_width)) {
+        get_logger()->Write("PlatformOverlay", LogError, "out of memory: %dx%d", m_width, m_height);
+        return false;
+    }
+    m_alpha = (u8*)calloc(m_width * m_height, sizeof(u8));
+    if (!m_alpha) {
+        get_logger()->Write("PlatformOverlay", LogError, "out of memory: %dx%d", m_width, m_height);
+        return false;
+    }
+    return true;
+}
+
+void PlatformOverlay::clear()
+{
+    // 描画済みの範囲だけ透明に戻す(色は次に描く時に上書きされる)
+    for (int y = m_min_y; y <= m_max_y; y++) {
+        memset(m_alpha + y * m_width + m_min_x, 0, m_max_x - m_min_x + 1);
+    }
+    m_min_x = m_min_y = 1;
+    m_max_x = m_max_y = 0;
+}
+
+void PlatformOverlay::extend_bounds(int x1, int y1, int x2, int y2)
+{
+    if (is_empty()) {
+        m_min_x = x1;
+        m_min_y = y1;
+        m_max_x = x2;
+        m_max_y = y2;
+        return;
+    }
+    if (x1 < m_min_x) m_min_x = x1;
+    if (y1 < m_min_y) m_min_y = y1;
+    if (x2 > m_max_x) m_max_x = x2;
+    if (y2 > m_max_y) m_max_y = y2;
+}
+
+void PlatformOverlay::fill_rect(int x, int y, int width, int height, FBConsoleColor color, u8 alpha)
+{
+    if (!m_alpha) return;
+
+    int x2 = x + width - 1;
+    int y2 = y + height - 1;
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x2 >= m_width) x2 = m_width - 1;
+    if (y2 >= m_height) y2 = m_height - 1;
+    if (x > x2 || y > y2) return;
+
+    FBConsoleColor* buffer = m_console->getBuffer();
+    for (int py = y; py <= y2; py++) {
+        for (int px = x; px <= x2; px++) {
+            buffer[py * m_width + px] = color;
+        }
+        memset(m_alpha + py * m_width + x, alpha, x2 - x + 1);
+    }
+    extend_bounds(x, y, x2, y2);
+}
+
+void PlatformOverlay::draw_text(int x, int y, const char* text, FBConsoleColor color, FBConsoleColor bg_color, u8 bg_alpha)
+{
+    if (!m_alpha || x < 0 || y < 0) return;
+
+    int x2 = x + (int)strlen(text) * 8 - 1;
+    int y2 = y + 7;
+    if (x2 >= m_width) x2 = m_width - 1;
+    if (y2 >= m_height) y2 = m_height - 1;
+    if (x > x2 || y > y2) return;
+
+    m_console->drawString(text, x, y, color, bg_color, false);
+
+    // 文字の部分は不透明、背景の部分は指定の透明度
+    FBConsoleColor* buffer = m_console->getBuffer();
+    for (int py = y; py <= y2; py++) {
+        for (int px = x; px <= x2; px++) {
+            int offset = py * m_width + px;
+            m_alpha[offset] = (buffer[offset] == color) ? OVERLAY_ALPHA_OPAQUE : bg_alpha;
+        }
+    }
+    extend_bounds(x, y, x2, y2);
+}
+
+void PlatformOverlay::compose(TScreenColor* dst, int dst_pitch, int dst_width, int dst_height, int x, int y)
+{
+    if (is_empty()) return;
+
+    u64 start = CTimer::GetClockTicks64();
+
+    // 描画済みの範囲を出力先に収まるように切り詰める
+    int x1 = m_min_x, y1 = m_min_y;
+    int x2 = m_max_x, y2 = m_max_y;
+    if (x + x1 < 0) x1 = -x;
+    if (y + y1 < 0) y1 = -y;
+    if (x + x2 >= dst_width) x2 = dst_width - 1 - x;
+    if (y + y2 >= dst_height) y2 = dst_height - 1 - y;
+    if (x1 > x2 || y1 > y2) return;
+
+    const FBConsoleColor* buffer = m_console->getBuffer();
+    for (int py = y1; py <= y2; py++) {
+        const FBConsoleColor* src_line = buffer + py * m_width;
+        const u8* alpha_line = m_alpha + py * m_width;
+        TScreenColor* dst_line = dst + (y + py) * dst_pitch + x;
+        for (int px = x1; px <= x2; px++) {
+            u32 alpha = alpha_line[px];
+            if (alpha == 0) {
+                continue;
+            }
+            if (alpha >= OVERLAY_ALPHA_OPAQUE) {
+                dst_line[px] = src_line[px];
+            } else {
+                dst_line[px] = blend_rgb565(dst_line[px], src_line[px], alpha);
+            }
+        }
+    }
+
+    m_compose_ticks += CTimer::GetClockTicks64() - start;
+    m_compose_count++;
+    m_compose_pixels = (x2 - x1 + 1) * (y2 - y1 + 1);
+}
+
+bool PlatformOverlay::get_compose_stats(u32* average_us, u32* pixels, u32* count)
+{
+    if (m_compose_count == 0) {
+        return false;
+    }
+    *average_us = (u32)(m_compose_ticks / m_compose_count);
+    *pixels = m_compose_pixels;
+    *count = m_compose_count;
+
+    m_compose_ticks = 0;
+    m_compose_count = 0;
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef _PLATFORM_OVERLAY_H_
+#define _PLATFORM_OVERLAY_H_
+
+#include <circle/types.h>
+#include <circle/screen.h>
+
+#include "FBConsole.hpp"
+
+// アルファ値の範囲(0:透明 〜 OVERLAY_ALPHA_OPAQUE:不透明)
+#define OVERLAY_ALPHA_OPAQUE 32
+
+/// @brief エミュレーター画面に半透明で重ねる小さな描画面(RGB565+アルファ)
+/// 描画した範囲だけを覚えておき、合成はその範囲だけ行う
+class PlatformOverlay {
+    private:
+        int m_width;
+        int m_height;
+
+        // 色はFBConsoleで描き、アルファはピクセルごとに持つ
+        FBConsole* m_console;
+        u8* m_alpha;
+
+        // 描画済みの範囲(m_min_x > m_max_xなら空)
+        int m_min_x, m_min_y;
+        int m_max_x, m_max_y;
+
+        // 合成にかかった時間の計測
+        u64 m_compose_ticks;
+        u32 m_compose_count;
+        u32 m_compose_pixels;
+
+        void extend_bounds(int x1, int y1, int x2, int y2);
+
+    public:
+        PlatformOverlay(int width, int height);
+        ~PlatformOverlay();
+
+        bool initialize();
+
+        // 全体を透明に戻す
+        void clear();
+        bool is_empty() { return m_min_x > m_max_x; }
+
+        // 矩形を塗りつぶす
+        void fill_rect(int x, int y, int width, int height, FBConsoleColor color, u8 alpha);
+        // 文字は不透明、背景はbg_alphaで描く
+        void draw_text(int x, int y, const char* text, FBConsoleColor color, FBConsoleColor bg_color, u8 bg_alpha);
+
+        // dst(dst_width x dst_height)の(x, y)に重ねる。描画済みの範囲だけを処理する
+        void compose(TScreenColor* dst, int dst_pitch, int dst_width, int dst_height, int x, int y);
+
+        // 合成1回あたりの平均時間と対象ピクセル数を返し、計測をやり直す
+        bool get_compose_stats(u32* average_us, u32* pixels, u32* count);
+};
+
+#endif
@@ -0,0 +1,139 @@
+#include "PlatformProfiler.h"
+#include "PlatformLog.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char* s_stage_names[PROFILE_STAGE_COUNT] = {
+    "run", "draw", "blit", "fb", "sound", "sleep"
+};
+
+static PlatformProfiler s_profiler;
+
+PlatformProfiler* get_profiler()
+{
+    return &s_profiler;
+}
+
+void ProfileStageStats::add(u32 us)
+{
+    if (m_count == 0 || us < m_min) {
+        m_min = us;
+    }
+    if (us > m_max) {
+        m_max = us;
+    }
+    m_count++;
+    m_total += us;
+
+    // 区間はビット数で決める(0は区間0)
+    int bucket = us ? 32 - __builtin_clz(us) : 0;
+    if (bucket >= PROFILE_HISTOGRAM_BUCKETS) {
+        bucket = PROFILE_HISTOGRAM_BUCKETS - 1;
+    }
+    m_histogram[bucket]++;
+}
+
+void ProfileStageStats::clear()
+{
+    m_count = 0;
+    m_min = 0;
+    m_max = 0;
+    m_total = 0;
+    memset(m_histogram, 0, sizeof(m_histogram));
+}
+
+void ProfileStageStats::format_histogram(char* buffer, int size)
+{
+    int length = 0;
+    buffer[0] = '\0';
+    for (int i = 0; i < PROFILE_HISTOGRAM_BUCKETS && length < size; i++) {
+        if (m_histogram[i] == 0) {
+            continue;
+        }
+        u32 lower = i ? (1u << (i - 1)) : 0;
+        length += snprintf(buffer + length, size - length, " %u:%u", lower, m_histogram[i]);
+    }
+}
+
+PlatformProfiler::PlatformProfiler()
+:
+    m_window_start_us(0),
+    m_window_run_frames(0),
+    m_window_draw_frames(0),
+    m_run_frames(0),
+    m_draw_frames(0)
+{
+}
+
+void PlatformProfiler::update(u64 now, int run_frames, int draw_frames)
+{
+    m_run_frames = run_frames;
+    m_draw_frames = draw_frames;
+
+    if (m_window_start_us == 0) {
+        m_window_start_us = now;
+        m_window_run_frames = run_frames;
+        m_window_draw_frames = draw_frames;
+        return;
+    }
+    if (now - m_window_start_us >= PROFILE_REPORT_INTERVAL_US) {
+        report(now);
+    }
+}
+
+void PlatformProfiler::report(u64 now)
+{
+    u32 elapsed_ms = (u32)((now - m_window_start_us) / 1000);
+    int run = m_run_frames - m_window_run_frames;
+    int drawn = m_draw_frames - m_window_draw_frames;
+    // 表示フレームレートは小数点以下1桁まで
+    u32 fps10 = elapsed_ms ? (u32)(drawn * 10000 / elapsed_ms) : 0;
+
+    get_logger()->Write("Profiler", LogNotice, "%d frames run, %d drawn in %u ms (%u.%u fps)",
+        run, drawn, elapsed_ms, fps10 / 10, fps10 % 10);
+
+    char histogram[160];
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        ProfileStageStats* stats = &m_stages[i];
+        if (stats->get_count() == 0) {
+            continue;
+        }
+        stats->format_histogram(histogram, sizeof(histogram));
+        get_logger()->Write("Profiler", LogNotice, "%-5s n=%u min=%u avg=%u max=%u us, hist(us):%s",
+            s_stage_names[i], stats->get_count(), stats->get_min(), stats->get_average(), stats->get_max(), histogram);
+        stats->clear();
+    }
+
+    m_window_start_us = now;
+    m_window_run_frames = m_run_frames;
+    m_window_draw_frames = m_draw_frames;
+}
+
+void PlatformProfiler::format_stages(char* buffer, int size, int first, int last)
+{
+    int length = 0;
+    buffer[0] = '\0';
+    for (int i = first; i <= last && i < PROFILE_STAGE_COUNT && length < size; i++) {
+        u32 average = m_stages[i].get_average();
+        length += snprintf(buffer + length, size - length, "%s%s %u.%02u",
+            i == first ? "" : " ", s_stage_names[i], average / 1000, (average % 1000) / 10);
+    }
+    if (length < size) {
+        snprintf(buffer + length, size - length, " ms");
+    }
+}
+
+const char* PlatformProfiler::get_stage_name(int stage)
+{
+    return s_stage_names[stage];
+}
+
+void PlatformProfiler::format_frames(char* buffer, int size, u64 now)
+{
+    u32 elapsed_ms = (u32)((now - m_window_start_us) / 1000);
+    int run = m_run_frames - m_window_run_frames;
+    int drawn = m_draw_frames - m_window_draw_frames;
+    u32 fps10 = elapsed_ms ? (u32)(drawn * 10000 / elapsed_ms) : 0;
+    snprintf(buffer, size, "%u.%u fps (%d/%d)", fps10 / 10, fps10 % 10, drawn, run);
+}
@@ -0,0 +1,109 @@
+#ifndef _PLATFORM_PROFILER_H_
+#define _PLATFORM_PROFILER_H_
+
+#include <circle/types.h>
+#include <circle/timer.h>
+
+#include "PlatformTrace.h"
+
+// ヒストグラムの区間数(区間iは2^(i-1)〜2^i-1マイクロ秒、最後の区間はそれ以上全て)
+#define PROFILE_HISTOGRAM_BUCKETS 18
+// シリアルへの出力間隔(マイクロ秒)。集計もこの間隔でやり直す
+#define PROFILE_REPORT_INTERVAL_US 5000000
+
+// 計測する処理
+enum ProfileStage {
+    PROFILE_VM_RUN = 0,         // VM::run(サウンドの生成を含む)
+    PROFILE_VM_DRAW,            // VM::draw_screen
+    PROFILE_STRETCH_BLIT,       // エミュ画面を描画バッファに拡大
+    PROFILE_FRAME_BUFFER,       // 描画バッファをフレームバッファに転送
+    PROFILE_SOUND,              // PlatformSound::update
+    PROFILE_SLEEP,              // 次のフレームまでの待ち
+    PROFILE_STAGE_COUNT
+};
+
+/// @brief 1つの処理の集計(最小/平均/最大と、2のべき乗ごとのヒストグラム)
+class ProfileStageStats {
+    private:
+        u32 m_count;
+        u32 m_min;
+        u32 m_max;
+        u64 m_total;
+        u32 m_histogram[PROFILE_HISTOGRAM_BUCKETS];
+
+    public:
+        ProfileStageStats() { clear(); }
+
+        void add(u32 us);
+        void clear();
+
+        u32 get_count() { return m_count; }
+        u32 get_min() { return m_count ? m_min : 0; }
+        u32 get_max() { return m_max; }
+        u32 get_average() { return m_count ? (u32)(m_total / m_count) : 0; }
+
+        // 区間ごとの回数を" 下限:回数"の形で書き出す(0回の区間は省く)
+        void format_histogram(char* buffer, int size);
+};
+
+/// @brief フレーム内の処理ごとの時間を計測し、一定間隔でシリアルに出力する
+/// USE_PROFILERが定義されていない場合はPROFILE_*マクロが空になり、計測は行われない
+class PlatformProfiler {
+    private:
+        ProfileStageStats m_stages[PROFILE_STAGE_COUNT];
+
+        u64 m_window_start_us;
+        // 集計開始時点のフレーム数(emulator_mainの累計)
+        int m_window_run_frames;
+        int m_window_draw_frames;
+        int m_run_frames;
+        int m_draw_frames;
+
+        void report(u64 now);
+
+    public:
+        PlatformProfiler();
+
+        void add(int stage, u32 us) { m_stages[stage].add(us); }
+
+        // メインループの最後に呼ぶ(フレーム数は累計を渡す)
+        void update(u64 now, int run_frames, int draw_frames);
+
+        // オーバーレイ表示用の文字列を作る(今の集計の平均値)
+        void format_stages(char* buffer, int size, int first, int last);
+        void format_frames(char* buffer, int size, u64 now);
+
+        static const char* get_stage_name(int stage);
+};
+
+extern PlatformProfiler* get_profiler();
+
+/// @brief 生成から破棄までの時間をstageに加える(トレースにも区間として記録する)
+class ProfileScope {
+    private:
+        int m_stage;
+        u64 m_start;
+
+    public:
+        ProfileScope(int stage) : m_stage(stage), m_start(CTimer::GetClockTicks64())
+        {
+            get_trace()->record(TRACE_EVENT_BEGIN, PlatformProfiler::get_stage_name(stage), m_start);
+        }
+        ~ProfileScope()
+        {
+            u64 end = CTimer::GetClockTicks64();
+            get_trace()->record(TRACE_EVENT_END, PlatformProfiler::get_stage_name(m_stage), end);
+            get_profiler()->add(m_stage, (u32)(end - m_start));
+        }
+};
+
+#ifdef USE_PROFILER
+// 1つのスコープにつき1つだけ置ける
+#define PROFILE_SCOPE(stage) ProfileScope profile_scope(stage)
+#define PROFILE_UPDATE(now, run_frames, draw_frames) get_profiler()->update(now, run_frames, draw_frames)
+#else
+#define PROFILE_SCOPE(stage)
+#define PROFILE_UPDATE(now, run_frames, draw_frames)
+#endif
+
+#endif
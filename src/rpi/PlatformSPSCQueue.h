@@ -0,0 +1,64 @@
+#ifndef _PLATFORM_SPSC_QUEUE_H_
+#define _PLATFORM_SPSC_QUEUE_H_
+
+#include <circle/types.h>
+
+/// @brief 単一プロデューサー/単一コンシューマー用のロックフリーキュー
+/// pushは1つのコンテキスト(USBのコールバックなど)、popは1つのコンテキスト(メインループ)からのみ呼ぶ事
+/// SIZEは2のべき乗であること
+template <typename T, u32 SIZE>
+class PlatformSPSCQueue {
+    private:
+        static_assert((SIZE & (SIZE - 1)) == 0, "SIZE must be a power of two");
+
+        T m_buffer[SIZE];
+
+        // 書き込み位置(プロデューサーのみ更新)と読み出し位置(コンシューマーのみ更新)
+        // 両者が同じキャッシュラインに乗らないように離しておく
+        alignas(64) volatile u32 m_tail;
+        alignas(64) volatile u32 m_head;
+        // 満杯で捨てたイベント数(プロデューサーのみ更新)
+        alignas(64) volatile u32 m_overflow;
+
+    public:
+        PlatformSPSCQueue() : m_tail(0), m_head(0), m_overflow(0) {}
+
+        // プロデューサー側: 満杯の場合はfalseを返し、オーバーフロー数を数える
+        bool push(const T& item)
+        {
+            u32 tail = __atomic_load_n(&m_tail, __ATOMIC_RELAXED);
+            u32 head = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+            if (tail - head >= SIZE) {
+                __atomic_store_n(&m_overflow, m_overflow + 1, __ATOMIC_RELAXED);
+                return false;
+            }
+            m_buffer[tail & (SIZE - 1)] = item;
+            // データを書いてから位置を公開する
+            __atomic_store_n(&m_tail, tail + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+
+        // コンシューマー側: 空の場合はfalseを返す
+        bool pop(T* item)
+        {
+            u32 head = __atomic_load_n(&m_head, __ATOMIC_RELAXED);
+            u32 tail = __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE);
+            if (head == tail) {
+                return false;
+            }
+            *item = m_buffer[head & (SIZE - 1)];
+            // データを読んでから領域を返す
+            __atomic_store_n(&m_head, head + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+
+        u32 size()
+        {
+            return __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE) - __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+        }
+
+        u32 get_overflow_count() { return __atomic_load_n(&m_overflow, __ATOMIC_RELAXED); }
+        u32 capacity() { return SIZE; }
+};
+
+#endif
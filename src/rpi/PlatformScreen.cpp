@@ -7,6 +7,8 @@
 
 #include "PlatformScreen.h"
 #include "PlatformMenu.h"
+#include "PlatformOverlay.h"
+#include "PlatformProfiler.h"
 #include "PlatformLog.h"
 #include "PlatformConfig.h"
 #include <circle/types.h>
@@ -23,6 +25,10 @@ PlatformScreen::~PlatformScreen()
         free(m_draw_buffer_ptr);
         m_draw_buffer_ptr = nullptr;
     }
+    if(m_overlay) {
+        delete m_overlay;
+        m_overlay = nullptr;
+    }
 }
 
 // 空のメソッド実装
@@ -37,6 +43,13 @@ void PlatformScreen::initialize(IPlatformEmulator* emulator, int host_width, int
     m_aspect_height = aspect_height;
     m_menu = menu;
 
+    // オーバーレイは描画バッファの大きさに関係なく左上に固定の大きさで確保する
+    m_overlay = new PlatformOverlay(OVERLAY_WIDTH, OVERLAY_HEIGHT);
+    if (!m_overlay->initialize()) {
+        delete m_overlay;
+        m_overlay = nullptr;
+    }
+
     m_circle_screen = nullptr;
     // DISPLAY_WIDTH, DISPLAY_HEIGHTをデフォルトの画面サイズとして使用
     // ただしフレームバッファは確実にそのサイズにはならないので注意
@@ -149,8 +162,8 @@ int PlatformScreen::draw_screen()
             get_logger()->Write("PlatformScreen", LogNotice, "draw_screen: menu->draw() end");
         }
 
-        // draw_bufferをフレームバッファに描画
-        draw_frame_buffer();
+        // draw_bufferのうちメニューが描き換えた行だけをフレームバッファに描画
+        draw_frame_buffer(m_menu->get_fb_console());
         return 1;
     }
 
@@ -167,27 +180,110 @@ int PlatformScreen::draw_screen()
     if(debugdraw) {
         get_logger()->Write("PlatformScreen", LogNotice, "draw_screen: stretch_blit");
     }
-    stretch_blit(m_screen_buffer.buffer, m_screen_buffer.width, m_screen_buffer.height, m_draw_buffer_ptr, m_draw_width, m_draw_height);
+    {
+        PROFILE_SCOPE(PROFILE_STRETCH_BLIT);
+        stretch_blit(m_screen_buffer.buffer, m_screen_buffer.width, m_screen_buffer.height, m_draw_buffer_ptr, m_draw_width, m_draw_height);
+    }
     if(debugdraw) {
         get_logger()->Write("PlatformScreen", LogNotice, "draw_screen: stretch_blit end");
     }
     debugdraw = false;
 
-    draw_frame_buffer();
+    if(m_overlay_visible) {
+        draw_overlay();
+    }
+
+    {
+        PROFILE_SCOPE(PROFILE_FRAME_BUFFER);
+        draw_frame_buffer();
+    }
 
     return 1;
 }
 
-void PlatformScreen::draw_frame_buffer()
+void PlatformScreen::set_overlay_text(int line, const char* text)
+{
+    if (line < 0 || line >= OVERLAY_MAX_LINES) return;
+
+    if (!text) {
+        text = "";
+    }
+    if (strncmp(m_overlay_text[line], text, OVERLAY_MAX_CHARS - 1) == 0) {
+        return;
+    }
+    strncpy(m_overlay_text[line], text, OVERLAY_MAX_CHARS - 1);
+    m_overlay_text[line][OVERLAY_MAX_CHARS - 1] = '\0';
+    m_overlay_changed = true;
+}
+
+// 文字列からオーバーレイを描き直す
+void PlatformScreen::update_overlay()
+{
+    m_overlay->clear();
+    for (int line = 0; line < OVERLAY_MAX_LINES; line++) {
+        const char* text = m_overlay_text[line];
+        if (text[0] == '\0') {
+            continue;
+        }
+        int y = line * OVERLAY_LINE_HEIGHT;
+        m_overlay->fill_rect(0, y, strlen(text) * 8 + 4, OVERLAY_LINE_HEIGHT, BLACK_COLOR, OVERLAY_BG_ALPHA);
+        m_overlay->draw_text(2, y + 1, text, WHITE_COLOR, BLACK_COLOR, OVERLAY_BG_ALPHA);
+    }
+    m_overlay_changed = false;
+}
+
+void PlatformScreen::draw_overlay()
+{
+    if (!m_overlay) return;
+
+    if (m_overlay_changed) {
+        update_overlay();
+    }
+
+    // 左上に重ねる(エミュ画面は毎フレーム描き直されるので消去は不要)
+    m_overlay->compose(m_draw_buffer_ptr, m_draw_width, m_draw_width, m_draw_height, 8, 8);
+
+    if (++m_overlay_frames >= OVERLAY_STATS_INTERVAL) {
+        u32 average_us, pixels, count;
+        if (m_overlay->get_compose_stats(&average_us, &pixels, &count)) {
+            get_logger()->Write("PlatformScreen", LogNotice, "overlay compose: %u us/frame, %u pixels (%u frames)", average_us, pixels, count);
+        }
+        m_overlay_frames = 0;
+    }
+}
+
+void PlatformScreen::draw_frame_buffer(FBConsole* dirty_console)
 {
     // 描画バッファをフレームバッファの中心に描画
     int dst_x = (m_frame_buffer_width - m_draw_width) / 2;
     int dst_y = (m_frame_buffer_height - m_draw_height) / 2;
-    for(int y = 0; y < m_draw_height; ++y) {
+
+    // dirty_consoleが指定されていれば、描き換えられた行だけを転送する
+    int start_y = 0;
+    int end_y = m_draw_height - 1;
+    if (dirty_console) {
+        if (!dirty_console->isDirty()) {
+            return;
+        }
+        start_y = dirty_console->getDirtyMin();
+        end_y = dirty_console->getDirtyMax();
+        if (end_y >= m_draw_height) {
+            end_y = m_draw_height - 1;
+        }
+    }
+
+    for(int y = start_y; y <= end_y; ++y) {
+        if (dirty_console && !dirty_console->isRowDirty(y)) {
+            continue;
+        }
         TScreenColor* src_ptr = m_draw_buffer_ptr + y * m_draw_width;
         TScreenColor* dst_ptr = m_frame_buffer_ptr + (dst_y + y) * m_frame_buffer_pitch + dst_x;
         memcpy(dst_ptr, src_ptr, m_draw_width * sizeof(TScreenColor));
     }
+
+    if (dirty_console) {
+        dirty_console->clearDirty();
+    }
 }
 
 void PlatformScreen::stretch_blit(TScreenColor* src, int src_width, int src_height, TScreenColor* dst, int dst_width, int dst_height)
@@ -4,17 +4,31 @@
 
 #include <circle/types.h>
 #include <circle/screen.h>
+#include <string.h>
 
 #include "PlatformInterface.h"
 
 #include "FBConsole.hpp"
 
+// 画面上に重ねて表示する文字列(計測結果など)
+#define OVERLAY_MAX_LINES 6
+#define OVERLAY_MAX_CHARS 64
+// 1行の高さと、オーバーレイ全体の大きさ(左右に2ドットの余白)
+#define OVERLAY_LINE_HEIGHT 10
+#define OVERLAY_WIDTH (OVERLAY_MAX_CHARS * 8 + 4)
+#define OVERLAY_HEIGHT (OVERLAY_MAX_LINES * OVERLAY_LINE_HEIGHT)
+// 背景の不透明度(0〜OVERLAY_ALPHA_OPAQUE)
+#define OVERLAY_BG_ALPHA 20
+// 合成にかかった時間をシリアルに出力する間隔(フレーム数)
+#define OVERLAY_STATS_INTERVAL 600
+
 typedef struct ScreenBitmap_s {
     int width, height;
     TScreenColor* buffer;
 } ScreenBitmap_t;
 
 class PlatformMenu;
+class PlatformOverlay;
 
 class PlatformScreen
 {
@@ -28,8 +42,14 @@ public:
         m_draw_buffer_ptr(nullptr),
         m_frame_buffer_pitch(0),
         m_device_invalidate(false),
-        m_xmap(nullptr)
-    {}
+        m_xmap(nullptr),
+        m_overlay(nullptr),
+        m_overlay_visible(false),
+        m_overlay_changed(false),
+        m_overlay_frames(0)
+    {
+        memset(m_overlay_text, 0, sizeof(m_overlay_text));
+    }
     ~PlatformScreen();
     void initialize(IPlatformEmulator* emulator, int host_width, int host_height, int emu_width, int emu_height, int aspect_width, int aspect_height, PlatformMenu* menu);
 
@@ -56,12 +76,18 @@ public:
     void set_host_window_size(int width, int height, bool mode);
 
     int draw_screen();
+
+    // オーバーレイ表示
+    void set_overlay_visible(bool visible) { m_overlay_visible = visible; }
+    bool is_overlay_visible() { return m_overlay_visible; }
+    void set_overlay_text(int line, const char* text);
 private:
     void init_screen_device(int width, int height);
     void update_draw_buffer(int width, int height);
     void stretch_blit(TScreenColor* src, int src_width, int src_height, TScreenColor* dst, int dst_width, int dst_height);
 
-    void draw_frame_buffer();
+    void draw_frame_buffer(FBConsole* dirty_console = nullptr);
+    void draw_overlay();
 
     int m_stretch_mode;
 
@@ -98,6 +124,16 @@ private:
     IPlatformEmulator* m_emulator;
 
     PlatformMenu* m_menu;
+
+    // オーバーレイ(エミュ画面を描画バッファに拡大した後に半透明で重ねる)
+    PlatformOverlay* m_overlay;
+    bool m_overlay_visible;
+    // 文字列が変わった時だけオーバーレイを描き直す
+    bool m_overlay_changed;
+    u32 m_overlay_frames;
+    char m_overlay_text[OVERLAY_MAX_LINES][OVERLAY_MAX_CHARS];
+
+    void update_overlay();
 };
 
 #endif
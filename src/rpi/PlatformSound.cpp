@@ -19,6 +19,7 @@
 #include "PlatformSound.h"
 #include "EmuController.h"
 #include "PlatformConfig.h"
+#include "PlatformProfiler.h"
 
 
 #if RPI_MODEL==3
@@ -46,6 +47,7 @@
 PlatformSound::PlatformSound():
     m_sound_device(nullptr),
     m_scheduler(nullptr),
+    m_output_enabled(true),
     m_mix_buffer(nullptr),
     m_emulator(nullptr)
 {
@@ -120,10 +122,17 @@ void PlatformSound::release()
 
 void PlatformSound::update(int* extra_frames)
 {
+    PROFILE_SCOPE(PROFILE_SOUND);
     *extra_frames = 0;
 
     m_sound_muted = false;
 
+    // 出力しない場合も生成は毎フレーム行う(バッファの空きに左右されず負荷が一定になる)
+    if (!m_output_enabled) {
+        if (m_emulator) m_emulator->create_sound(extra_frames);
+        return;
+    }
+
     if (!m_emulator || !m_sound_available || !m_sound_device) return;
 
     if (m_sound_available) {
@@ -17,6 +17,7 @@ class PlatformSound {
         bool m_sound_available;
         bool m_sound_started;
         bool m_sound_muted;
+        bool m_output_enabled;
 
         u16* m_mix_buffer;
 
@@ -34,6 +35,9 @@ class PlatformSound {
         void mute_sound();
         void stop_sound();
 
+        // falseの間はVMの音声を生成するだけで出力しない(ベンチマーク用)
+        void set_output_enabled(bool enabled) { m_output_enabled = enabled; }
+
         int get_sound_rate() { return m_sound_rate; }
         int get_sound_samples() { return m_sound_samples; }
 };
@@ -0,0 +1,90 @@
+#include "PlatformSpeed.h"
+#include "PlatformLog.h"
+
+#include <stdio.h>
+#include <string.h>
+
+PlatformSpeedMeter::PlatformSpeedMeter()
+:
+    m_cpu_clock_hz(0),
+    m_window_start_us(0),
+    m_emulated_us(0),
+    m_busy_us(0),
+    m_idle_us(0),
+    m_frames(0),
+    m_windows(0),
+    m_valid(false)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void PlatformSpeedMeter::add_run(int frames, u32 frame_us, u32 busy_us)
+{
+    m_frames += frames;
+    m_emulated_us += (u64)frames * frame_us;
+    m_busy_us += busy_us;
+}
+
+bool PlatformSpeedMeter::update(u64 now)
+{
+    if (m_window_start_us == 0) {
+        m_window_start_us = now;
+        m_emulated_us = 0;
+        m_busy_us = 0;
+        m_idle_us = 0;
+        m_frames = 0;
+        return false;
+    }
+    if (now - m_window_start_us < SPEED_WINDOW_US) {
+        return false;
+    }
+    finish_window(now);
+    return true;
+}
+
+void PlatformSpeedMeter::finish_window(u64 now)
+{
+    u64 wall_us = now - m_window_start_us;
+
+    m_stats.wall_us = (u32)wall_us;
+    m_stats.frames = m_frames;
+    m_stats.speed_permille = (u32)(m_emulated_us * 1000 / wall_us);
+    // フレームを進めていない場合は負荷も無い事にする
+    m_stats.load_permille = m_emulated_us ? (u32)(m_busy_us * 1000 / m_emulated_us) : 0;
+    m_stats.headroom_permille = 1000 - (s32)m_stats.load_permille;
+    // CPUのクロックは公称値から、実際に進んだ時間の割合で求める
+    m_stats.clock_hz = (u32)((u64)m_cpu_clock_hz * m_emulated_us / wall_us);
+    m_stats.idle_permille = (u32)(m_idle_us * 1000 / wall_us);
+    m_valid = true;
+
+    if (++m_windows >= SPEED_REPORT_WINDOWS) {
+        m_windows = 0;
+        get_logger()->Write("Speed", LogNotice, "speed %u.%u%% (%u.%03u MHz), load %u.%u%%, headroom %d%%, idle %u.%u%%, %u frames",
+            m_stats.speed_permille / 10, m_stats.speed_permille % 10,
+            m_stats.clock_hz / 1000000, (m_stats.clock_hz / 1000) % 1000,
+            m_stats.load_permille / 10, m_stats.load_permille % 10,
+            m_stats.headroom_permille / 10,
+            m_stats.idle_permille / 10, m_stats.idle_permille % 10, m_stats.frames);
+    }
+
+    m_window_start_us = now;
+    m_emulated_us = 0;
+    m_busy_us = 0;
+    m_idle_us = 0;
+    m_frames = 0;
+}
+
+void PlatformSpeedMeter::format(char* buffer, int size)
+{
+    if (!m_valid) {
+        snprintf(buffer, size, "speed: measuring");
+        return;
+    }
+    int length = snprintf(buffer, size, "%u%% / %u%% load", (m_stats.speed_permille + 5) / 10, (m_stats.load_permille + 5) / 10);
+    if (m_stats.clock_hz && length < size) {
+        length += snprintf(buffer + length, size - length, " %u.%03u MHz", m_stats.clock_hz / 1000000, (m_stats.clock_hz / 1000) % 1000);
+    }
+    if (length < size) {
+        snprintf(buffer + length, size - length, ", idle %u%%", (m_stats.idle_permille + 5) / 10);
+    }
+}
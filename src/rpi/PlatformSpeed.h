@@ -0,0 +1,65 @@
+#ifndef _PLATFORM_SPEED_H_
+#define _PLATFORM_SPEED_H_
+
+#include <circle/types.h>
+
+// 集計の間隔(マイクロ秒)
+#define SPEED_WINDOW_US 1000000
+// シリアルへの出力間隔(集計の回数)
+#define SPEED_REPORT_WINDOWS 5
+
+// 1回の集計結果(割合は1000で100%)
+struct PlatformSpeedStats {
+    u32 speed_permille;     // 実時間に対して進んだエミュレーション時間(1000で等速)
+    u32 load_permille;      // 進めたフレームの時間のうち、実行と描画に使った時間
+    s32 headroom_permille;  // 1000 - load(負なら等速を保てない)
+    u32 clock_hz;           // 実際に達成したエミュレーションのクロック(CPUのクロックが不明なら0)
+    u32 idle_permille;      // 実時間のうち、WFIでコアを止めていた時間
+    u32 frames;             // 集計中に進めたフレーム数
+    u32 wall_us;            // 集計した実時間
+};
+
+/// @brief エミュレーションの速度と、フレーム時間に対する処理の重さを1秒ごとに集計する
+/// VMの作者がPi 3/Pi 4でどれだけ処理に余裕があるかを確認するためのもの
+class PlatformSpeedMeter {
+    private:
+        u32 m_cpu_clock_hz;
+
+        u64 m_window_start_us;
+        u64 m_emulated_us;
+        u64 m_busy_us;
+        u64 m_idle_us;
+        u32 m_frames;
+        u32 m_windows;
+
+        PlatformSpeedStats m_stats;
+        bool m_valid;
+
+        void finish_window(u64 now);
+
+    public:
+        PlatformSpeedMeter();
+
+        // VMのCPUクロック(Hz)。実際のクロックの計算に使う(0なら計算しない)
+        void set_cpu_clock(u32 hz) { m_cpu_clock_hz = hz; }
+
+        // VMをframes進めた(frame_usは1フレームのエミュレーション時間、busy_usは実行にかかった時間)
+        void add_run(int frames, u32 frame_us, u32 busy_us);
+        // 画面の描画にかかった時間
+        void add_busy(u32 busy_us) { m_busy_us += busy_us; }
+        // WFIで待っていた時間
+        void add_idle(u32 idle_us) { m_idle_us += idle_us; }
+
+        // メインループごとに呼ぶ。集計が終わった場合はtrueを返す
+        bool update(u64 now);
+        // メニュー表示中などVMを止めている間の時間を集計から外す
+        void restart() { m_window_start_us = 0; }
+
+        // 最後に集計した結果(まだ無ければnullptr)
+        const PlatformSpeedStats* get_stats() { return m_valid ? &m_stats : nullptr; }
+
+        // オーバーレイ表示用の文字列を作る("100% / 63% load, idle 30%")
+        void format(char* buffer, int size);
+};
+
+#endif
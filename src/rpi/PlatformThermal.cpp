@@ -0,0 +1,98 @@
+#include "PlatformThermal.h"
+#include "PlatformLog.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char* s_level_names[] = { "normal", "warm", "throttled" };
+
+PlatformThermal::PlatformThermal(IPlatformThermalSource* source)
+:
+    m_source(source),
+    m_next_poll_us(0),
+    m_max_clock_hz(0),
+    m_start_clock_mhz(0),
+    m_clock_mhz(0),
+    m_valid(false),
+    m_level(THERMAL_LEVEL_NORMAL)
+{
+    memset(&m_sample, 0, sizeof(m_sample));
+}
+
+PlatformThermal::~PlatformThermal()
+{
+    if (m_source) {
+        delete m_source;
+        m_source = nullptr;
+    }
+}
+
+int PlatformThermal::classify(const PlatformThermalSample* sample, u32 clock_mhz)
+{
+    if (sample->flags & (THERMAL_FLAG_UNDER_VOLTAGE | THERMAL_FLAG_FREQ_CAPPED | THERMAL_FLAG_THROTTLED)) {
+        return THERMAL_LEVEL_THROTTLED;
+    }
+    // クロックを最大まで上げる処理は無いので、最大クロックではなく起動時のクロックと比べる
+    if (clock_mhz * 100 < m_start_clock_mhz * THERMAL_CLOCK_DROP_PERCENT) {
+        return THERMAL_LEVEL_THROTTLED;
+    }
+    if ((sample->flags & THERMAL_FLAG_SOFT_TEMP) || sample->temperature >= THERMAL_WARM_TEMPERATURE) {
+        return THERMAL_LEVEL_WARM;
+    }
+    return THERMAL_LEVEL_NORMAL;
+}
+
+bool PlatformThermal::update(u64 now)
+{
+    if (!m_source || now < m_next_poll_us) {
+        return false;
+    }
+    m_next_poll_us = now + THERMAL_POLL_INTERVAL_US;
+
+    // 最大クロックは最初に一度だけ取得する
+    if (m_max_clock_hz == 0) {
+        m_max_clock_hz = m_source->get_max_clock();
+    }
+
+    PlatformThermalSample sample;
+    if (!m_source->read(&sample)) {
+        return false;
+    }
+
+    u32 clock_mhz = sample.clock_hz / 1000000;
+    if (m_start_clock_mhz == 0) {
+        m_start_clock_mhz = clock_mhz;
+    }
+    bool clock_changed = !m_valid ||
+        (clock_mhz > m_clock_mhz ? clock_mhz - m_clock_mhz : m_clock_mhz - clock_mhz) >= THERMAL_CLOCK_CHANGE_MHZ;
+    if (clock_changed) {
+        m_clock_mhz = clock_mhz;
+    }
+
+    int level = classify(&sample, m_clock_mhz);
+    bool changed = clock_changed || level != m_level ||
+        (sample.flags & THERMAL_FLAG_NOW_MASK) != (m_sample.flags & THERMAL_FLAG_NOW_MASK);
+
+    if (changed) {
+        get_logger()->Write("Thermal", level > THERMAL_LEVEL_NORMAL ? LogWarning : LogNotice,
+            "%u.%uC, ARM %u MHz (start %u MHz, max %u MHz), flags 0x%05x, %s",
+            sample.temperature / 1000, (sample.temperature % 1000) / 100,
+            m_clock_mhz, m_start_clock_mhz, m_max_clock_hz / 1000000, sample.flags, s_level_names[level]);
+    }
+
+    m_sample = sample;
+    m_level = level;
+    m_valid = true;
+    return changed;
+}
+
+void PlatformThermal::format(char* buffer, int size)
+{
+    if (!m_valid) {
+        snprintf(buffer, size, "thermal: unknown");
+        return;
+    }
+    snprintf(buffer, size, "%u.%uC %u/%u MHz %s",
+        m_sample.temperature / 1000, (m_sample.temperature % 1000) / 100,
+        m_clock_mhz, m_max_clock_hz / 1000000, s_level_names[m_level]);
+}
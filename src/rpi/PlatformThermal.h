@@ -0,0 +1,88 @@
+#ifndef _PLATFORM_THERMAL_H_
+#define _PLATFORM_THERMAL_H_
+
+#include <circle/types.h>
+
+// 温度とクロックを読み取る間隔(マイクロ秒)。ファームウェアへの問い合わせは数百マイクロ秒かかる
+#define THERMAL_POLL_INTERVAL_US 1000000
+// この温度(ミリ℃)を超えたら、スロットリングされる前の注意の段階とする
+#define THERMAL_WARM_TEMPERATURE 75000
+// 起動時のクロックに対してこの割合(%)を下回ったら、スロットリングされているとみなす
+#define THERMAL_CLOCK_DROP_PERCENT 90
+// ARMクロックがこれ以上(MHz)変わった場合だけ変化とみなす(実測値は読むたびに少しずつ違う)
+#define THERMAL_CLOCK_CHANGE_MHZ 10
+
+// PROPTAG_GET_THROTTLEDのフラグ(現在の状態。上位16ビットは起動後に発生したかどうか)
+#define THERMAL_FLAG_UNDER_VOLTAGE  0x01
+#define THERMAL_FLAG_FREQ_CAPPED    0x02
+#define THERMAL_FLAG_THROTTLED      0x04
+#define THERMAL_FLAG_SOFT_TEMP      0x08
+#define THERMAL_FLAG_NOW_MASK       0x0F
+
+// 状態の段階
+enum ThermalLevel {
+    THERMAL_LEVEL_NORMAL = 0,
+    THERMAL_LEVEL_WARM,         // 高温またはソフトウェアの温度制限中(まだクロックは下がっていない)
+    THERMAL_LEVEL_THROTTLED     // クロックが下がっている(電圧不足を含む)
+};
+
+struct PlatformThermalSample {
+    u32 temperature;    // ミリ℃
+    u32 clock_hz;       // 現在のARMクロック
+    u32 flags;          // THERMAL_FLAG_*
+};
+
+/// @brief 温度とクロックの取得元(ホスト上で試す場合は差し替える)
+class IPlatformThermalSource {
+    public:
+        virtual ~IPlatformThermalSource() {}
+
+        // ARMの最大クロック(取得できなければ0)
+        virtual u32 get_max_clock() = 0;
+        virtual bool read(PlatformThermalSample* sample) = 0;
+};
+
+/// @brief ファームウェアのメールボックス(プロパティタグ)から取得する(PlatformThermalMailbox.cpp)
+class PlatformMailboxThermalSource : public IPlatformThermalSource {
+    public:
+        u32 get_max_clock();
+        bool read(PlatformThermalSample* sample);
+};
+
+/// @brief SoCの温度、ARMクロック、スロットリングのフラグを定期的に読み取り、変化をシリアルに出力する
+class PlatformThermal {
+    private:
+        IPlatformThermalSource* m_source;
+
+        u64 m_next_poll_us;
+        u32 m_max_clock_hz;
+        // 最初に読み取ったクロックと、最後に変化とみなしたクロック(MHz)
+        u32 m_start_clock_mhz;
+        u32 m_clock_mhz;
+
+        PlatformThermalSample m_sample;
+        bool m_valid;
+        int m_level;
+
+        int classify(const PlatformThermalSample* sample, u32 clock_mhz);
+
+    public:
+        // sourceは破棄時にdeleteする
+        PlatformThermal(IPlatformThermalSource* source);
+        ~PlatformThermal();
+
+        // メインループごとに呼ぶ。段階、クロック、フラグのどれかが変わった場合はtrueを返す
+        bool update(u64 now);
+
+        int get_level() { return m_level; }
+        u32 get_max_clock() { return m_max_clock_hz; }
+        // 変化とみなした時点のARMクロック(MHz単位に丸めたHz。読み取るたびの揺れは含まない)
+        u32 get_clock() { return m_clock_mhz * 1000000; }
+        // 最後に読み取った値(まだ無ければnullptr)
+        const PlatformThermalSample* get_sample() { return m_valid ? &m_sample : nullptr; }
+
+        // オーバーレイ表示用の文字列を作る("62.3C 1200/1400 MHz throttled")
+        void format(char* buffer, int size);
+};
+
+#endif
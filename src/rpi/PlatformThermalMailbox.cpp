@@ -0,0 +1,65 @@
+#include "PlatformThermal.h"
+
+#include <circle/bcmpropertytags.h>
+
+// 古いCircleのヘッダーに無いものを補う
+#ifndef PROPTAG_GET_MAX_CLOCK_RATE
+#define PROPTAG_GET_MAX_CLOCK_RATE 0x00030004
+#endif
+#ifndef PROPTAG_GET_CLOCK_RATE_MEASURED
+#define PROPTAG_GET_CLOCK_RATE_MEASURED 0x00030047
+#endif
+#ifndef PROPTAG_GET_THROTTLED
+#define PROPTAG_GET_THROTTLED 0x00030046
+#endif
+#ifndef CLOCK_ID_ARM
+#define CLOCK_ID_ARM 3
+#endif
+#ifndef TEMPERATURE_ID
+#define TEMPERATURE_ID 0
+#endif
+
+struct ThermalThrottledTag {
+    TPropertyTag Tag;
+    u32 nValue;
+};
+
+u32 PlatformMailboxThermalSource::get_max_clock()
+{
+    CBcmPropertyTags tags;
+    TPropertyTagClockRate clock;
+    clock.nClockId = CLOCK_ID_ARM;
+    if (!tags.GetTag(PROPTAG_GET_MAX_CLOCK_RATE, &clock, sizeof(clock), 4)) {
+        return 0;
+    }
+    return clock.nRate;
+}
+
+bool PlatformMailboxThermalSource::read(PlatformThermalSample* sample)
+{
+    CBcmPropertyTags tags;
+
+    TPropertyTagTemperature temperature;
+    temperature.nTemperatureId = TEMPERATURE_ID;
+    if (!tags.GetTag(PROPTAG_GET_TEMPERATURE, &temperature, sizeof(temperature), 4)) {
+        return false;
+    }
+    sample->temperature = temperature.nValue;
+
+    // 実測の周波数(ファームウェアが下げた場合も反映される)。古いファームウェアでは設定値を使う
+    TPropertyTagClockRate clock;
+    clock.nClockId = CLOCK_ID_ARM;
+    if (!tags.GetTag(PROPTAG_GET_CLOCK_RATE_MEASURED, &clock, sizeof(clock), 4)) {
+        clock.nClockId = CLOCK_ID_ARM;
+        if (!tags.GetTag(PROPTAG_GET_CLOCK_RATE, &clock, sizeof(clock), 4)) {
+            return false;
+        }
+    }
+    sample->clock_hz = clock.nRate;
+
+    // 対応していないファームウェアではフラグ無しとする
+    ThermalThrottledTag throttled;
+    throttled.nValue = 0;
+    sample->flags = tags.GetTag(PROPTAG_GET_THROTTLED, &throttled, sizeof(throttled), 4) ? throttled.nValue : 0;
+    return true;
+}
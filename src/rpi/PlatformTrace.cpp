@@ -0,0 +1,142 @@
+#include "PlatformTrace.h"
+#include "PlatformLog.h"
+
+#include <circle/timer.h>
+#include <string.h>
+
+#ifdef USE_PROFILER
+static PlatformTrace s_trace;
+
+PlatformTrace* get_trace()
+{
+    return &s_trace;
+}
+#endif
+
+// 記録したコアの番号(MPIDRの下位ビット)
+static inline u8 get_core_id()
+{
+#if defined(__arm__)
+    u32 mpidr;
+    asm volatile ("mrc p15, 0, %0, c0, c0, 5" : "=r" (mpidr));
+    return mpidr & (TRACE_MAX_CORES - 1);
+#elif defined(__aarch64__)
+    u64 mpidr;
+    asm volatile ("mrs %0, mpidr_el1" : "=r" (mpidr));
+    return mpidr & (TRACE_MAX_CORES - 1);
+#else
+    return 0;
+#endif
+}
+
+// JSONの文字列として書き出す(名前はリテラルなので制御文字は想定しない)
+static void write_json_string(FILE* fp, const char* text)
+{
+    fputc('"', fp);
+    for (; *text; text++) {
+        if (*text == '"' || *text == '\\') {
+            fputc('\\', fp);
+        }
+        fputc(*text, fp);
+    }
+    fputc('"', fp);
+}
+
+PlatformTrace::PlatformTrace()
+:
+    m_write(0),
+    m_recording(true)
+{
+}
+
+void PlatformTrace::record(u8 type, const char* name, u64 timestamp)
+{
+    if (!m_recording) {
+        return;
+    }
+
+    u32 index = __atomic_fetch_add(&m_write, 1, __ATOMIC_RELAXED);
+    TraceEvent* event = &m_events[index & (TRACE_RING_SIZE - 1)];
+    event->timestamp = (u32)timestamp;
+    event->name = name;
+    event->type = type;
+    event->core = get_core_id();
+}
+
+void PlatformTrace::record(u8 type, const char* name)
+{
+    record(type, name, CTimer::GetClockTicks64());
+}
+
+bool PlatformTrace::write_json(FILE* fp)
+{
+    bool recording = m_recording;
+    m_recording = false;
+
+    u32 end = m_write;
+    u32 count = get_count();
+    u32 start = end - count;
+
+    // 時刻は最初のイベントからの相対値にする(下位32ビットが一周していても差は正しく求まる)
+    u32 base = count ? m_events[start & (TRACE_RING_SIZE - 1)].timestamp : 0;
+
+    // リングが一周して始まりが失われた区間は終わりも書き出さない
+    int depth[TRACE_MAX_CORES] = { 0 };
+
+    fputs("{\"traceEvents\":[\n", fp);
+    for (int core = 0; core < TRACE_MAX_CORES; core++) {
+        fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"core %d\"}}",
+            core ? ",\n" : "", core, core);
+    }
+
+    for (u32 i = start; i != end; i++) {
+        const TraceEvent* event = &m_events[i & (TRACE_RING_SIZE - 1)];
+        if (!event->name) {
+            continue;
+        }
+        int core = event->core;
+        if (event->type == TRACE_EVENT_END) {
+            if (depth[core] == 0) {
+                continue;
+            }
+            depth[core]--;
+        } else if (event->type == TRACE_EVENT_BEGIN) {
+            depth[core]++;
+        }
+
+        // コアの名前のメタデータが必ず先にあるので、各イベントの前に区切りを書く
+        fputs(",\n{\"name\":", fp);
+        write_json_string(fp, event->name);
+        fprintf(fp, ",\"ph\":\"%c\",\"ts\":%u,\"pid\":1,\"tid\":%d", event->type, event->timestamp - base, core);
+        if (event->type == TRACE_EVENT_INSTANT) {
+            fputs(",\"s\":\"t\"", fp);
+        }
+        fputc('}', fp);
+    }
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", fp);
+
+    m_recording = recording;
+    return ferror(fp) == 0;
+}
+
+bool PlatformTrace::dump(const char* path)
+{
+    u64 start = CTimer::GetClockTicks64();
+
+    FILE* fp = fopen(path, "w");
+    if (!fp) {
+        get_logger()->Write("Trace", LogError, "Failed to open %s", path);
+        return false;
+    }
+    u32 count = get_count();
+    bool result = write_json(fp);
+    fclose(fp);
+
+    u32 elapsed_ms = (u32)((CTimer::GetClockTicks64() - start) / 1000);
+    if (result) {
+        get_logger()->Write("Trace", LogNotice, "%u events written to %s (%u ms)", count, path, elapsed_ms);
+    } else {
+        get_logger()->Write("Trace", LogError, "Failed to write %s", path);
+    }
+    return result;
+}
@@ -0,0 +1,74 @@
+#ifndef _PLATFORM_TRACE_H_
+#define _PLATFORM_TRACE_H_
+
+#include <circle/types.h>
+#include <stdio.h>
+
+// 保持するイベント数(2のべき乗、1イベント16バイト(32ビットでは12バイト))
+#define TRACE_RING_SIZE 16384
+// 書き出し時に区別するコアの数
+#define TRACE_MAX_CORES 4
+
+// イベントの種類(Chrome trace-eventの"ph")
+enum TraceEventType {
+    TRACE_EVENT_BEGIN = 'B',
+    TRACE_EVENT_END = 'E',
+    TRACE_EVENT_INSTANT = 'i'
+};
+
+// 名前は文字列リテラルなど、書き出すまで残っているものを渡す
+// 時刻は下位32ビットだけ持つ(書き出す時は最初のイベントとの差にするので、リングの範囲が71分以内なら戻らない)
+struct TraceEvent {
+    const char* name;
+    u32 timestamp;      // マイクロ秒
+    u8 type;
+    u8 core;
+    u8 reserved[2];
+};
+
+static_assert(sizeof(TraceEvent) <= 16, "TraceEvent must fit in 16 bytes");
+
+/// @brief 直近のイベントを固定長のリングに記録し、Chrome trace-event形式(JSON)で書き出す
+/// 書き出したファイルはchrome://tracingやPerfettoでそのまま開ける
+/// 記録は割り込みハンドラや他のコアからも行える(書き込み位置は不可分に進める)
+class PlatformTrace {
+    private:
+        TraceEvent m_events[TRACE_RING_SIZE];
+        volatile u32 m_write;
+        volatile bool m_recording;
+
+    public:
+        PlatformTrace();
+
+        void record(u8 type, const char* name, u64 timestamp);
+        void record(u8 type, const char* name);
+
+        // リングの内容を古い順に書き出す(書き出している間は記録を止める)
+        bool write_json(FILE* fp);
+        bool dump(const char* path);
+
+        u32 get_count() { return m_write < TRACE_RING_SIZE ? m_write : TRACE_RING_SIZE; }
+};
+
+extern PlatformTrace* get_trace();
+
+/// @brief 生成から破棄までを1つの区間として記録する
+class TraceScope {
+    private:
+        const char* m_name;
+
+    public:
+        TraceScope(const char* name) : m_name(name) { get_trace()->record(TRACE_EVENT_BEGIN, name); }
+        ~TraceScope() { get_trace()->record(TRACE_EVENT_END, m_name); }
+};
+
+// PROFILE_SCOPEと同じくUSE_PROFILERが定義されていない場合は何もしない
+#ifdef USE_PROFILER
+#define TRACE_SCOPE(name) TraceScope trace_scope(name)
+#define TRACE_INSTANT(name) get_trace()->record(TRACE_EVENT_INSTANT, name)
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_INSTANT(name)
+#endif
+
+#endif
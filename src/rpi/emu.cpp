@@ -2,6 +2,7 @@
 #include "PlatformScreen.h"
 #include "PlatformSound.h"
 #include "PlatformLog.h"
+#include "PlatformDeferredLog.h"
 
 extern PlatformScreen* g_platform_screen;
 extern PlatformSound* g_platform_sound;
@@ -42,12 +43,12 @@ int EMU::run()
 
 void EMU::reset()
 {
-    get_logger()->Write("EMU", LogNotice, "Resetting emulator");
+    DEFERRED_LOG(EMU, LogNotice, "Resetting emulator");
 }
 
 void EMU::special_reset()
 {
-    get_logger()->Write("EMU", LogNotice, "Special reset");
+    DEFERRED_LOG(EMU, LogNotice, "Special reset");
 }
 
 void EMU::draw_screen()
@@ -57,7 +58,7 @@ void EMU::draw_screen()
 
 void EMU::key_down(int code, bool extended, bool repeat)
 {
-    get_logger()->Write("EMU", LogNotice, "Key down: %d, extended: %d, repeat: %d", code, extended, repeat);
+    DEFERRED_LOG(EMU, LogNotice, "Key down: %d, extended: %d, repeat: %d", code, extended, repeat);
 
     // 中間コードで加工してから送ってやるのが良いがとりあえずここではこのまま送る
     mpVM->key_down(code, repeat);
@@ -65,7 +66,7 @@ void EMU::key_down(int code, bool extended, bool repeat)
 
 void EMU::key_up(int code, bool extended)
 {
-    get_logger()->Write("EMU", LogNotice, "Key up: %d, extended: %d", code, extended);
+    DEFERRED_LOG(EMU, LogNotice, "Key up: %d, extended: %d", code, extended);
 
     // 中間コードで加工してから送ってやるのが良いがとりあえずここではこのまま送る
     mpVM->key_up(code);
@@ -73,73 +74,73 @@ void EMU::key_up(int code, bool extended)
 
 void EMU::key_char(char code)
 {
-    get_logger()->Write("EMU", LogNotice, "Key char: %c", code);
+    DEFERRED_LOG(EMU, LogNotice, "Key char: %c", code);
 }
 
 void EMU::open_floppy_disk(int drv, const char* file_path, int bank)
 {
-    get_logger()->Write("EMU", LogNotice, "Open floppy disk: %d, file_path: %s, bank: %d", drv, file_path, bank);
+    DEFERRED_LOG(EMU, LogNotice, "Open floppy disk: %d, file_path: %s, bank: %d", drv, file_path, bank);
 }
 
 void EMU::close_floppy_disk(int drv)
 {
-    get_logger()->Write("EMU", LogNotice, "Close floppy disk: %d", drv);
+    DEFERRED_LOG(EMU, LogNotice, "Close floppy disk: %d", drv);
 }
 
 bool EMU::is_floppy_disk_inserted(int drv)
 {
-    get_logger()->Write("EMU", LogNotice, "Is floppy disk inserted: %d", drv);
+    DEFERRED_LOG(EMU, LogNotice, "Is floppy disk inserted: %d", drv);
     return false;
 }
 
 void EMU::play_tape(int drv, const char* file_path)
 {
-    get_logger()->Write("EMU", LogNotice, "Play tape: %d, file_path: %s", drv, file_path);
+    DEFERRED_LOG(EMU, LogNotice, "Play tape: %d, file_path: %s", drv, file_path);
 }
 
 void EMU::rec_tape(int drv, const char* file_path)
 {
-    get_logger()->Write("EMU", LogNotice, "Rec tape: %d, file_path: %s", drv, file_path);
+    DEFERRED_LOG(EMU, LogNotice, "Rec tape: %d, file_path: %s", drv, file_path);
 }
 
 void EMU::close_tape(int drv)
 {
-    get_logger()->Write("EMU", LogNotice, "Close tape: %d", drv);
+    DEFERRED_LOG(EMU, LogNotice, "Close tape: %d", drv);
 }
 
 void EMU::push_play(int drv)
 {
-    get_logger()->Write("EMU", LogNotice, "Push play: %d", drv);
+    DEFERRED_LOG(EMU, LogNotice, "Push play: %d", drv);
 }
 
 void EMU::push_stop(int drv)
 {
-    get_logger()->Write("EMU", LogNotice, "Push stop: %d", drv);
+    DEFERRED_LOG(EMU, LogNotice, "Push stop: %d", drv);
 }
 
 void EMU::push_fast_forward(int drv)
 {
-    get_logger()->Write("EMU", LogNotice, "Push fast forward: %d", drv);
+    DEFERRED_LOG(EMU, LogNotice, "Push fast forward: %d", drv);
 }
 
 void EMU::push_fast_rewind(int drv)
 {
-    get_logger()->Write("EMU", LogNotice, "Push fast rewind: %d", drv);
+    DEFERRED_LOG(EMU, LogNotice, "Push fast rewind: %d", drv);
 }
 
 void EMU::push_apss_forward(int drv)
 {
-    get_logger()->Write("EMU", LogNotice, "Push apss forward: %d", drv);
+    DEFERRED_LOG(EMU, LogNotice, "Push apss forward: %d", drv);
 }
 
 void EMU::push_apss_rewind(int drv)
 {
-    get_logger()->Write("EMU", LogNotice, "Push apss rewind: %d", drv);
+    DEFERRED_LOG(EMU, LogNotice, "Push apss rewind: %d", drv);
 }
 
 bool EMU::is_tape_inserted(int drv)
 {
-    get_logger()->Write("EMU", LogNotice, "Is tape inserted: %d", drv);
+    DEFERRED_LOG(EMU, LogNotice, "Is tape inserted: %d", drv);
     return false;
 }
 
@@ -182,5 +183,10 @@ int EMU::get_frame_interval()
 void EMU::update_config()
 {
     // g_platform_config の内容をエミュ/VMに反映させる場合はここで対応する
-    get_logger()->Write("EMU", LogNotice, "Update config");
+    DEFERRED_LOG(EMU, LogNotice, "Update config");
+}
+
+u32 EMU::get_ram_hash()
+{
+    return mpVM->get_ram_hash();
 }
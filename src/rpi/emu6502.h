@@ -50,6 +50,8 @@ class EMU
         int get_frame_interval();
 
         void update_config();
+
+        u32 get_ram_hash();
 };
 
 #endif // EMU_H
\ No newline at end of file
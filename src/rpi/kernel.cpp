@@ -39,6 +39,8 @@
 #include "PlatformSound.h"
 #include "PlatformMenu.h"
 #include "PlatformConfig.h"
+#include "PlatformBootCache.h"
+#include "PlatformTrace.h"
 #include "EmuController.h"
 
 
@@ -46,7 +48,15 @@ SystemConfiguration* config_; // SystemConfiguration変数を宣言
 
 EmuController* pEmuController;
 
-uint32_t rpi_gamepad_status[4];
+// VMが参照するゲームパッドの状態(メインループがフレームごとにrpi_gamepad_liveから写す)
+uint32_t rpi_gamepad_status[MAX_GAMEPADS];
+// USBハンドラが書き込むゲームパッドの最新状態
+volatile uint32_t rpi_gamepad_live[MAX_GAMEPADS];
+// ゲームパッドの状態が変化した時刻(入力遅延の計測用)
+volatile u64 rpi_gamepad_timestamp[MAX_GAMEPADS];
+
+// ゲームパッドごとのボタン割り当て(ビットマスクに展開済み)
+static GamePadMapping s_gamepad_mapping[MAX_GAMEPADS];
 
 // winmain.cppのemulator_main関数を外部関数として宣言
 // CLoggerポインタを引数として追加
@@ -77,10 +87,17 @@ CKernel::CKernel (const char *pPartitionName)
     mVCHIQ(CMemorySystem::Get(), &mInterrupt),
     mSound(&mVCHIQ, VCHIQSoundDestinationHDMI),
     mEMMC (&mInterrupt, &mTimer, &mActLED),
-    mKeyboard(nullptr),
-    mGamePad(nullptr)
+    mEmuController(nullptr)
 {
 	mActLED.Blink (5);	// show we are alive
+
+    for (int i = 0; i < MAX_KEYBOARDS; i++) {
+        mKeyboards[i] = nullptr;
+    }
+    memset(mKeyboardStates, 0, sizeof(mKeyboardStates));
+    for (int i = 0; i < MAX_GAMEPADS; i++) {
+        mGamePads[i] = nullptr;
+    }
 }
 
 
@@ -107,10 +124,13 @@ CLogger*         g_pLogger = nullptr;
 CLogger*         get_logger() { return g_pLogger; }
 
 // USBキーボードからのRAWキー入力に対するハンドラ - キーイベントをバッファに追加するだけの軽量実装
+// argは登録時に渡したキーボードごとのKeyboardState
 void CKernel::KeyStatusHandlerRaw(unsigned char ucModifiers, const unsigned char RawKeys[6], void* arg)
 {
-    static unsigned char s_PreviousRawKeys[6] = {0};
-    static unsigned char s_ucPrevModifiers = 0;
+    TRACE_INSTANT("usb key");
+    KeyboardState* state = static_cast<KeyboardState*>(arg);
+    unsigned char* s_PreviousRawKeys = state->prev_keys;
+    unsigned char& s_ucPrevModifiers = state->prev_modifiers;
 
     // モディファイアキーの変化を処理し、バッファに追加
     if (ucModifiers != s_ucPrevModifiers) {
@@ -212,105 +232,109 @@ void CKernel::KeyStatusHandlerRaw(unsigned char ucModifiers, const unsigned char
     }
     
     // 現在の状態を保存
-    memcpy(s_PreviousRawKeys, RawKeys, sizeof(s_PreviousRawKeys));
+    memcpy(s_PreviousRawKeys, RawKeys, sizeof(state->prev_keys));
 }
 
 // ジョイスティック/ゲームパッド入力に対するハンドラ
+// nDeviceIndexは0始まり(upad1が0)で、そのままスロット番号として使う
 void CKernel::GamePadStatusHandler(unsigned nDeviceIndex, const TGamePadState *pState)
 {
-    // ジョイスティックの状態をエミュレータに伝える
-    uint32_t joy_state = 0;
-    
-    // config_を使用して各ボタンの状態をチェック
-    if (config_) {
-        // 方向ボタンをチェック
-        if (config_->buttonLeft->check(pState)) {
-            joy_state |= 0x00000004;  // LEFT - ビット2
-        }
-        if (config_->buttonRight->check(pState)) {
-            joy_state |= 0x00000008;  // RIGHT - ビット3
-        }
-        if (config_->buttonUp->check(pState)) {
-            joy_state |= 0x00000001;  // UP - ビット0
-        }
-        if (config_->buttonDown->check(pState)) {
-            joy_state |= 0x00000002;  // DOWN - ビット1
-        }
-        
-        // アクションボタンをチェック
-        if (config_->buttonA->check(pState)) {
-            joy_state |= (1 << 4);  // A - ビット4
-        }
-        if (config_->buttonB->check(pState)) {
-            joy_state |= (1 << 5);  // B - ビット5
-        }
-        
-        // スタート・セレクトボタンをチェック
-        if (config_->buttonStart->check(pState)) {
-            joy_state |= (1 << 9);  // START - ビット9
-        }
-        if (config_->buttonSelect->check(pState)) {
-            joy_state |= (1 << 8);  // SELECT - ビット8
-        }
-    } else {
-        // config_がない場合は従来の方法で処理
-        // デジタル方向ボタンの状態をチェック
-        if (pState->buttons & GamePadButtonUp) {
-            joy_state |= 0x00000001;  // UP - ビット0
-        }
-        if (pState->buttons & GamePadButtonDown) {
-            joy_state |= 0x00000002;  // DOWN - ビット1
-        }
-        if (pState->buttons & GamePadButtonLeft) {
-            joy_state |= 0x00000004;  // LEFT - ビット2
-        }
-        if (pState->buttons & GamePadButtonRight) {
-            joy_state |= 0x00000008;  // RIGHT - ビット3
-        }
-        
-        // アナログスティックの状態をチェック（閾値を超えたら方向入力とみなす）
-        if (pState->naxes > 0) {
-            if (pState->axes[0].value < 64) {    // X軸左方向
-                joy_state |= 0x00000004;  // LEFT - ビット2
-            }
-            if (pState->axes[0].value > 192) {   // X軸右方向
-                joy_state |= 0x00000008;  // RIGHT - ビット3
-            }
-        }
-        
-        if (pState->naxes > 1) {
-            if (pState->axes[1].value < 64) {    // Y軸上方向
-                joy_state |= 0x00000001;  // UP - ビット0
-            }
-            if (pState->axes[1].value > 192) {   // Y軸下方向
-                joy_state |= 0x00000002;  // DOWN - ビット1
-            }
-        }
-        
-        // ボタンの状態をチェック
-        if (pState->buttons & GamePadButtonA) {
-            joy_state |= (1 << 4);  // A - ビット4
-        }
-        if (pState->buttons & GamePadButtonB) {
-            joy_state |= (1 << 5);  // B - ビット5
-        }
-        if (pState->buttons & GamePadButtonStart) {
-            joy_state |= (1 << 9);  // START - ビット9
-        }
-        if (pState->buttons & GamePadButtonSelect) {
-            joy_state |= (1 << 8);  // SELECT - ビット8
+    if (nDeviceIndex >= MAX_GAMEPADS) {
+        return;
+    }
+
+    // 軸の数が変わった(初回含む)時だけ割り当てを作り直す
+    GamePadMapping& mapping = s_gamepad_mapping[nDeviceIndex];
+    if (!mapping.is_built_for(pState->naxes)) {
+        mapping.build(config_, pState->naxes);
+    }
+
+    uint32_t joy_state = mapping.map(pState);
+
+    // 状態が変化した時刻を記録しておく
+    if (rpi_gamepad_live[nDeviceIndex] != joy_state) {
+        TRACE_INSTANT("usb gamepad");
+        rpi_gamepad_timestamp[nDeviceIndex] = CTimer::GetClockTicks64();
+        rpi_gamepad_live[nDeviceIndex] = joy_state;
+    }
+}
+
+void CKernel::KeyboardRemovedHandler(CDevice* pDevice, void* pContext)
+{
+    CKernel* kernel = static_cast<CKernel*>(pContext);
+    for (int i = 0; i < MAX_KEYBOARDS; i++) {
+        if (kernel->mKeyboards[i] == pDevice) {
+            kernel->mKeyboards[i] = nullptr;
+            memset(&kernel->mKeyboardStates[i], 0, sizeof(KeyboardState));
+            kernel->mLogger.Write(kernel->GetKernelName(), LogNotice, "USB keyboard %d removed", i + 1);
         }
     }
+}
 
-    // ジョイスティックの状態を更新（エミュレータが後で参照するためのグローバル変数を更新）
-    extern uint32_t rpi_gamepad_status[4];  // osd_input.cppで定義されている変数
-    if (nDeviceIndex < 4) {
-        // 念のため配列の0番目の要素にも設定する - 互換性のため
-        rpi_gamepad_status[0] = joy_state;
-        rpi_gamepad_status[nDeviceIndex] = joy_state;
+void CKernel::GamePadRemovedHandler(CDevice* pDevice, void* pContext)
+{
+    CKernel* kernel = static_cast<CKernel*>(pContext);
+    for (int i = 0; i < MAX_GAMEPADS; i++) {
+        if (kernel->mGamePads[i] == pDevice) {
+            kernel->mGamePads[i] = nullptr;
+            s_gamepad_mapping[i].invalidate();
+            rpi_gamepad_live[i] = 0;
+            kernel->mLogger.Write(kernel->GetKernelName(), LogNotice, "USB gamepad %d removed", i + 1);
+        }
     }
 }
 
+void CKernel::UpdateInputDevices(void)
+{
+	// 構成が変わっていなければ何もしない(初回は必ず検索する)
+	static bool s_first = true;
+	if (!mUSBHCI.UpdatePlugAndPlay() && !s_first) {
+		return;
+	}
+	s_first = false;
+
+	// キーボードデバイスを検索
+	for (int i = 0; i < MAX_KEYBOARDS; i++) {
+		if (mKeyboards[i] != nullptr) {
+			continue;
+		}
+		CUSBKeyboardDevice* keyboard = static_cast<CUSBKeyboardDevice *>(mDeviceNameService.GetDevice("ukbd", i + 1, FALSE));
+		if (keyboard == nullptr) {
+			continue;
+		}
+		mKeyboards[i] = keyboard;
+		memset(&mKeyboardStates[i], 0, sizeof(KeyboardState));
+
+		// キーボードイベントハンドラを登録(キーボードごとの状態を渡す)
+		keyboard->RegisterKeyStatusHandlerRaw(KeyStatusHandlerRaw, TRUE, &mKeyboardStates[i]);
+		keyboard->RegisterRemovedHandler(KeyboardRemovedHandler, this);
+		mLogger.Write (GetKernelName (), LogNotice, "USB keyboard %d found", i + 1);
+	}
+
+	// ゲームパッドデバイスを検索
+	for (int i = 0; i < MAX_GAMEPADS; i++) {
+		if (mGamePads[i] != nullptr) {
+			continue;
+		}
+		CUSBGamePadDevice* gamepad = static_cast<CUSBGamePadDevice *>(mDeviceNameService.GetDevice("upad", i + 1, FALSE));
+		if (gamepad == nullptr) {
+			continue;
+		}
+		mGamePads[i] = gamepad;
+		s_gamepad_mapping[i].invalidate();
+
+		// ゲームパッドイベントハンドラを登録
+		gamepad->RegisterStatusHandler(GamePadStatusHandler);
+		gamepad->RegisterRemovedHandler(GamePadRemovedHandler, this);
+		mLogger.Write (GetKernelName (), LogNotice, "USB gamepad %d found", i + 1);
+	}
+}
+
+void CKernel::InputPollHandler(void* arg)
+{
+	static_cast<CKernel*>(arg)->UpdateInputDevices();
+}
+
 CStdlibApp::TShutdownMode CKernel::Run (void)
 {
 	mLogger.Write (GetKernelName (), LogNotice, "Computer Emulator for Raspberry Pi");
@@ -322,10 +346,22 @@ CStdlibApp::TShutdownMode CKernel::Run (void)
 	// サウンド周りの初期化
 	mSound.SetControl(VCHIQ_SOUND_VOLUME_DEFAULT);  // サウンドボリュームをデフォルト値に設定
 	
+	// 解析済みの設定のキャッシュ(config.sys、ini、menu.cfgが変わっていなければ解析を省く)
+	u64 bootCacheStart = CTimer::GetClockTicks64();
+	PlatformBootCache* bootCache = new PlatformBootCache(create_emu_path("%s.cache", CONFIG_NAME));
+	bootCache->set_source(BOOT_CACHE_SOURCE_CONFIG_SYS, "config.sys");
+	bootCache->set_source(BOOT_CACHE_SOURCE_INI, create_emu_path("%s.ini", CONFIG_NAME));
+	bootCache->set_source(BOOT_CACHE_SOURCE_MENU_CFG, "menu.cfg");
+	bootCache->load();
+
 	// config.sys(ジョイスティック設定)の読み込み
 	mLogger.Write(GetKernelName(), LogNotice, "Loading config.sys...");
-	FILE* configFile = fopen("config.sys", "r");
-	if (configFile) {
+	FILE* configFile = nullptr;
+	if (bootCache->is_valid(BOOT_CACHE_SOURCE_CONFIG_SYS)) {
+	    config_ = new SystemConfiguration("");
+	    bootCache->restore_buttons(config_);
+	    mLogger.Write(GetKernelName(), LogNotice, "config.sys loaded from boot cache");
+	} else if ((configFile = fopen("config.sys", "r")) != nullptr) {
 	    // ファイルサイズを取得
 	    fseek(configFile, 0, SEEK_END);
 	    long fileSize = ftell(configFile);
@@ -349,43 +385,27 @@ CStdlibApp::TShutdownMode CKernel::Run (void)
 	    config_ = new SystemConfiguration("");
 	    mLogger.Write(GetKernelName(), LogNotice, "config.sys not found, using default settings");
 	}
+	if (!bootCache->is_valid(BOOT_CACHE_SOURCE_CONFIG_SYS)) {
+	    bootCache->store_buttons(config_);
+	}
 
     // 各種Platform系インスタンスの生成
     pEmuController = mEmuController = new EmuController();
-    mEmuController->initialize(DISPLAY_WIDTH, DISPLAY_HEIGHT, SCREEN_WIDTH, SCREEN_HEIGHT, WINDOW_WIDTH_ASPECT, WINDOW_HEIGHT_ASPECT, &mSound, &mScheduler);
-
-	// USBデバイス検出処理
-	if (mUSBHCI.UpdatePlugAndPlay()) {
-		// キーボードデバイスを検索
-		mKeyboard = static_cast<CUSBKeyboardDevice *>(mDeviceNameService.GetDevice("ukbd1", FALSE));
-		
-		if (mKeyboard != nullptr) {
-			mLogger.Write (GetKernelName (), LogNotice, "USB keyboard found");
-			
-			// キーボードイベントハンドラを登録
-			mKeyboard->RegisterKeyStatusHandlerRaw(KeyStatusHandlerRaw, TRUE, this);
-			mLogger.Write (GetKernelName (), LogNotice, "Keyboard handler registered");
-		} else {
-			mLogger.Write (GetKernelName (), LogWarning, "No USB keyboard found");
-		}
+    // メニューはinitializeの中で読み込むので、その前にキャッシュを渡しておく
+    mEmuController->get_platform_config()->set_boot_cache(bootCache);
+    mEmuController->initialize(DISPLAY_WIDTH, DISPLAY_HEIGHT, SCREEN_WIDTH, SCREEN_HEIGHT, WINDOW_WIDTH_ASPECT, WINDOW_HEIGHT_ASPECT, &mSound, &mScheduler, &mInterrupt);
 
-		// ゲームパッドデバイスを検索
-		mGamePad = static_cast<CUSBGamePadDevice *>(mDeviceNameService.GetDevice("upad1", FALSE));
-		
-		if (mGamePad != nullptr) {
-			mLogger.Write (GetKernelName (), LogNotice, "USB gamepad found");
-			
-			// ゲームパッドイベントハンドラを登録
-			mGamePad->RegisterStatusHandler(GamePadStatusHandler);
-			mLogger.Write (GetKernelName (), LogNotice, "Gamepad handler registered");
-		} else {
-			mLogger.Write (GetKernelName (), LogWarning, "No USB gamepad found");
-		}
-	}
+	// USBデバイス検出処理(以降はメインループから定期的に抜き差しを確認する)
+	UpdateInputDevices();
+	mEmuController->set_input_poll_handler(InputPollHandler, this);
 
     // load config
     mEmuController->load_config();
 
+    // 解析し直したものがあればキャッシュを更新する
+    bootCache->save();
+    mLogger.Write(GetKernelName(), LogNotice, "Configuration loaded in %u us", (unsigned)(CTimer::GetClockTicks64() - bootCacheStart));
+
 	int result = mEmuController->emulator_main();
 	
 	// 終了コードに応じた処理（エラー時の特別処理も可能）
@@ -402,6 +422,7 @@ CStdlibApp::TShutdownMode CKernel::Run (void)
 	}
 
     delete mEmuController;
+    delete bootCache;
 
 	return ShutdownHalt;
 }
@@ -30,9 +30,16 @@
 
 
 #include "vicesound.h"
+#include "PlatformInput.h"
 
 class EmuController;
 
+// キーボードごとの前回の状態(キーの押下/解放を検出するため)
+struct KeyboardState {
+        unsigned char prev_keys[6];
+        unsigned char prev_modifiers;
+};
+
 class CKernel : public CStdlibApp
 {
 private:
@@ -134,6 +141,14 @@ public:
 	// ゲームパッドイベントハンドラ
 	static void GamePadStatusHandler(unsigned nDeviceIndex, const TGamePadState *pState);
 
+	// USBデバイスの抜き差しを検出し、キーボード・ゲームパッドを登録し直す(メインループから定期的に呼ばれる)
+	void UpdateInputDevices(void);
+	static void InputPollHandler(void* arg);
+
+	// デバイスが取り外された時のハンドラ
+	static void KeyboardRemovedHandler(CDevice* pDevice, void* pContext);
+	static void GamePadRemovedHandler(CDevice* pDevice, void* pContext);
+
 protected:
         CSerialDevice   mSerial;
         CTimer          mTimer;
@@ -145,11 +160,12 @@ protected:
         CVCHIQDevice    mVCHIQ;
         ViceSound       mSound;
         
-        // キーボード入力用の変数
-        CUSBKeyboardDevice* mKeyboard;
+        // キーボード入力用の変数(ukbd1〜4)
+        CUSBKeyboardDevice* mKeyboards[MAX_KEYBOARDS];
+        KeyboardState mKeyboardStates[MAX_KEYBOARDS];
 
-        // ゲームパッド入力用の変数
-        CUSBGamePadDevice* mGamePad;
+        // ゲームパッド入力用の変数(upad1〜4)
+        CUSBGamePadDevice* mGamePads[MAX_GAMEPADS];
 
         EmuController* mEmuController;
 
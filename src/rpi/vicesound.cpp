@@ -25,6 +25,9 @@ extern "C" {
 }
 
 #include <circle/sched/scheduler.h>
+#include <circle/synchronize.h>
+
+#include "PlatformIdle.h"
 
 ViceSound::ViceSound(CVCHIQDevice *pVCHIQDevice,
                      TVCHIQSoundDestination Destination)
@@ -81,8 +84,18 @@ unsigned ViceSound::GetChunk(s16 *pBuffer, unsigned nChunkSize) {
 
   // VICE expects us to 'block' if our buffer is full. But
   // this shouldn't happen.
-  while (bytes_buffered >= FRAG_SIZE * NUM_FRAGS * BYTES_PER_SAMPLE) {
+  const unsigned buffer_bytes = FRAG_SIZE * NUM_FRAGS * BYTES_PER_SAMPLE;
+  while (bytes_buffered >= buffer_bytes) {
     CScheduler::Get()->Yield();
+    // Sleep until the next interrupt (e.g. VC4 consuming a fragment)
+    // instead of spinning. Check again with IRQs masked: the Yield may
+    // already have drained the buffer, and an interrupt arriving after
+    // the check still wakes the WFI.
+    DisableIRQs();
+    if (bytes_buffered >= buffer_bytes) {
+      platform_wait_for_interrupt();
+    }
+    EnableIRQs();
   }
 
   if (src_buffer == 0 || src_size == 0) {
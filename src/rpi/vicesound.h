@@ -78,7 +78,8 @@ private:
   void AmountBufferedBytes(unsigned);
 
   // Keep track of how many bytes we've sent to VC
-  unsigned int bytes_buffered;
+  // (updated from the VCHIQ callback while GetChunk waits for it)
+  volatile unsigned int bytes_buffered;
 
   // Pointer to sample source while we draw from vice's buffer
   s16 *src_buffer;
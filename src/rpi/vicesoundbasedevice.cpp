@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "vicesoundbasedevice.h"
+#include "PlatformTrace.h"
 #include <assert.h>
 #include <circle/devicenameservice.h>
 #include <circle/logger.h>
@@ -373,6 +374,7 @@ int ViceSoundBaseDevice::WriteChunk(void) {
 
 void ViceSoundBaseDevice::Callback(const VCHI_CALLBACK_REASON_T Reason,
                                    void *hMessage) {
+  TRACE_SCOPE("sound callback");
   if (Reason != VCHI_CALLBACK_MSG_AVAILABLE) {
     assert(0);
     return;
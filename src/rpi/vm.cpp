@@ -88,3 +88,9 @@ void VM::key_up(int code)
 {
     // キーを離したときの処理
 }
+
+u32 VM::get_ram_hash()
+{
+    // RAMを持つ場合はここでハッシュを計算する(入力リプレイ時の一致確認に使われる)
+    return 0;
+}
@@ -34,6 +34,9 @@ class VM
 
 	    void key_down(int code, bool repeat);
 	    void key_up(int code);
+
+        // 入力リプレイ時の一致確認用(RAM内容のハッシュ)
+        u32 get_ram_hash();
 };
 
 #endif // VM_H
@@ -20,6 +20,31 @@ extern "C" void exec6502(uint32_t tickcount);
 extern "C" void nmi6502();
 extern "C" void step6502(int printRegs);
 
+#ifdef FAKE6502_PROFILE
+#include <stdio.h>
+
+extern "C" void profile6502_reset();
+extern "C" int profile6502_dump_csv(FILE* fp);
+extern const char* create_emu_path(const char *format, ...);
+
+// CPUプロファイルをSDに書き出す間隔(フレーム数)。内容はリセットからの累計
+#define PROFILE6502_DUMP_FRAMES 600
+
+static void dump_cpu_profile()
+{
+    const char* path = create_emu_path("%s_cpu.csv", CONFIG_NAME);
+    FILE* fp = fopen(path, "w");
+    if (!fp) {
+        get_logger()->Write("VM", LogError, "Failed to open %s", path);
+        return;
+    }
+    if (!profile6502_dump_csv(fp)) {
+        get_logger()->Write("VM", LogError, "Failed to write %s", path);
+    }
+    fclose(fp);
+}
+#endif
+
 extern PlatformScreen* g_platform_screen;
 extern PlatformSound* g_platform_sound;
 
@@ -186,6 +211,14 @@ void VM::run()
 
     // 1フレームぶん実行させる
     exec6502(clocks_per_frame);
+
+#ifdef FAKE6502_PROFILE
+    static int profile_frames = 0;
+    if (++profile_frames >= PROFILE6502_DUMP_FRAMES) {
+        profile_frames = 0;
+        dump_cpu_profile();
+    }
+#endif
 }
 
 void VM::lock()
@@ -206,6 +239,9 @@ void VM::reset()
     // $c000からプログラムを書きこむ(手抜き)
     memcpy(g_memory + 0xc000, prog, sizeof(prog));
     reset6502();
+#ifdef FAKE6502_PROFILE
+    profile6502_reset();
+#endif
 
     // エントリーポイントはなぜか$c000
     pc = 0xc000;
@@ -229,3 +265,14 @@ void VM::key_up(int code)
 {
     // キーを離したときの処理
 }
+
+u32 VM::get_ram_hash()
+{
+    // 64KB全体のFNV-1aハッシュ
+    u32 hash = 2166136261u;
+    for(int i = 0; i < 64 * 1024; i++) {
+        hash ^= g_memory[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
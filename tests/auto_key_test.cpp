@@ -0,0 +1,269 @@
+// PlatformAutoKeyのテスト
+// 文字から仮想キーコードへの変換(日本語キーボード配列、シフトを伴う記号を含む)、速度設定ごとの押下/解放のフレーム数、
+// 改行の後の待ち、途中での停止を確認する
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "PlatformAutoKey.h"
+
+// シフトキー(PlatformAutoKey.cppと同じ左シフト)
+#define TEST_VK_SHIFT 0xA0
+#define TEST_VK_RETURN 0x0D
+
+// これを超えても終わらなければ失敗とする
+#define TEST_MAX_FRAMES 10000
+
+static int s_errors = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            s_errors++; \
+        } \
+    } while (0)
+
+// 発生したキーイベントと、そのフレーム番号
+struct TestKeyEvent {
+    int frame;
+    KeyEventType type;
+    u8 code;
+};
+
+// 止まるまでフレームを進めて、発生したイベントを返す
+static std::vector<TestKeyEvent> run(PlatformAutoKey* auto_key, int first_frame = 0)
+{
+    std::vector<TestKeyEvent> result;
+    for (int frame = first_frame; auto_key->is_running() && frame < TEST_MAX_FRAMES; frame++) {
+        PlatformKeyEvent events[AUTO_KEY_MAX_EVENTS];
+        int count = auto_key->step(events, AUTO_KEY_MAX_EVENTS);
+        for (int i = 0; i < count; i++) {
+            result.push_back({ frame, events[i].type, events[i].code });
+        }
+    }
+    CHECK(!auto_key->is_running());
+    return result;
+}
+
+// キーを押したフレームの一覧(シフトは除く)
+static std::vector<int> press_frames(const std::vector<TestKeyEvent>& events)
+{
+    std::vector<int> frames;
+    for (size_t i = 0; i < events.size(); i++) {
+        if (events[i].type == KEY_EVENT_DOWN && events[i].code != TEST_VK_SHIFT) {
+            frames.push_back(events[i].frame);
+        }
+    }
+    return frames;
+}
+
+static void test_char_to_vk()
+{
+    static const struct { char c; u8 vk; bool shift; } table[] = {
+        { 'A', 0x41, false }, { 'a', 0x41, false }, { 'Z', 0x5A, false }, { 'z', 0x5A, false },
+        { '0', 0x30, false }, { '9', 0x39, false }, { ' ', 0x20, false },
+        { '\n', 0x0D, false }, { '\r', 0x0D, false }, { '\t', 0x09, false }, { '\b', 0x08, false }, { 0x1B, 0x1B, false },
+        // 数字キーのシフト
+        { '!', 0x31, true }, { '"', 0x32, true }, { '#', 0x33, true }, { '$', 0x34, true }, { '%', 0x35, true },
+        { '&', 0x36, true }, { '\'', 0x37, true }, { '(', 0x38, true }, { ')', 0x39, true },
+        // 記号キー(シフト無し/有り)
+        { '-', 0xBD, false }, { '=', 0xBD, true },
+        { '^', 0xDE, false }, { '~', 0xDE, true },
+        { '\\', 0xDC, false }, { '|', 0xDC, true },
+        { '@', 0xC0, false }, { '`', 0xC0, true },
+        { '[', 0xDB, false }, { '{', 0xDB, true },
+        { ';', 0xBB, false }, { '+', 0xBB, true },
+        { ':', 0xBA, false }, { '*', 0xBA, true },
+        { ']', 0xDD, false }, { '}', 0xDD, true },
+        { ',', 0xBC, false }, { '<', 0xBC, true },
+        { '.', 0xBE, false }, { '>', 0xBE, true },
+        { '/', 0xBF, false }, { '?', 0xBF, true },
+        // アンダースコアはろのキー
+        { '_', 0xE2, true },
+    };
+    for (size_t i = 0; i < sizeof(table) / sizeof(table[0]); i++) {
+        u8 vk = 0;
+        bool shift = !table[i].shift;
+        if (!PlatformAutoKey::char_to_vk(table[i].c, &vk, &shift) || vk != table[i].vk || shift != table[i].shift) {
+            printf("char_to_vk(0x%02x): 0x%02x%s, expected 0x%02x%s\n", (unsigned char)table[i].c,
+                vk, shift ? "+shift" : "", table[i].vk, table[i].shift ? "+shift" : "");
+            s_errors++;
+        }
+    }
+
+    // 対応するキーが無い文字
+    static const char unmapped[] = { '\0', 0x01, 0x7F, (char)0x80, (char)0xB1, (char)0xFF };
+    for (size_t i = 0; i < sizeof(unmapped); i++) {
+        u8 vk;
+        bool shift;
+        CHECK(!PlatformAutoKey::char_to_vk(unmapped[i], &vk, &shift));
+    }
+}
+
+static void test_speed()
+{
+    static const struct { int speed; int hold; int gap; } speeds[] = {
+        { AUTO_KEY_SPEED_NORMAL, 3, 3 },
+        { AUTO_KEY_SPEED_FAST, 2, 1 },
+        { AUTO_KEY_SPEED_FASTEST, 1, 1 },
+        // 範囲外は通常の速度
+        { -1, 3, 3 },
+        { AUTO_KEY_SPEED_FASTEST + 1, 3, 3 },
+    };
+    for (size_t i = 0; i < sizeof(speeds) / sizeof(speeds[0]); i++) {
+        int hold = speeds[i].hold;
+        int gap = speeds[i].gap;
+
+        PlatformAutoKey auto_key;
+        auto_key.set_speed(speeds[i].speed);
+        CHECK(auto_key.set_text("ab", 2));
+        auto_key.start();
+        std::vector<TestKeyEvent> events = run(&auto_key);
+
+        // 押してからholdフレーム後に離し、離してからgapフレーム後に次を押す
+        CHECK(events.size() == 4);
+        if (events.size() != 4) {
+            continue;
+        }
+        CHECK(events[0].frame == 0 && events[0].type == KEY_EVENT_DOWN && events[0].code == 'A');
+        CHECK(events[1].frame == hold && events[1].type == KEY_EVENT_UP && events[1].code == 'A');
+        CHECK(events[2].frame == hold + gap && events[2].type == KEY_EVENT_DOWN && events[2].code == 'B');
+        CHECK(events[3].frame == hold * 2 + gap && events[3].type == KEY_EVENT_UP && events[3].code == 'B');
+    }
+}
+
+static void test_shift()
+{
+    PlatformAutoKey auto_key;
+    auto_key.set_speed(AUTO_KEY_SPEED_FASTEST);
+    CHECK(auto_key.set_text("\"a", 2));
+    auto_key.start();
+    std::vector<TestKeyEvent> events = run(&auto_key);
+
+    // シフトはキーより先に押し、キーより後に離す。同じフレームで行う
+    CHECK(events.size() == 6);
+    if (events.size() == 6) {
+        CHECK(events[0].frame == 0 && events[0].type == KEY_EVENT_DOWN && events[0].code == TEST_VK_SHIFT);
+        CHECK(events[1].frame == 0 && events[1].type == KEY_EVENT_DOWN && events[1].code == 0x32);
+        CHECK(events[2].frame == 1 && events[2].type == KEY_EVENT_UP && events[2].code == 0x32);
+        CHECK(events[3].frame == 1 && events[3].type == KEY_EVENT_UP && events[3].code == TEST_VK_SHIFT);
+        CHECK(events[4].frame == 2 && events[4].type == KEY_EVENT_DOWN && events[4].code == 'A');
+        CHECK(events[5].frame == 3 && events[5].type == KEY_EVENT_UP && events[5].code == 'A');
+    }
+}
+
+static void test_newline()
+{
+    PlatformAutoKey auto_key;
+    auto_key.set_speed(AUTO_KEY_SPEED_FASTEST);
+    // CR+LFは1回のリターン。変換できない文字は読み飛ばす
+    const char text[] = "a\r\n\x7f" "b\nc";
+    CHECK(auto_key.set_text(text, sizeof(text) - 1));
+    auto_key.start();
+    std::vector<TestKeyEvent> events = run(&auto_key);
+
+    std::vector<int> frames = press_frames(events);
+    CHECK(frames.size() == 5);
+    if (frames.size() != 5) {
+        return;
+    }
+    // リターンを離した後はAUTO_KEY_NEWLINE_WAIT_FRAMESの間何も起きない
+    static const u8 codes[] = { 'A', TEST_VK_RETURN, 'B', TEST_VK_RETURN, 'C' };
+    int expected = 0;
+    for (int i = 0; i < 5; i++) {
+        CHECK(frames[i] == expected);
+        CHECK(events[i * 2].code == codes[i]);
+        expected += codes[i] == TEST_VK_RETURN ? 2 + AUTO_KEY_NEWLINE_WAIT_FRAMES : 2;
+    }
+    CHECK(events.back().frame == expected - 1);
+}
+
+static void test_stop()
+{
+    PlatformAutoKey auto_key;
+    auto_key.set_speed(AUTO_KEY_SPEED_NORMAL);
+    CHECK(auto_key.set_text("!bc", 3));
+    auto_key.start();
+
+    // 実行中はテキストを差し替えられない
+    CHECK(!auto_key.set_text("x", 1));
+
+    // 押している途中で止めると、次のフレームでキーとシフトを離して止まる
+    PlatformKeyEvent events[AUTO_KEY_MAX_EVENTS];
+    CHECK(auto_key.step(events, AUTO_KEY_MAX_EVENTS) == 2);
+    CHECK(auto_key.step(events, AUTO_KEY_MAX_EVENTS) == 0);
+    auto_key.stop();
+    CHECK(auto_key.is_running());
+    int count = auto_key.step(events, AUTO_KEY_MAX_EVENTS);
+    CHECK(count == 2);
+    if (count == 2) {
+        CHECK(events[0].type == KEY_EVENT_UP && events[0].code == 0x31);
+        CHECK(events[1].type == KEY_EVENT_UP && events[1].code == TEST_VK_SHIFT);
+    }
+    CHECK(!auto_key.is_running());
+    CHECK(auto_key.step(events, AUTO_KEY_MAX_EVENTS) == 0);
+
+    // 再開すると続きから入力する
+    auto_key.start();
+    std::vector<TestKeyEvent> rest = run(&auto_key);
+    CHECK(rest.size() == 4);
+    if (rest.size() == 4) {
+        CHECK(rest[0].type == KEY_EVENT_DOWN && rest[0].code == 'B');
+    }
+
+    // 離している間に止めた場合は何も送らずに止まる
+    CHECK(auto_key.set_text("de", 2));
+    auto_key.start();
+    for (int frame = 0; frame < 4; frame++) {
+        auto_key.step(events, AUTO_KEY_MAX_EVENTS);
+    }
+    auto_key.stop();
+    CHECK(auto_key.step(events, AUTO_KEY_MAX_EVENTS) == 0);
+    CHECK(!auto_key.is_running());
+
+    // 止めてから新しいテキストを設定できる
+    CHECK(auto_key.set_text("f", 1));
+    auto_key.start();
+    std::vector<TestKeyEvent> next = run(&auto_key);
+    CHECK(next.size() == 2 && next[0].code == 'F');
+}
+
+static void test_single_code()
+{
+    PlatformAutoKey auto_key;
+    auto_key.set_speed(AUTO_KEY_SPEED_FAST);
+    auto_key.set_code(0x170);
+    auto_key.start();
+
+    // イベントを2つ格納できなければ進めない
+    PlatformKeyEvent events[AUTO_KEY_MAX_EVENTS];
+    CHECK(auto_key.step(events, 1) == 0);
+
+    std::vector<TestKeyEvent> result = run(&auto_key);
+    CHECK(result.size() == 2);
+    if (result.size() == 2) {
+        CHECK(result[0].frame == 0 && result[0].type == KEY_EVENT_DOWN && result[0].code == 0x70);
+        CHECK(result[1].frame == 2 && result[1].type == KEY_EVENT_UP && result[1].code == 0x70);
+    }
+
+    // 入力するものが無ければ始まらない
+    PlatformAutoKey empty;
+    empty.start();
+    CHECK(!empty.is_running());
+}
+
+int main()
+{
+    test_char_to_vk();
+    test_speed();
+    test_shift();
+    test_newline();
+    test_stop();
+    test_single_code();
+
+    printf("auto_key_test: %s\n", s_errors == 0 ? "OK" : "FAILED");
+    return s_errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,343 @@
+// FBConsoleの文字描画のテスト
+// 展開済みの行をまとめて書く描画(drawChar/drawChar16/drawString/drawString16/clear)の結果を、
+// 1ピクセルずつ範囲を確認して描く単純な実装と比べる。画面端にかかる文字、透過、行の幅より広いピッチ、
+// キャッシュの数より多い文字色と背景色の組み合わせ(入れ替え)を含める
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// 展開済みの行のキャッシュを直接確認するため
+#include "FBConsole.cpp"
+
+// 描画範囲の外(ピッチの余りとバッファの後ろ)に置いておく値
+#define TEST_GUARD_COLOR 0xDEAD
+#define TEST_GUARD_PIXELS 64
+// 乱数で行う描画の回数
+#define TEST_OPERATIONS 20000
+
+static int s_errors = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            s_errors++; \
+        } \
+    } while (0)
+
+// 文字色と背景色の組み合わせ(FB_CONSOLE_SPAN_CACHE_SLOTSより多くする)
+static const FBConsoleColor s_colors[][2] = {
+    { 0xFFFF, 0x0000 }, { 0xF800, 0x0000 }, { 0x07E0, 0x001F }, { 0xFFE0, 0x8410 },
+    { 0x0000, 0xFFFF }, { 0x001F, 0xF81F }, { 0x07FF, 0x0000 }, { 0x0000, 0x0000 },
+};
+#define TEST_COLOR_COUNT (int)(sizeof(s_colors) / sizeof(s_colors[0]))
+
+/// @brief 比較用の単純な実装(1ピクセルずつ範囲を確認して書く)
+class ReferenceConsole {
+    private:
+        uint16_t m_width;
+        uint16_t m_height;
+        size_t m_pitch;
+        FBConsoleColor* m_buffer;
+
+        void set_pixel(uint16_t x, uint16_t y, FBConsoleColor color)
+        {
+            if (x < m_width && y < m_height) {
+                m_buffer[y * m_pitch + x] = color;
+            }
+        }
+
+    public:
+        ReferenceConsole(uint16_t width, uint16_t height, FBConsoleColor* buffer, size_t pitch)
+        : m_width(width), m_height(height), m_pitch(pitch), m_buffer(buffer) {}
+
+        void clear(FBConsoleColor color)
+        {
+            for (uint16_t y = 0; y < m_height; y++) {
+                for (uint16_t x = 0; x < m_width; x++) {
+                    m_buffer[y * m_pitch + x] = color;
+                }
+            }
+        }
+
+        void draw_char(char c, uint16_t x, uint16_t y, int scale, FBConsoleColor color, FBConsoleColor bg_color, bool transparent)
+        {
+            if (c < 0 || c > 127) {
+                return;
+            }
+            const unsigned char* font_data = font8x8_basic[(unsigned char)c];
+            for (int row = 0; row < 8; row++) {
+                for (int col = 0; col < 8; col++) {
+                    bool set = font_data[row] & (1 << col);
+                    if (!set && transparent) {
+                        continue;
+                    }
+                    for (int dy = 0; dy < scale; dy++) {
+                        for (int dx = 0; dx < scale; dx++) {
+                            set_pixel(x + col * scale + dx, y + row * scale + dy, set ? color : bg_color);
+                        }
+                    }
+                }
+            }
+        }
+
+        // 右端で折り返し、下端で止める
+        void draw_string(const char* str, uint16_t x, uint16_t y, int scale, FBConsoleColor color, FBConsoleColor bg_color, bool transparent)
+        {
+            int size = 8 * scale;
+            uint16_t current_x = x;
+            for (; *str; str++) {
+                draw_char(*str, current_x, y, scale, color, bg_color, transparent);
+                current_x += size;
+                if (current_x + size > m_width) {
+                    current_x = x;
+                    y += size;
+                    if (y + size > m_height) {
+                        break;
+                    }
+                }
+            }
+        }
+};
+
+static uint32_t s_random = 12345;
+
+static uint32_t next_random(uint32_t range)
+{
+    s_random = s_random * 1103515245 + 12345;
+    return (s_random >> 8) % range;
+}
+
+// 表示できる文字を中心に、制御文字やASCII外の文字も混ぜる
+static char random_char()
+{
+    uint32_t kind = next_random(16);
+    if (kind == 0) {
+        return (char)(0x80 + next_random(128));
+    }
+    if (kind == 1) {
+        return (char)next_random(32);
+    }
+    return (char)(0x20 + next_random(0x5F));
+}
+
+/// @brief 同じ大きさの2つのバッファに、FBConsoleと比較用の実装で同じ描画を行う
+class ConsolePair {
+    public:
+        uint16_t m_width;
+        uint16_t m_height;
+        size_t m_pitch;
+        size_t m_size;
+        std::vector<FBConsoleColor> m_actual;
+        std::vector<FBConsoleColor> m_expected;
+        std::vector<FBConsoleColor> m_before;
+        FBConsole m_console;
+        ReferenceConsole m_reference;
+
+        ConsolePair(uint16_t width, uint16_t height, size_t pitch)
+        :
+            m_width(width),
+            m_height(height),
+            m_pitch(pitch),
+            m_size(pitch * height + TEST_GUARD_PIXELS),
+            m_actual(m_size, TEST_GUARD_COLOR),
+            m_expected(m_size, TEST_GUARD_COLOR),
+            m_console(width, height),
+            m_reference(width, height, &m_expected[0], pitch)
+        {
+            CHECK(m_console.init(&m_actual[0], pitch));
+            m_reference.clear(0);
+        }
+
+        // 一致しなければ最初に違うピクセルを表示する
+        bool compare(const char* operation)
+        {
+            for (size_t i = 0; i < m_size; i++) {
+                if (m_actual[i] != m_expected[i]) {
+                    printf("%ux%u pitch %u, %s: pixel (%u, %u) is 0x%04x, expected 0x%04x\n",
+                        m_width, m_height, (unsigned)m_pitch, operation,
+                        (unsigned)(i % m_pitch), (unsigned)(i / m_pitch), m_actual[i], m_expected[i]);
+                    s_errors++;
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // 描画で変わった行が全て変更ありとして記録されていること
+        bool check_dirty(const char* operation)
+        {
+            for (uint16_t y = 0; y < m_height; y++) {
+                if (memcmp(&m_before[y * m_pitch], &m_actual[y * m_pitch], m_width * sizeof(FBConsoleColor)) != 0 &&
+                    !m_console.isRowDirty(y)) {
+                    printf("%ux%u pitch %u, %s: row %u is not marked dirty\n",
+                        m_width, m_height, (unsigned)m_pitch, operation, y);
+                    s_errors++;
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // 乱数で選んだ描画を1回行って比べる
+        bool random_operation()
+        {
+            m_before = m_actual;
+            m_console.clearDirty();
+
+            const FBConsoleColor* colors = s_colors[next_random(TEST_COLOR_COUNT)];
+            bool transparent = next_random(4) == 0;
+            // 画面端にかかる位置と、完全に外れる位置も選ぶ
+            uint16_t x = next_random(m_width + 24);
+            uint16_t y = next_random(m_height + 24);
+
+            char text[24];
+            int length = 1 + next_random(sizeof(text) - 1);
+            for (int i = 0; i < length; i++) {
+                text[i] = random_char();
+                // 文字列の途中で終わらないように
+                if (text[i] == '\0') {
+                    text[i] = ' ';
+                }
+            }
+            text[length] = '\0';
+
+            const char* operation;
+            switch (next_random(16)) {
+                case 0:
+                    operation = "clear";
+                    m_console.clear(colors[1]);
+                    m_reference.clear(colors[1]);
+                    break;
+                case 1:
+                case 2:
+                case 3:
+                    operation = "drawChar";
+                    m_console.drawChar(text[0], x, y, colors[0], colors[1], transparent);
+                    m_reference.draw_char(text[0], x, y, 1, colors[0], colors[1], transparent);
+                    break;
+                case 4:
+                case 5:
+                case 6:
+                    operation = "drawChar16";
+                    m_console.drawChar16(text[0], x, y, colors[0], colors[1], transparent);
+                    m_reference.draw_char(text[0], x, y, 2, colors[0], colors[1], transparent);
+                    break;
+                case 7:
+                case 8:
+                case 9:
+                case 10:
+                case 11:
+                    // 1行に収まる長さを多めに選ぶ
+                    if (next_random(2)) {
+                        x = next_random(m_width / 2);
+                        text[(m_width - x) / 8 < (uint16_t)length ? (m_width - x) / 8 : length] = '\0';
+                    }
+                    operation = "drawString";
+                    m_console.drawString(text, x, y, colors[0], colors[1], transparent);
+                    m_reference.draw_string(text, x, y, 1, colors[0], colors[1], transparent);
+                    break;
+                default:
+                    operation = "drawString16";
+                    m_console.drawString16(text, x, y, colors[0], colors[1], transparent);
+                    m_reference.draw_string(text, x, y, 2, colors[0], colors[1], transparent);
+                    break;
+            }
+            return compare(operation) && check_dirty(operation);
+        }
+};
+
+static void test_random(uint16_t width, uint16_t height, size_t pitch)
+{
+    ConsolePair pair(width, height, pitch);
+    pair.compare("init");
+    for (int i = 0; i < TEST_OPERATIONS; i++) {
+        if (!pair.random_operation()) {
+            break;
+        }
+    }
+}
+
+// 全ての文字を全ての組み合わせで画面内に描く
+static void test_all_chars(size_t pitch)
+{
+    ConsolePair pair(320, 64, pitch);
+    for (int c = 0; c < 128; c++) {
+        const FBConsoleColor* colors = s_colors[c % TEST_COLOR_COUNT];
+        uint16_t x = (c % 16) * 16;
+        uint16_t y = (c / 16) * 8;
+        pair.m_console.drawChar((char)c, x, y, colors[0], colors[1], false);
+        pair.m_reference.draw_char((char)c, x, y, 1, colors[0], colors[1], false);
+        pair.m_console.drawChar16((char)c, x + 256 - (c % 16) * 12, y % 48, colors[1], colors[0], false);
+        pair.m_reference.draw_char((char)c, x + 256 - (c % 16) * 12, y % 48, 2, colors[1], colors[0], false);
+    }
+    pair.compare("all chars");
+}
+
+// 端にかかる文字は見えている部分だけを描く(バッファの外やピッチの余りには書かない)
+static void test_edges()
+{
+    ConsolePair pair(37, 21, 48);
+    static const struct { uint16_t x; uint16_t y; } positions[] = {
+        { 30, 0 }, { 0, 14 }, { 30, 14 }, { 36, 20 }, { 37, 0 }, { 0, 21 }, { 29, 13 }, { 21, 5 }, { 22, 6 },
+    };
+    for (size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); i++) {
+        pair.m_console.drawChar('#', positions[i].x, positions[i].y, 0xFFFF, 0x1234, false);
+        pair.m_reference.draw_char('#', positions[i].x, positions[i].y, 1, 0xFFFF, 0x1234, false);
+        pair.m_console.drawChar16('@', positions[i].x, positions[i].y, 0xF800, 0x4321, i & 1);
+        pair.m_reference.draw_char('@', positions[i].x, positions[i].y, 2, 0xF800, 0x4321, i & 1);
+        pair.compare("edge");
+    }
+    // 1行に収まらない文字列は折り返す
+    pair.m_console.drawString("ABCDEFGHIJ", 3, 2, 0x07E0, 0x0000, false);
+    pair.m_reference.draw_string("ABCDEFGHIJ", 3, 2, 1, 0x07E0, 0x0000, false);
+    pair.compare("wrapped string");
+}
+
+// キャッシュは一番長く使っていない組み合わせから入れ替える
+static void test_span_cache()
+{
+    memset(spanCache, 0, sizeof(spanCache));
+
+    ConsolePair pair(64, 8, 64);
+    for (int i = 0; i < FB_CONSOLE_SPAN_CACHE_SLOTS; i++) {
+        pair.m_console.drawString("A", 0, 0, s_colors[i][0], s_colors[i][1], false);
+    }
+    // 最初の組み合わせを使い直してから新しい組み合わせを使うと、2番目が入れ替わる
+    pair.m_console.drawString("B", 8, 0, s_colors[0][0], s_colors[0][1], false);
+    pair.m_console.drawString("C", 16, 0, s_colors[FB_CONSOLE_SPAN_CACHE_SLOTS][0], s_colors[FB_CONSOLE_SPAN_CACHE_SLOTS][1], false);
+
+    for (int i = 0; i <= FB_CONSOLE_SPAN_CACHE_SLOTS; i++) {
+        bool cached = false;
+        for (int slot = 0; slot < FB_CONSOLE_SPAN_CACHE_SLOTS; slot++) {
+            if (spanCache[slot].valid && spanCache[slot].color == s_colors[i][0] && spanCache[slot].bgColor == s_colors[i][1]) {
+                cached = true;
+            }
+        }
+        CHECK(cached == (i != 1));
+    }
+
+    // 入れ替えた後も正しく描ける
+    pair.m_reference.draw_char('A', 0, 0, 1, s_colors[FB_CONSOLE_SPAN_CACHE_SLOTS - 1][0], s_colors[FB_CONSOLE_SPAN_CACHE_SLOTS - 1][1], false);
+    pair.m_reference.draw_char('B', 8, 0, 1, s_colors[0][0], s_colors[0][1], false);
+    pair.m_reference.draw_char('C', 16, 0, 1, s_colors[FB_CONSOLE_SPAN_CACHE_SLOTS][0], s_colors[FB_CONSOLE_SPAN_CACHE_SLOTS][1], false);
+    pair.m_console.drawString("D", 24, 0, s_colors[1][0], s_colors[1][1], false);
+    pair.m_reference.draw_char('D', 24, 0, 1, s_colors[1][0], s_colors[1][1], false);
+    pair.compare("span cache");
+}
+
+int main()
+{
+    test_span_cache();
+    test_all_chars(320);
+    test_all_chars(328);
+    test_edges();
+    test_random(64, 40, 64);
+    test_random(61, 37, 72);
+    test_random(160, 16, 161);
+
+    printf("fbconsole_test: %s\n", s_errors == 0 ? "OK" : "FAILED");
+    return s_errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,25 @@
+// テスト用のログ出力(エラーだけ表示する。警告や通知は正常な動作でも出るため)
+
+#include "PlatformLog.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+
+void CLogger::Write(const char* source, TLogSeverity severity, const char* format, ...)
+{
+    if (severity > LogError) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    printf("[%s] ", source);
+    vprintf(format, args);
+    printf("\n");
+    va_end(args);
+}
+
+CLogger* get_logger()
+{
+    static CLogger logger(0);
+    return &logger;
+}
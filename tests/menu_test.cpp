@@ -0,0 +1,275 @@
+// PlatformMenuのmenu.cfg読み込みのテスト
+// 引数で渡したmenu.cfgをテスト側でも1行ずつ読み、全ての行が木の正しい位置に1つずつ登録されていること、
+// 階層ごとの子の並び(m_child_indices)が親のインデックスから求めたものと一致することを確認する
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+// 木の内部を直接確認するため
+#define private public
+#include "PlatformMenu.cpp"
+#undef private
+
+#define TEST_MAX_LINE 1024
+
+static int s_errors = 0;
+
+static void fail(const char* filename, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    printf("%s: ", filename);
+    vprintf(format, args);
+    printf("\n");
+    va_end(args);
+    s_errors++;
+}
+
+static int parse_type(const char* token)
+{
+    static const struct { const char* name; int type; } types[] = {
+        { "bool", MENU_TYPE_BOOL }, { "file", MENU_TYPE_FILE }, { "action", MENU_TYPE_ACTION },
+        { "separator", MENU_TYPE_SEPARATOR }, { "int_select", MENU_TYPE_INT_SELECT }, { "int", MENU_TYPE_INT }
+    };
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+        if (strcmp(token, types[i].name) == 0) {
+            return types[i].type;
+        }
+    }
+    return -1;
+}
+
+// "パス", 型[, "引数"] を分解する(コメントや空行はfalse)
+static bool split_line(char* line, char** path, int* type, char** param)
+{
+    char* p = line;
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p != '"') {
+        return false;
+    }
+    *path = ++p;
+    p = strchr(p, '"');
+    if (!p) {
+        return false;
+    }
+    *p++ = '\0';
+
+    while (*p == ' ' || *p == '\t' || *p == ',') p++;
+    char* type_token = p;
+    while (*p && *p != ',' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') p++;
+    char end = *p;
+    *p = '\0';
+    *type = parse_type(type_token);
+
+    *param = nullptr;
+    if (end) {
+        p++;
+        while (*p == ' ' || *p == '\t' || *p == ',') p++;
+        if (*p == '"') {
+            *param = ++p;
+            p = strchr(p, '"');
+            if (p) {
+                *p = '\0';
+            }
+        }
+    }
+    return *type >= 0;
+}
+
+// parentの子からdisplay_nameとtypeが一致し、まだ使っていないものを探す
+static int find_child(PlatformMenu* menu, int parent, const char* name, int type, const bool* used)
+{
+    for (int position = 0; position < menu->get_child_count(parent); position++) {
+        int index = menu->get_child_item(parent, position);
+        const MenuItemInfo* item = &menu->m_menu_items[index];
+        if (item->type == type && !used[index] && strcmp(menu->get_string(item->display_name), name) == 0) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+// パスの途中のサブメニューをたどる(見つからなければ-2)
+static int find_submenu(PlatformMenu* menu, const char* path, size_t length)
+{
+    int parent = -1;
+    const char* segment = path;
+    while (segment < path + length) {
+        const char* slash = (const char*)memchr(segment, '/', path + length - segment);
+        size_t segment_length = slash ? (size_t)(slash - segment) : (size_t)(path + length - segment);
+        char name[MAX_STRING_LENGTH];
+        snprintf(name, sizeof(name), "%.*s", (int)segment_length, segment);
+        bool none[MAX_MENU_ITEMS] = { false };
+        parent = find_child(menu, parent, name, MENU_TYPE_SUBMENU, none);
+        if (parent < 0) {
+            return -2;
+        }
+        if (!slash) {
+            break;
+        }
+        segment = slash + 1;
+    }
+    return parent;
+}
+
+// 全ての行に対応する項目が1つずつあること
+static void check_lines(PlatformMenu* menu, const char* filename)
+{
+    FILE* fp = fopen(filename, "r");
+    if (!fp) {
+        fail(filename, "cannot open");
+        return;
+    }
+
+    bool used[MAX_MENU_ITEMS] = { false };
+    int lines = 0;
+    char line[TEST_MAX_LINE];
+    while (fgets(line, sizeof(line), fp)) {
+        char* path;
+        char* param;
+        int type;
+        if (!split_line(line, &path, &type, &param)) {
+            continue;
+        }
+        lines++;
+
+        // 葉の名前と、その親のパス
+        const char* leaf = strrchr(path, '/');
+        size_t parent_length = leaf ? (size_t)(leaf - path) : 0;
+        leaf = leaf ? leaf + 1 : path;
+        int parent = find_submenu(menu, path, parent_length);
+        if (parent == -2) {
+            fail(filename, "no submenu for \"%s\"", path);
+            continue;
+        }
+
+        int index = (type == MENU_TYPE_SEPARATOR) ?
+            find_child(menu, parent, "separator", type, used) : find_child(menu, parent, leaf, type, used);
+        if (index < 0) {
+            fail(filename, "no item for \"%s\" (type %d)", path, type);
+            continue;
+        }
+        used[index] = true;
+
+        const MenuItemInfo* item = &menu->m_menu_items[index];
+        const char* stored = (type == MENU_TYPE_ACTION) ? menu->get_string(item->action) :
+                             (type == MENU_TYPE_SEPARATOR) ? "" : menu->get_string(item->config_name);
+        if (param && type != MENU_TYPE_SEPARATOR && strcmp(stored, param) != 0) {
+            fail(filename, "\"%s\" has parameter \"%s\", expected \"%s\"", path, stored, param);
+        }
+        if (type != MENU_TYPE_SEPARATOR && strcmp(menu->get_string(item->original_path), path) != 0) {
+            fail(filename, "\"%s\" has path \"%s\"", path, menu->get_string(item->original_path));
+        }
+    }
+    fclose(fp);
+
+    // サブメニュー以外の項目は全て行に対応していること
+    int leaves = 0;
+    for (int i = 0; i < menu->m_num_items; i++) {
+        if (menu->m_menu_items[i].type == MENU_TYPE_SUBMENU) {
+            continue;
+        }
+        leaves++;
+        if (!used[i]) {
+            fail(filename, "item %d \"%s\" does not come from any line", i, menu->get_string(menu->m_menu_items[i].display_name));
+        }
+    }
+    if (leaves != lines) {
+        fail(filename, "%d lines but %d items", lines, leaves);
+    }
+}
+
+// 子の並びが親のインデックスから求めたもの(登録順)と一致し、全ての項目がちょうど1回現れること
+static void check_child_indices(PlatformMenu* menu, const char* filename)
+{
+    int seen[MAX_MENU_ITEMS] = { 0 };
+    for (int parent = -1; parent < menu->m_num_items; parent++) {
+        int position = 0;
+        for (int i = 0; i < menu->m_num_items; i++) {
+            if (menu->m_menu_items[i].parent_index != parent) {
+                continue;
+            }
+            if (menu->get_child_item(parent, position) != i) {
+                fail(filename, "child %d of %d is %d, expected %d", position, parent, menu->get_child_item(parent, position), i);
+            }
+            position++;
+        }
+        if (menu->get_child_count(parent) != position) {
+            fail(filename, "parent %d has %d children, expected %d", parent, menu->get_child_count(parent), position);
+        }
+        for (int j = 0; j < menu->get_child_count(parent); j++) {
+            int child = menu->get_child_item(parent, j);
+            if (child >= 0) {
+                seen[child]++;
+            }
+        }
+    }
+    for (int i = 0; i < menu->m_num_items; i++) {
+        if (seen[i] != 1) {
+            fail(filename, "item %d appears %d times in the child indices", i, seen[i]);
+        }
+    }
+}
+
+static void test_menu_file(const char* filename)
+{
+    int errors = s_errors;
+    PlatformMenu* menu = new PlatformMenu(nullptr);
+    if (!menu->load_menu_file(filename)) {
+        fail(filename, "load_menu_file failed");
+    } else if (menu->m_num_items == 0) {
+        fail(filename, "no items");
+    } else {
+        check_lines(menu, filename);
+        check_child_indices(menu, filename);
+    }
+    printf("%s: %d items, %d string bytes, %s\n", filename, menu->m_num_items, menu->m_string_pool_size,
+        s_errors == errors ? "OK" : "FAILED");
+    delete menu;
+}
+
+// 文字列プールに入りきらない場合は読み込みを失敗にすること
+static void test_string_pool_overflow(const char* temp_path)
+{
+    FILE* fp = fopen(temp_path, "w");
+    if (!fp) {
+        fail(temp_path, "cannot create");
+        return;
+    }
+    // 1行あたり約200バイトの異なる名前(プールの倍程度)
+    int count = MENU_STRING_POOL_SIZE * 2 / 200;
+    if (count > MAX_MENU_ITEMS) {
+        count = MAX_MENU_ITEMS;
+    }
+    for (int i = 0; i < count; i++) {
+        fprintf(fp, "\"Overflow/%03d %0190d\", action, \"Action:%d\"\n", i, i, i);
+    }
+    fclose(fp);
+
+    PlatformMenu* menu = new PlatformMenu(nullptr);
+    bool loaded = menu->load_menu_file(temp_path);
+    if (loaded || menu->m_num_items != 0 || menu->get_child_count(-1) != 0) {
+        fail(temp_path, "overflowing menu was accepted (%d items)", menu->m_num_items);
+    } else {
+        printf("string pool overflow: rejected, OK\n");
+    }
+    delete menu;
+    remove(temp_path);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        printf("usage: %s menu.cfg...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    for (int i = 1; i < argc; i++) {
+        test_menu_file(argv[i]);
+    }
+    test_string_pool_overflow("menu_test_overflow.cfg");
+
+    printf("menu_test: %s\n", s_errors == 0 ? "OK" : "FAILED");
+    return s_errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
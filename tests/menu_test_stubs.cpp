@@ -0,0 +1,60 @@
+// menu_test用に、PlatformMenu.cppが参照する他のクラスの関数を空で定義する
+// (読み込みのテストでは呼ばれない。ログはエラーと警告だけ表示する)
+
+#include "PlatformMenu.h"
+#include "PlatformBootCache.h"
+#include "EmuController.h"
+#include "FBConsole.hpp"
+
+#include <stdio.h>
+#include <stdarg.h>
+
+void CLogger::Write(const char* source, TLogSeverity severity, const char* format, ...)
+{
+    if (severity > LogWarning) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    printf("[%s] ", source);
+    vprintf(format, args);
+    printf("\n");
+    va_end(args);
+}
+
+CLogger* get_logger()
+{
+    static CLogger logger(0);
+    return &logger;
+}
+
+u64 CTimer::GetClockTicks64() { return 0; }
+
+FRESULT f_opendir(DIR*, const TCHAR*) { return FR_NO_FILE; }
+FRESULT f_readdir(DIR*, FILINFO*) { return FR_NO_FILE; }
+FRESULT f_closedir(DIR*) { return FR_OK; }
+
+void EmuController::set_host_window_size(int, int, bool) {}
+bool EmuController::start_auto_key_file(const char*) { return false; }
+bool EmuController::start_input_recording() { return false; }
+bool EmuController::start_input_playback() { return false; }
+void EmuController::stop_auto_key() {}
+void EmuController::stop_input_movie() {}
+
+FBConsole::FBConsole(u16, u16) {}
+FBConsole::~FBConsole() {}
+bool FBConsole::init(u16*, size_t) { return true; }
+void FBConsole::clear(u16) {}
+void FBConsole::drawHLine(u16, u16, u16, u16) {}
+void FBConsole::drawString(const char*, u16, u16, u16, u16, bool) {}
+u16 FBConsole::getWidth() const { return 0; }
+u16 FBConsole::getHeight() const { return 0; }
+
+bool PlatformConfig::get_config_bool(const char*) { return false; }
+int PlatformConfig::get_config_int(const char*, int*, bool*) { return 0; }
+const char* PlatformConfig::get_config_string(const char*) { return ""; }
+void PlatformConfig::apply_config_bool(const char*, bool) {}
+void PlatformConfig::apply_config_int(const char*, int) {}
+
+const void* PlatformBootCache::restore_menu(u32*) { return nullptr; }
+void PlatformBootCache::store_menu(const void*, u32) {}
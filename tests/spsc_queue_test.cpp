@@ -0,0 +1,112 @@
+// PlatformSPSCQueueのストレステスト
+// プロデューサーとコンシューマーを別スレッドで動かし、大量のイベントが欠けず、順序も変わらずに届くことを確認する
+
+#include "PlatformSPSCQueue.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+// 送るイベントの数
+#define STRESS_EVENT_COUNT 10000000u
+
+// 取り違えがあれば分かるように、番号から作った値も一緒に送る
+struct TestEvent {
+    u32 sequence;
+    u32 check;
+    u64 payload;
+};
+
+static u32 make_check(u32 sequence)
+{
+    return sequence * 2654435761u ^ 0x5A5A5A5Au;
+}
+
+// 満杯の場合にfalseを返し、捨てた数を数えること
+static bool test_overflow()
+{
+    PlatformSPSCQueue<u32, 8> queue;
+    for (u32 i = 0; i < 8; i++) {
+        if (!queue.push(i)) {
+            printf("overflow: push %u failed before the queue was full\n", i);
+            return false;
+        }
+    }
+    for (u32 i = 0; i < 5; i++) {
+        if (queue.push(100 + i)) {
+            printf("overflow: push succeeded on a full queue\n");
+            return false;
+        }
+    }
+    if (queue.get_overflow_count() != 5 || queue.size() != 8) {
+        printf("overflow: count=%u size=%u (expected 5 and 8)\n", queue.get_overflow_count(), queue.size());
+        return false;
+    }
+    u32 value;
+    for (u32 i = 0; i < 8; i++) {
+        if (!queue.pop(&value) || value != i) {
+            printf("overflow: pop %u returned a wrong value\n", i);
+            return false;
+        }
+    }
+    if (queue.pop(&value)) {
+        printf("overflow: pop succeeded on an empty queue\n");
+        return false;
+    }
+    return true;
+}
+
+// 小さいキューで満杯と空を頻繁に起こしながら、2つのスレッドで受け渡す
+static bool test_two_threads()
+{
+    static PlatformSPSCQueue<TestEvent, 64> queue;
+    u32 full_retries = 0;
+
+    std::thread producer([&full_retries]() {
+        for (u32 i = 0; i < STRESS_EVENT_COUNT; i++) {
+            TestEvent event;
+            event.sequence = i;
+            event.check = make_check(i);
+            event.payload = ((u64)i << 32) | event.check;
+            while (!queue.push(event)) {
+                full_retries++;
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    u32 expected = 0;
+    u32 errors = 0;
+    while (expected < STRESS_EVENT_COUNT) {
+        TestEvent event;
+        if (!queue.pop(&event)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (event.sequence != expected || event.check != make_check(expected) ||
+            event.payload != (((u64)expected << 32) | make_check(expected))) {
+            if (errors++ < 10) {
+                printf("two threads: expected #%u, got #%u\n", expected, event.sequence);
+            }
+        }
+        expected++;
+    }
+    producer.join();
+
+    TestEvent event;
+    if (queue.pop(&event)) {
+        printf("two threads: queue is not empty after all events\n");
+        errors++;
+    }
+    printf("two threads: %u events, %u full retries, %u overflow, %u errors\n",
+        STRESS_EVENT_COUNT, full_retries, queue.get_overflow_count(), errors);
+    return errors == 0;
+}
+
+int main()
+{
+    bool result = test_overflow();
+    result = test_two_threads() && result;
+    printf("spsc_queue_test: %s\n", result ? "OK" : "FAILED");
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
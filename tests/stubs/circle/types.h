@@ -0,0 +1,21 @@
+// ホスト上でテストをビルドするための最小限の<circle/types.h>
+#ifndef _TEST_STUB_CIRCLE_TYPES_H_
+#define _TEST_STUB_CIRCLE_TYPES_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+typedef int boolean;
+
+#define TRUE 1
+#define FALSE 0
+
+#endif
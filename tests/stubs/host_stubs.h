@@ -0,0 +1,79 @@
+// ホスト上でテストをビルドするための、Circle/FatFs/VC4の最小限の宣言
+// テストで使わない関数は宣言だけ(呼ばれないのでリンクもしない)
+#ifndef _TEST_STUB_HOST_H_
+#define _TEST_STUB_HOST_H_
+
+#include <circle/types.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+
+enum TLogSeverity { LogPanic, LogError, LogWarning, LogNotice, LogDebug };
+class CDevice { public: virtual ~CDevice(){} typedef void TDeviceRemovedHandler(CDevice*, void*); void RegisterRemovedHandler(TDeviceRemovedHandler*, void*){} };
+class CTimer;
+class CLogger { public: CLogger(unsigned, CTimer* = 0){} static CLogger* Get(); boolean Initialize(CDevice*); void Write(const char*, TLogSeverity, const char*, ...); };
+class CInterruptSystem { public: };
+typedef void TKernelTimerHandler(unsigned hTimer, void *pParam, void *pContext);
+class CTimer { public: CTimer(CInterruptSystem*){} boolean Initialize(); static void SimpleMsDelay(unsigned); static void SimpleusDelay(unsigned); static u64 GetClockTicks64(); static unsigned GetClockTicks(); static CTimer* Get(); unsigned GetTicks(); unsigned StartKernelTimer(unsigned, TKernelTimerHandler*, void* = 0, void* = 0); void CancelKernelTimer(unsigned); };
+class CTask { public: CTask(unsigned = 0){} virtual ~CTask(){} virtual void Run()=0; };
+class CScheduler { public: void Yield(); static CScheduler* Get(); void Sleep(unsigned); void MsSleep(unsigned); void usSleep(unsigned); CTask* GetCurrentTask(); };
+typedef u16 TScreenColor;
+#define RED_COLOR 0xF800
+#define GREEN_COLOR 0x07E0
+#define YELLOW_COLOR 0xFFE0
+#define BLUE_COLOR 0x001F
+#define MAGENTA_COLOR 0xF81F
+#define CYAN_COLOR 0x07FF
+#define WHITE_COLOR 0xFFFF
+#define BLACK_COLOR 0
+class CBcmFrameBuffer { public: u32 GetBuffer(); u32 GetPitch(); };
+class CScreenDevice : public CDevice { public: CScreenDevice(unsigned, unsigned){} boolean Resize(unsigned, unsigned); unsigned GetWidth(); unsigned GetHeight(); CBcmFrameBuffer* GetFrameBuffer(); };
+class CDeviceNameService { public: static CDeviceNameService* Get(); CDevice* GetDevice(const char*, boolean); CDevice* GetDevice(const char*, unsigned, boolean); void AddDevice(const char*, CDevice*, boolean); };
+class CMemorySystem { public: static CMemorySystem* Get(); };
+class CDeviceNameServiceHolder {};
+class CSynchronizationEvent { public: void Clear(); void Set(); void Wait(); };
+enum TSoundFormat { SoundFormatSigned16 };
+class CSoundBaseDevice : public CDevice { public: virtual unsigned GetChunk(s16*, unsigned){return 0;} virtual unsigned GetChunk(u32*, unsigned){return 0;} CSoundBaseDevice(TSoundFormat, unsigned, unsigned){} };
+enum TVCHIQSoundDestination { VCHIQSoundDestinationAuto, VCHIQSoundDestinationHeadphones, VCHIQSoundDestinationHDMI, VCHIQSoundDestinationUnknown };
+enum TVCHIQSoundState { VCHIQSoundCreated, VCHIQSoundIdle, VCHIQSoundRunning, VCHIQSoundCancelled, VCHIQSoundTerminating, VCHIQSoundError, VCHIQSoundUnknown };
+class CVCHIQDevice { public: CVCHIQDevice(CMemorySystem*, CInterruptSystem*){} boolean Initialize(); };
+typedef void* VCHI_INSTANCE_T; typedef void* VCHI_SERVICE_HANDLE_T;
+enum VCHI_CALLBACK_REASON_T { VCHI_CALLBACK_MSG_AVAILABLE };
+struct VC_AUDIO_MSG_T { int type; union { struct { int channels, samplerate, bps; } config; struct { int dest; unsigned volume; } control; struct { int draining; } stop; struct { unsigned count, max_packet, cookie1, cookie2; int silence; } write; struct { int success; } result; struct { unsigned count, cookie1, cookie2; } complete; } u; };
+enum { VC_AUDIO_MSG_TYPE_RESULT, VC_AUDIO_MSG_TYPE_COMPLETE, VC_AUDIO_MSG_TYPE_CONFIG, VC_AUDIO_MSG_TYPE_CONTROL, VC_AUDIO_MSG_TYPE_OPEN, VC_AUDIO_MSG_TYPE_START, VC_AUDIO_MSG_TYPE_STOP, VC_AUDIO_MSG_TYPE_WRITE };
+#define VC_AUDIO_WRITE_COOKIE1 1
+#define VC_AUDIO_WRITE_COOKIE2 2
+#define VC_AUDIOSERV_VER 2
+#define VC_AUDIOSERV_MIN_VER 1
+#define VC_AUDIO_SERVER_NAME 0
+#define VCHI_VERSION_EX(a,b) a
+#define VCHI_FLAGS_BLOCK_UNTIL_QUEUED 1
+#define VCHI_FLAGS_NONE 0
+struct SERVICE_CREATION_T { int v; int n; int a,b,c; void (*cb)(void*, const VCHI_CALLBACK_REASON_T, void*); void* p; int x,y,z; };
+int vchi_initialise(VCHI_INSTANCE_T*); int vchi_connect(int, int, VCHI_INSTANCE_T); int vchi_service_open(VCHI_INSTANCE_T, SERVICE_CREATION_T*, VCHI_SERVICE_HANDLE_T*); int vchi_service_release(VCHI_SERVICE_HANDLE_T); int vchi_service_use(VCHI_SERVICE_HANDLE_T); int vchi_msg_queue(VCHI_SERVICE_HANDLE_T, const void*, unsigned, int, void*); int vchi_msg_dequeue(VCHI_SERVICE_HANDLE_T, void*, unsigned, uint32_t*, int); int vchi_get_peer_version(VCHI_SERVICE_HANDLE_T, short*);
+
+// FatFs
+typedef unsigned int UINT; typedef unsigned char BYTE; typedef uint16_t WORD; typedef uint32_t DWORD; typedef uint64_t FSIZE_t; typedef char TCHAR;
+typedef enum { FR_OK = 0, FR_DISK_ERR, FR_NO_FILE = 4, FR_EXIST = 8 } FRESULT;
+typedef struct { int dummy; } FATFS;
+typedef struct { int dummy; } DIR;
+typedef struct { int dummy; FSIZE_t fptr; } FIL;
+typedef struct { FSIZE_t fsize; WORD fdate; WORD ftime; BYTE fattrib; TCHAR altname[13]; TCHAR fname[256]; } FILINFO;
+#define AM_RDO 0x01
+#define AM_HID 0x02
+#define AM_SYS 0x04
+#define AM_DIR 0x10
+#define AM_ARC 0x20
+#define FA_READ 0x01
+#define FA_WRITE 0x02
+#define FA_OPEN_EXISTING 0x00
+#define FA_CREATE_NEW 0x04
+#define FA_CREATE_ALWAYS 0x08
+#define FA_OPEN_ALWAYS 0x10
+FRESULT f_opendir(DIR*, const TCHAR*); FRESULT f_readdir(DIR*, FILINFO*); FRESULT f_closedir(DIR*);
+FRESULT f_open(FIL*, const TCHAR*, BYTE); FRESULT f_close(FIL*); FRESULT f_read(FIL*, void*, UINT, UINT*); FRESULT f_write(FIL*, const void*, UINT, UINT*); FRESULT f_sync(FIL*);
+FRESULT f_unlink(const TCHAR*); FRESULT f_rename(const TCHAR*, const TCHAR*); FRESULT f_stat(const TCHAR*, FILINFO*); FRESULT f_mount(FATFS*, const TCHAR*, BYTE);
+#define f_size(fp) ((fp)->fptr)
+
+#endif
@@ -0,0 +1,197 @@
+// PlatformThermalの判定のテスト
+// 取得元を固定値を返すものに差し替え、クロックの揺れを無視すること、起動時のクロックとの比較やフラグ、温度による段階、
+// update()が変化した時だけtrueを返すことを確認する
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "PlatformThermal.h"
+
+static int s_errors = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            s_errors++; \
+        } \
+    } while (0)
+
+// 次に返す値をテストから書き換える
+class FakeThermalSource : public IPlatformThermalSource {
+    public:
+        PlatformThermalSample m_next;
+        u32 m_max_clock_hz;
+        int m_max_clock_reads;
+
+        FakeThermalSource(u32 clock_hz) : m_max_clock_hz(1800000000), m_max_clock_reads(0)
+        {
+            m_next.temperature = 50000;
+            m_next.clock_hz = clock_hz;
+            m_next.flags = 0;
+        }
+
+        u32 get_max_clock() { m_max_clock_reads++; return m_max_clock_hz; }
+        bool read(PlatformThermalSample* sample) { *sample = m_next; return true; }
+};
+
+// 読み取りの間隔だけ時刻を進めて1回更新する
+static bool poll(PlatformThermal* thermal, u64* now)
+{
+    *now += THERMAL_POLL_INTERVAL_US;
+    return thermal->update(*now);
+}
+
+static void test_first_read_and_interval()
+{
+    FakeThermalSource* source = new FakeThermalSource(1500000000);
+    PlatformThermal thermal(source);
+    u64 now = 0;
+
+    CHECK(thermal.get_sample() == nullptr);
+    CHECK(poll(&thermal, &now));
+    CHECK(thermal.get_level() == THERMAL_LEVEL_NORMAL);
+    CHECK(thermal.get_clock() == 1500000000);
+    CHECK(thermal.get_max_clock() == 1800000000);
+
+    // 間隔の前は読み取らない
+    source->m_next.flags = THERMAL_FLAG_FREQ_CAPPED;
+    CHECK(!thermal.update(now + THERMAL_POLL_INTERVAL_US - 1));
+    CHECK(thermal.get_level() == THERMAL_LEVEL_NORMAL);
+
+    // 同じ値なら変化ではない。最大クロックは最初の一度だけ読む
+    source->m_next.flags = 0;
+    CHECK(!poll(&thermal, &now));
+    CHECK(!poll(&thermal, &now));
+    CHECK(source->m_max_clock_reads == 1);
+}
+
+static void test_clock_jitter()
+{
+    FakeThermalSource* source = new FakeThermalSource(1500000000);
+    PlatformThermal thermal(source);
+    u64 now = 0;
+    poll(&thermal, &now);
+
+    // 実測値の揺れ(THERMAL_CLOCK_CHANGE_MHZ未満)は無視し、最後に変化とみなしたクロックを保つ
+    static const u32 jitter_mhz[] = { 1499, 1505, 1491, 1509, 1500 };
+    for (size_t i = 0; i < sizeof(jitter_mhz) / sizeof(jitter_mhz[0]); i++) {
+        source->m_next.clock_hz = jitter_mhz[i] * 1000000;
+        CHECK(!poll(&thermal, &now));
+        CHECK(thermal.get_clock() == 1500000000);
+    }
+    CHECK(thermal.get_sample()->clock_hz == 1500000000);
+
+    // 閾値ちょうどの変化は反映する
+    source->m_next.clock_hz = (1500 + THERMAL_CLOCK_CHANGE_MHZ) * 1000000;
+    CHECK(poll(&thermal, &now));
+    CHECK(thermal.get_clock() == (1500 + THERMAL_CLOCK_CHANGE_MHZ) * 1000000);
+    CHECK(thermal.get_level() == THERMAL_LEVEL_NORMAL);
+}
+
+static void test_clock_drop()
+{
+    // 最大クロックより低く起動していても、起動時のクロックのままならスロットリングではない
+    FakeThermalSource* source = new FakeThermalSource(1200000000);
+    PlatformThermal thermal(source);
+    u64 now = 0;
+    poll(&thermal, &now);
+    CHECK(thermal.get_level() == THERMAL_LEVEL_NORMAL);
+
+    // 起動時の90%(1080MHz)ちょうどはまだ通常
+    source->m_next.clock_hz = 1080000000;
+    CHECK(poll(&thermal, &now));
+    CHECK(thermal.get_level() == THERMAL_LEVEL_NORMAL);
+
+    // 90%を下回ったらスロットリング
+    source->m_next.clock_hz = 1060000000;
+    CHECK(poll(&thermal, &now));
+    CHECK(thermal.get_level() == THERMAL_LEVEL_THROTTLED);
+    CHECK(!poll(&thermal, &now));
+
+    // 戻れば通常に戻る
+    source->m_next.clock_hz = 1200000000;
+    CHECK(poll(&thermal, &now));
+    CHECK(thermal.get_level() == THERMAL_LEVEL_NORMAL);
+}
+
+static void test_flags()
+{
+    static const u32 throttled_flags[] = { THERMAL_FLAG_FREQ_CAPPED, THERMAL_FLAG_UNDER_VOLTAGE, THERMAL_FLAG_THROTTLED };
+    for (size_t i = 0; i < sizeof(throttled_flags) / sizeof(throttled_flags[0]); i++) {
+        FakeThermalSource* source = new FakeThermalSource(1500000000);
+        PlatformThermal thermal(source);
+        u64 now = 0;
+        poll(&thermal, &now);
+
+        source->m_next.flags = throttled_flags[i];
+        CHECK(poll(&thermal, &now));
+        CHECK(thermal.get_level() == THERMAL_LEVEL_THROTTLED);
+        CHECK(!poll(&thermal, &now));
+
+        source->m_next.flags = 0;
+        CHECK(poll(&thermal, &now));
+        CHECK(thermal.get_level() == THERMAL_LEVEL_NORMAL);
+    }
+
+    FakeThermalSource* source = new FakeThermalSource(1500000000);
+    PlatformThermal thermal(source);
+    u64 now = 0;
+    poll(&thermal, &now);
+
+    // 起動後に発生したかどうかのビット(上位16ビット)だけの変化は通知しない
+    source->m_next.flags = THERMAL_FLAG_FREQ_CAPPED << 16;
+    CHECK(!poll(&thermal, &now));
+    CHECK(thermal.get_level() == THERMAL_LEVEL_NORMAL);
+
+    // 段階が同じでも現在のフラグが変われば通知する
+    source->m_next.flags = THERMAL_FLAG_FREQ_CAPPED;
+    CHECK(poll(&thermal, &now));
+    source->m_next.flags = THERMAL_FLAG_FREQ_CAPPED | THERMAL_FLAG_UNDER_VOLTAGE;
+    CHECK(poll(&thermal, &now));
+    CHECK(thermal.get_level() == THERMAL_LEVEL_THROTTLED);
+}
+
+static void test_warm()
+{
+    FakeThermalSource* source = new FakeThermalSource(1500000000);
+    PlatformThermal thermal(source);
+    u64 now = 0;
+    poll(&thermal, &now);
+
+    source->m_next.temperature = THERMAL_WARM_TEMPERATURE - 1;
+    CHECK(!poll(&thermal, &now));
+    CHECK(thermal.get_level() == THERMAL_LEVEL_NORMAL);
+
+    source->m_next.temperature = THERMAL_WARM_TEMPERATURE;
+    CHECK(poll(&thermal, &now));
+    CHECK(thermal.get_level() == THERMAL_LEVEL_WARM);
+    // 温度が変わっても段階が同じなら変化ではない
+    source->m_next.temperature = THERMAL_WARM_TEMPERATURE + 3000;
+    CHECK(!poll(&thermal, &now));
+
+    source->m_next.temperature = 50000;
+    CHECK(poll(&thermal, &now));
+    CHECK(thermal.get_level() == THERMAL_LEVEL_NORMAL);
+
+    source->m_next.flags = THERMAL_FLAG_SOFT_TEMP;
+    CHECK(poll(&thermal, &now));
+    CHECK(thermal.get_level() == THERMAL_LEVEL_WARM);
+
+    // スロットリングの方が優先
+    source->m_next.flags = THERMAL_FLAG_SOFT_TEMP | THERMAL_FLAG_THROTTLED;
+    CHECK(poll(&thermal, &now));
+    CHECK(thermal.get_level() == THERMAL_LEVEL_THROTTLED);
+}
+
+int main()
+{
+    test_first_read_and_interval();
+    test_clock_jitter();
+    test_clock_drop();
+    test_flags();
+    test_warm();
+
+    printf("thermal_test: %s\n", s_errors == 0 ? "OK" : "FAILED");
+    return s_errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,377 @@
+// PlatformTraceの書き出しのテスト
+// write_jsonの出力をJSONとして読み直し、名前のエスケープ、時刻が戻らないこと、
+// リングが一周して始まりが失われた区間の終わりを書き出さないこと、コアごとに始まりと終わりが対応することを確認する
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// コアの番号を書き換えるため
+#define private public
+#include "PlatformTrace.cpp"
+#undef private
+
+static int s_errors = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            s_errors++; \
+        } \
+    } while (0)
+
+static u64 s_clock = 0;
+
+u64 CTimer::GetClockTicks64()
+{
+    return s_clock;
+}
+
+// 書き出されたイベント(メタデータは除く)
+struct JsonEvent {
+    std::string name;
+    char type;
+    u32 ts;
+    int tid;
+};
+
+// 必要な分だけのJSONの読み取り。形式が正しくなければfalseを返す
+class JsonReader {
+    private:
+        const char* m_p;
+
+        void skip_space()
+        {
+            while (*m_p == ' ' || *m_p == '\n' || *m_p == '\r' || *m_p == '\t') {
+                m_p++;
+            }
+        }
+
+        bool expect(char c)
+        {
+            skip_space();
+            if (*m_p != c) {
+                return false;
+            }
+            m_p++;
+            return true;
+        }
+
+        bool read_string(std::string* out)
+        {
+            if (!expect('"')) {
+                return false;
+            }
+            out->clear();
+            for (;;) {
+                char c = *m_p++;
+                if (c == '"') {
+                    return true;
+                }
+                if ((unsigned char)c < 0x20) {
+                    return false;
+                }
+                if (c == '\\') {
+                    c = *m_p++;
+                    if (c != '"' && c != '\\' && c != '/') {
+                        return false;
+                    }
+                }
+                out->push_back(c);
+            }
+        }
+
+        bool read_number(double* out)
+        {
+            skip_space();
+            char* end;
+            *out = strtod(m_p, &end);
+            if (end == m_p) {
+                return false;
+            }
+            m_p = end;
+            return true;
+        }
+
+        // 値を読む。オブジェクトならキーと値(文字列か数値)をeventに取り出す
+        bool read_value(JsonEvent* event, bool* metadata)
+        {
+            skip_space();
+            if (*m_p == '"') {
+                std::string value;
+                return read_string(&value);
+            }
+            if (*m_p == '{') {
+                return read_object(event, metadata);
+            }
+            if (*m_p == '[') {
+                m_p++;
+                skip_space();
+                if (*m_p == ']') {
+                    m_p++;
+                    return true;
+                }
+                do {
+                    JsonEvent child;
+                    bool child_metadata;
+                    if (!read_value(&child, &child_metadata)) {
+                        return false;
+                    }
+                } while (expect(','));
+                return expect(']');
+            }
+            double number;
+            return read_number(&number);
+        }
+
+        bool read_object(JsonEvent* event, bool* metadata)
+        {
+            if (!expect('{')) {
+                return false;
+            }
+            *metadata = false;
+            skip_space();
+            if (*m_p == '}') {
+                m_p++;
+                return true;
+            }
+            do {
+                std::string key;
+                if (!read_string(&key) || !expect(':')) {
+                    return false;
+                }
+                skip_space();
+                if (key == "name" || key == "ph") {
+                    std::string value;
+                    if (!read_string(&value)) {
+                        return false;
+                    }
+                    if (key == "name") {
+                        event->name = value;
+                    } else {
+                        event->type = value.size() == 1 ? value[0] : 0;
+                        *metadata = event->type == 'M';
+                    }
+                } else if (key == "ts" || key == "tid") {
+                    double number;
+                    if (!read_number(&number)) {
+                        return false;
+                    }
+                    if (key == "ts") {
+                        event->ts = (u32)number;
+                    } else {
+                        event->tid = (int)number;
+                    }
+                } else {
+                    JsonEvent child;
+                    bool child_metadata;
+                    if (!read_value(&child, &child_metadata)) {
+                        return false;
+                    }
+                }
+            } while (expect(','));
+            return expect('}');
+        }
+
+    public:
+        // {"traceEvents":[...],...}を読み、メタデータ以外のイベントを返す
+        bool read_trace(const char* text, std::vector<JsonEvent>* events)
+        {
+            m_p = text;
+            std::string key;
+            if (!expect('{') || !read_string(&key) || key != "traceEvents" || !expect(':') || !expect('[')) {
+                return false;
+            }
+            do {
+                JsonEvent event = { "", 0, 0, -1 };
+                bool metadata;
+                if (!read_object(&event, &metadata)) {
+                    return false;
+                }
+                if (!metadata) {
+                    events->push_back(event);
+                }
+            } while (expect(','));
+            if (!expect(']')) {
+                return false;
+            }
+            while (expect(',')) {
+                JsonEvent child;
+                bool child_metadata;
+                if (!read_string(&key) || !expect(':') || !read_value(&child, &child_metadata)) {
+                    return false;
+                }
+            }
+            if (!expect('}')) {
+                return false;
+            }
+            skip_space();
+            return *m_p == '\0';
+        }
+};
+
+// 書き出して読み直す
+static bool write_and_read(PlatformTrace* trace, std::vector<JsonEvent>* events)
+{
+    FILE* fp = tmpfile();
+    if (!fp) {
+        return false;
+    }
+    bool result = trace->write_json(fp);
+    long size = ftell(fp);
+    rewind(fp);
+    std::string text(size, '\0');
+    if (fread(&text[0], 1, size, fp) != (size_t)size) {
+        result = false;
+    }
+    fclose(fp);
+
+    JsonReader reader;
+    if (!reader.read_trace(text.c_str(), events)) {
+        printf("invalid JSON:\n%s\n", text.c_str());
+        return false;
+    }
+    return result;
+}
+
+// 時刻が戻らず、コアごとに終わりが始まりより多くならないこと
+static void check_events(const std::vector<JsonEvent>& events)
+{
+    int depth[TRACE_MAX_CORES] = { 0 };
+    for (size_t i = 0; i < events.size(); i++) {
+        const JsonEvent& event = events[i];
+        CHECK(event.tid >= 0 && event.tid < TRACE_MAX_CORES);
+        if (i > 0) {
+            CHECK(event.ts >= events[i - 1].ts);
+        }
+        if (event.type == TRACE_EVENT_BEGIN) {
+            depth[event.tid]++;
+        } else if (event.type == TRACE_EVENT_END) {
+            depth[event.tid]--;
+            CHECK(depth[event.tid] >= 0);
+        } else {
+            CHECK(event.type == TRACE_EVENT_INSTANT);
+        }
+    }
+}
+
+// 記録してから、コアの番号を書き換える
+static void record_on(PlatformTrace* trace, int core, u8 type, const char* name)
+{
+    s_clock += 3;
+    trace->record(type, name);
+    trace->m_events[(trace->m_write - 1) & (TRACE_RING_SIZE - 1)].core = core;
+}
+
+static void test_empty()
+{
+    PlatformTrace* trace = new PlatformTrace();
+    std::vector<JsonEvent> events;
+    CHECK(write_and_read(trace, &events));
+    CHECK(events.empty());
+    delete trace;
+}
+
+static void test_escape()
+{
+    PlatformTrace* trace = new PlatformTrace();
+    s_clock = 1000;
+    trace->record(TRACE_EVENT_INSTANT, "quote\"back\\slash");
+    trace->record(TRACE_EVENT_INSTANT, "\\\"\\");
+
+    std::vector<JsonEvent> events;
+    CHECK(write_and_read(trace, &events));
+    CHECK(events.size() == 2);
+    if (events.size() == 2) {
+        CHECK(events[0].name == "quote\"back\\slash");
+        CHECK(events[1].name == "\\\"\\");
+        CHECK(events[0].ts == 0);
+    }
+    delete trace;
+}
+
+static void test_cores()
+{
+    PlatformTrace* trace = new PlatformTrace();
+    s_clock = 5000;
+    // コア0と1の区間が交互に入れ子になる
+    record_on(trace, 0, TRACE_EVENT_BEGIN, "loop");
+    record_on(trace, 1, TRACE_EVENT_BEGIN, "sound");
+    record_on(trace, 0, TRACE_EVENT_BEGIN, "vm");
+    record_on(trace, 1, TRACE_EVENT_END, "sound");
+    record_on(trace, 0, TRACE_EVENT_END, "vm");
+    record_on(trace, 1, TRACE_EVENT_INSTANT, "usb");
+    record_on(trace, 0, TRACE_EVENT_END, "loop");
+
+    std::vector<JsonEvent> events;
+    CHECK(write_and_read(trace, &events));
+    CHECK(events.size() == 7);
+    check_events(events);
+    if (events.size() == 7) {
+        CHECK(events[1].tid == 1 && events[1].name == "sound");
+        CHECK(events[6].ts == 18);
+    }
+    delete trace;
+}
+
+static void test_wrap()
+{
+    PlatformTrace* trace = new PlatformTrace();
+    // 時刻の下位32ビットが途中で一周する
+    s_clock = 0xFFFFFFFFull - 1000;
+
+    // コア1の区間の始まりと、コア0の外側の区間の始まりはリングから押し出される
+    record_on(trace, 1, TRACE_EVENT_BEGIN, "lost1");
+    record_on(trace, 0, TRACE_EVENT_BEGIN, "lost0");
+    for (u32 i = 0; i < TRACE_RING_SIZE - 6; i++) {
+        record_on(trace, i & 1, TRACE_EVENT_INSTANT, "filler");
+    }
+    record_on(trace, 0, TRACE_EVENT_BEGIN, "kept");
+    record_on(trace, 1, TRACE_EVENT_END, "lost1");
+    record_on(trace, 0, TRACE_EVENT_END, "kept");
+    record_on(trace, 0, TRACE_EVENT_END, "lost0");
+    record_on(trace, 1, TRACE_EVENT_BEGIN, "open");
+    record_on(trace, 0, TRACE_EVENT_INSTANT, "last");
+    CHECK(trace->get_count() == TRACE_RING_SIZE);
+
+    std::vector<JsonEvent> events;
+    CHECK(write_and_read(trace, &events));
+    // 始まりが失われた2つの終わりだけが除かれる
+    CHECK(events.size() == TRACE_RING_SIZE - 2);
+    check_events(events);
+
+    int kept = 0;
+    for (size_t i = 0; i < events.size(); i++) {
+        CHECK(events[i].name != "lost0" && events[i].name != "lost1");
+        if (events[i].name == "kept") {
+            CHECK(events[i].tid == 0);
+            kept++;
+        }
+    }
+    CHECK(kept == 2);
+    if (!events.empty()) {
+        CHECK(events.front().ts == 0);
+        CHECK(events.back().ts == (TRACE_RING_SIZE - 1) * 3);
+        CHECK(events.back().name == "last");
+    }
+
+    // 書き出した後も記録を続ける
+    u32 written = trace->m_write;
+    record_on(trace, 0, TRACE_EVENT_INSTANT, "after");
+    CHECK(trace->m_write == written + 1);
+    delete trace;
+}
+
+int main()
+{
+    test_empty();
+    test_escape();
+    test_cores();
+    test_wrap();
+
+    printf("trace_test: %s\n", s_errors == 0 ? "OK" : "FAILED");
+    return s_errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}